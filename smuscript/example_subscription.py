@@ -0,0 +1,56 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+#
+# Example script for reacting to new samples with a callback instead of
+# polling the signal.
+#
+
+import smuview
+import time
+
+# Connect device.
+dmm_dev = Session.connect_device("hp-3478a:conn=libgpib/hp3478a")[0]
+# Sleep 1s to give the devices the chance to create signals.
+time.sleep(1)
+signal = dmm_dev.channels()["P1"].actual_signal()
+
+# Add user device for the moving minimum and maximum
+user_device = Session.add_user_device()
+min_ch = user_device.add_user_channel("Min", "User")
+max_ch = user_device.add_user_channel("Max", "User")
+UiProxy.add_device_tab(user_device)
+
+# Called with all new samples, at most 5 times per second.
+def on_samples(timestamps, values):
+    min_ch.push_samples(timestamps[-1:], values.min(keepdims=True), smuview.Quantity.Voltage, set(), smuview.Unit.Volt, 7, 4)
+    max_ch.push_samples(timestamps[-1:], values.max(keepdims=True), smuview.Quantity.Voltage, set(), smuview.Unit.Volt, 7, 4)
+
+subscription = signal.subscribe(on_samples, max_rate=5)
+
+# Deliver the samples for 60s. This is not busy waiting, the script sleeps
+# until new samples have arrived.
+end_time = time.time() + 60
+while time.time() < end_time:
+    smuview.process_subscriptions(1.0)
+
+subscription.unsubscribe()
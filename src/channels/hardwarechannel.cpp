@@ -60,8 +60,8 @@ HardwareChannel::HardwareChannel(
 }
 
 void HardwareChannel::push_interleaved_samples(const float *data,
-	size_t sample_count, size_t stride, double timestamp, uint64_t samplerate,
-	shared_ptr<sigrok::Analog> sr_analog)
+	size_t sample_count, size_t stride, shared_ptr<data::Timebase> timebase,
+	size_t timebase_index, shared_ptr<sigrok::Analog> sr_analog)
 {
 	//lock_guard<recursive_mutex> lock(mutex_);
 
@@ -124,7 +124,7 @@ void HardwareChannel::push_interleaved_samples(const float *data,
 	}
 
 	static_pointer_cast<data::AnalogTimeSignal>(actual_signal_)->push_samples(
-		deint_data.get(), sample_count, timestamp, samplerate,
+		deint_data.get(), sample_count, timebase, timebase_index,
 		sr_analog->unitsize(), digits, decimal_places);
 }
 
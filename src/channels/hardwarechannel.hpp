@@ -39,6 +39,9 @@ class Channel;
 
 namespace sv {
 
+namespace data {
+class Timebase;
+}
 namespace devices {
 class BaseDevice;
 }
@@ -62,11 +65,12 @@ public:
 
 public:
 	/**
-	 * Add one or more interleaved samples with timestamps to the channel
+	 * Add one or more interleaved samples to the channel. The timestamps of
+	 * the samples are in the timebase, starting at timebase_index.
 	 */
 	void push_interleaved_samples(const float *data, size_t sample_count,
-		size_t stride, double timestamp, uint64_t samplerate,
-		shared_ptr<sigrok::Analog> sr_analog);
+		size_t stride, shared_ptr<data::Timebase> timebase,
+		size_t timebase_index, shared_ptr<sigrok::Analog> sr_analog);
 
 };
 
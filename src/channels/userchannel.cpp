@@ -63,6 +63,33 @@ UserChannel::UserChannel(
 void UserChannel::push_sample(double sample, double timestamp,
 	data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
 	data::Unit unit, int digits, int decimal_places)
+{
+	select_signal(quantity, quantity_flags, unit)->push_sample(
+		&sample, timestamp, size_of_double_, digits, decimal_places);
+}
+
+void UserChannel::push_samples(const double *timestamps,
+	const double *values, size_t count, data::Quantity quantity,
+	set<data::QuantityFlag> quantity_flags, data::Unit unit,
+	int digits, int decimal_places)
+{
+	select_signal(quantity, quantity_flags, unit)->push_samples(
+		timestamps, values, count, digits, decimal_places);
+}
+
+void UserChannel::push_samples(const double *values, size_t count,
+	double timestamp, uint64_t samplerate, data::Quantity quantity,
+	set<data::QuantityFlag> quantity_flags, data::Unit unit,
+	int digits, int decimal_places)
+{
+	select_signal(quantity, quantity_flags, unit)->push_samples(
+		(void *)values, count, timestamp, samplerate, size_of_double_,
+		digits, decimal_places);
+}
+
+shared_ptr<data::AnalogTimeSignal> UserChannel::select_signal(
+	data::Quantity quantity, const set<data::QuantityFlag> &quantity_flags,
+	data::Unit unit)
 {
 	if (!actual_signal_ || actual_signal_->quantity() != quantity ||
 		actual_signal_->quantity_flags() != quantity_flags) {
@@ -71,20 +98,19 @@ void UserChannel::push_sample(double sample, double timestamp,
 		size_t signals_count = signal_map_.count(mq);
 		if (signals_count == 0) {
 			actual_signal_ = add_signal(quantity, quantity_flags, unit);
-			qWarning() << "UserChannel::push_sample(): " << display_name() <<
+			qWarning() << "UserChannel::select_signal(): " << display_name() <<
 				" - No signal found: " << actual_signal_->display_name();
 		}
 		else if (signals_count > 1) {
 			actual_signal_ = signal_map_[mq][0];
-			qWarning() << "UserChannel::push_sample(): " << display_name() <<
+			qWarning() << "UserChannel::select_signal(): " << display_name() <<
 				" - More than one signal found, using first found signal: " <<
 				actual_signal_->display_name();
 		}
 		Q_EMIT signal_changed(actual_signal_);
 	}
 
-	static_pointer_cast<data::AnalogTimeSignal>(actual_signal_)->push_sample(
-		&sample, timestamp, size_of_double_, digits, decimal_places);
+	return static_pointer_cast<data::AnalogTimeSignal>(actual_signal_);
 }
 
 } // namespace channels
@@ -27,6 +27,8 @@
 
 #include <QObject>
 
+#include <cstdint>
+
 #include "src/channels/basechannel.hpp"
 #include "src/data/datautil.hpp"
 
@@ -38,6 +40,7 @@ using std::vector;
 namespace sv {
 
 namespace data {
+class AnalogTimeSignal;
 class BaseSignal;
 }
 
@@ -66,6 +69,32 @@ public:
 		data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
 		data::Unit unit, int digits, int decimal_places);
 
+	/**
+	 * Add multiple samples with individual timestamps to the channel/signal.
+	 * The timestamps must be in ascending order.
+	 */
+	void push_samples(const double *timestamps, const double *values,
+		size_t count, data::Quantity quantity,
+		set<data::QuantityFlag> quantity_flags, data::Unit unit,
+		int digits, int decimal_places);
+
+	/**
+	 * Add multiple equidistant samples to the channel/signal, starting at
+	 * the given timestamp.
+	 */
+	void push_samples(const double *values, size_t count, double timestamp,
+		uint64_t samplerate, data::Quantity quantity,
+		set<data::QuantityFlag> quantity_flags, data::Unit unit,
+		int digits, int decimal_places);
+
+private:
+	/**
+	 * Make the signal with the given quantity the actual signal. The signal
+	 * is created if it doesn't exist.
+	 */
+	shared_ptr<data::AnalogTimeSignal> select_signal(data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags, data::Unit unit);
+
 };
 
 } // namespace channels
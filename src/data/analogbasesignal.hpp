@@ -20,6 +20,7 @@
 #ifndef DATA_ANALOGBASESIGNAL_HPP
 #define DATA_ANALOGBASESIGNAL_HPP
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -103,7 +104,8 @@ public:
 
 protected:
 	shared_ptr<vector<double>> data_;
-	size_t sample_count_;
+	/** Atomic, to be read without locking the sample storage. */
+	std::atomic<size_t> sample_count_;
 	int digits_;
 	int decimal_places_;
 	double last_value_;
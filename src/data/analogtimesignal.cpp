@@ -19,7 +19,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -30,18 +32,27 @@
 #include "src/util.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/compressedsamples.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/mappedsessionfile.hpp"
+#include "src/data/retainedsamples.hpp"
+#include "src/data/timebase.hpp"
 
 using std::make_pair;
+using std::lock_guard;
 using std::make_shared;
+using std::pair;
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::unique_lock;
 using std::vector;
 
 namespace sv {
 namespace data {
 
+const double AnalogTimeSignal::retention_interval_ = 1.;
+
 AnalogTimeSignal::AnalogTimeSignal(
 		data::Quantity quantity,
 		const set<data::QuantityFlag> &quantity_flags,
@@ -50,6 +61,9 @@ AnalogTimeSignal::AnalogTimeSignal(
 		double signal_start_timestamp,
 		const string &custom_name) :
 	AnalogBaseSignal(quantity, quantity_flags, unit, parent_channel, custom_name),
+	timebase_handle_(0),
+	compression_enabled_(true),
+	next_retention_timestamp_(0.),
 	signal_start_timestamp_(signal_start_timestamp),
 	last_timestamp_(0.)
 {
@@ -57,15 +71,29 @@ AnalogTimeSignal::AnalogTimeSignal(
 		<< ", signal_start_timestamp_ = "
 		<< util::format_time_date(signal_start_timestamp_);
 
-	time_ = make_shared<vector<double>>();
+	set_timebase(make_shared<Timebase>());
+	compressed_samples_ = make_shared<CompressedSamples>();
+}
+
+AnalogTimeSignal::~AnalogTimeSignal()
+{
+	timebase_->detach(timebase_handle_);
 }
 
 void AnalogTimeSignal::clear()
 {
-	// TODO: mutex
-	time_->clear();
+	unique_lock<recursive_mutex> lock(mutex_);
+	set_timebase(make_shared<Timebase>());
 	data_->clear();
+	mapped_samples_ = nullptr;
+	compressed_samples_ = make_shared<CompressedSamples>();
+	if (retained_samples_) {
+		retained_samples_ = make_shared<RetainedSamples>(
+			retained_samples_->raw_duration(), retained_samples_->tiers());
+	}
+	next_retention_timestamp_ = 0.;
 	sample_count_ = 0;
+	lock.unlock();
 
 	Q_EMIT samples_cleared();
 }
@@ -78,76 +106,231 @@ analog_time_sample_t AnalogTimeSignal::get_sample(
 	//qWarning() << "AnalogSignal::get_sample(" << pos
 	//	<< "): sample_count_ = " << sample_count_;
 
+	lock_guard<recursive_mutex> lock(mutex_);
 	if (pos < sample_count_) {
-		double timestamp = time_->at(pos);
+		double timestamp = timestamp_at(pos);
 		if (relative_time)
 			timestamp -= signal_start_timestamp_;
 		//qWarning() << "AnalogSignal::get_sample(" << pos
-		//	<< "): sample = " << timestamp << ", " << data_->at(pos);
-		return make_pair(timestamp, data_->at(pos));
+		//	<< "): sample = " << timestamp << ", " << value_at(pos);
+		return make_pair(timestamp, value_at(pos));
 	}
 
 	return make_pair(0., 0.);
 }
 
+size_t AnalogTimeSignal::get_samples(size_t pos, size_t count,
+	vector<double> &timestamps, vector<double> &values,
+	bool relative_time) const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	if (pos >= sample_count_) {
+		timestamps.clear();
+		values.clear();
+		return 0;
+	}
+	if (count > sample_count_ - pos)
+		count = sample_count_ - pos;
+
+	timestamps.resize(count);
+	values.resize(count);
+	return get_samples(pos, count, timestamps.data(), values.data(),
+		relative_time);
+}
+
+size_t AnalogTimeSignal::get_samples(size_t pos, size_t count,
+	double *timestamps, double *values, bool relative_time) const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	if (pos >= sample_count_)
+		return 0;
+	if (count > sample_count_ - pos)
+		count = sample_count_ - pos;
+
+	if (mapped_samples_) {
+		mapped_samples_->copy(pos, count, timestamps, values);
+	}
+	else {
+		// The retained, the compressed and the hot samples follow each other.
+		size_t copied = 0;
+		if (retained_samples_)
+			copied = retained_samples_->copy(pos, count, timestamps, values);
+		if (timestamps && copied < count)
+			copy_timestamps(pos + copied, count - copied, timestamps + copied);
+		if (values) {
+			const size_t compressed_pos = pos + copied - retained_sample_count();
+			const size_t compressed_copied = compressed_samples_->copy(
+				compressed_pos, count - copied, nullptr, values + copied);
+			copied += compressed_copied;
+			if (copied < count) {
+				const size_t hot_pos = compressed_pos + compressed_copied -
+					compressed_samples_->sample_count();
+				std::copy(data_->begin() + hot_pos,
+					data_->begin() + hot_pos + (count - copied),
+					values + copied);
+			}
+		}
+	}
+	if (timestamps && relative_time) {
+		for (size_t i = 0; i < count; ++i)
+			timestamps[i] -= signal_start_timestamp_;
+	}
+	return count;
+}
+
+size_t AnalogTimeSignal::get_export_samples(size_t &pos, size_t end,
+	size_t count, vector<double> &timestamps, vector<double> &values,
+	bool relative_time) const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	end = std::min(end, (size_t)sample_count_);
+	if (pos >= end) {
+		timestamps.clear();
+		values.clear();
+		return 0;
+	}
+	// A bucket covers at least one position.
+	count = std::min(count, end - pos);
+	timestamps.resize(count);
+	values.resize(count);
+
+	size_t copied = 0;
+	if (!mapped_samples_ && pos < retained_sample_count()) {
+		copied = retained_samples_->copy_buckets(
+			pos, end, count, timestamps.data(), values.data());
+		if (relative_time) {
+			for (size_t i = 0; i < copied; ++i)
+				timestamps[i] -= signal_start_timestamp_;
+		}
+	}
+	if (copied < count && pos < end) {
+		const size_t n = get_samples(pos, std::min(count - copied, end - pos),
+			timestamps.data() + copied, values.data() + copied, relative_time);
+		pos += n;
+		copied += n;
+	}
+
+	timestamps.resize(copied);
+	values.resize(copied);
+	return copied;
+}
+
 analog_time_sample_t AnalogTimeSignal::get_last_sample(bool relative_time) const
 {
 	// TODO: retrun reference (&double)? See get_value_at_timestamp()
+	lock_guard<recursive_mutex> lock(mutex_);
 	if (sample_count_ == 0)
 		return make_pair(0., 0.);
 
 	size_t pos = sample_count_ - 1;
-	double timestamp = time_->at(pos);
+	double timestamp = timestamp_at(pos);
 	if (relative_time)
 		timestamp -= signal_start_timestamp_;
-	return make_pair(timestamp, data_->at(pos));
+	return make_pair(timestamp, value_at(pos));
 }
 
 bool AnalogTimeSignal::get_value_at_timestamp(
 	double timestamp, double &value, bool relative_time) const
 {
-	if (time_->empty())
+	lock_guard<recursive_mutex> lock(mutex_);
+	if (sample_count_ == 0)
 		return false;
-	if (timestamp < time_->at(0))
+	if (timestamp < timestamp_at(0))
 		return false;
-	if (timestamp > time_->back())
+	if (timestamp > timestamp_at(sample_count_ - 1))
 		return false;
 
 	if (relative_time)
 		timestamp += signal_start_timestamp_;
 
-	auto lower = std::lower_bound(time_->begin(), time_->end(), timestamp);
+	size_t lower_pos = lower_bound_pos(timestamp, false);
 
 	// Check if timestamp and found timestamp match
-	if (timestamp == *lower) {
-		value = *lower;
+	if (timestamp == timestamp_at(lower_pos)) {
+		value = value_at(lower_pos);
 		return true;
 	}
 
-	size_t lower_pos = lower - time_->begin();
-
 	// Get the previous timestamp for linear interpolation
 	if (lower_pos > 0)
 		--lower_pos;
 
-	double lower_ts = time_->at(lower_pos);
-	double lower_data = data_->at(lower_pos);
+	double lower_ts = timestamp_at(lower_pos);
+	double lower_data = value_at(lower_pos);
 	size_t upper_pos = lower_pos + 1;
-	double upper_ts = time_->at(upper_pos);
+	double upper_ts = timestamp_at(upper_pos);
 
 	// Use linear interpolation to get the value beetween time stamps
 	double ts_factor = (timestamp - lower_ts) / (upper_ts - lower_ts);
-	double data_diff = data_->at(upper_pos) - lower_data;
+	double data_diff = value_at(upper_pos) - lower_data;
 	double lininter_data = lower_data + (data_diff * ts_factor);
 
 	value = lininter_data;
 	return true;
 }
 
+size_t AnalogTimeSignal::lower_bound_pos(
+	double timestamp, bool relative_time) const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	if (relative_time)
+		timestamp += signal_start_timestamp_;
+
+	size_t pos = 0;
+	const size_t retained_count = retained_sample_count();
+	if (retained_count > 0) {
+		if (retained_count == sample_count_ ||
+				timestamp <= timestamp_at(retained_count)) {
+			return retained_samples_->lower_bound_pos(timestamp);
+		}
+		pos = retained_count;
+	}
+
+	size_t count = sample_count_ - pos;
+	while (count > 0) {
+		size_t step = count / 2;
+		if (timestamp_at(pos + step) < timestamp) {
+			pos += step + 1;
+			count -= step + 1;
+		}
+		else {
+			count = step;
+		}
+	}
+	return pos;
+}
+
+pair<double, double> AnalogTimeSignal::get_envelope(size_t pos) const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	if (pos >= sample_count_)
+		return make_pair(0., 0.);
+	if (pos < retained_sample_count())
+		return retained_samples_->envelope(pos);
+
+	const double value = value_at(pos);
+	return make_pair(value, value);
+}
+
+double AnalogTimeSignal::get_resolution(size_t pos) const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	if (pos < retained_sample_count())
+		return retained_samples_->resolution(pos);
+	return 0.;
+}
+
 void AnalogTimeSignal::push_sample(void *sample, double timestamp,
 	size_t unit_size, int digits, int decimal_places)
 {
 	double dsample = 0.;
+	unique_lock<recursive_mutex> lock(mutex_);
+	if (mapped_samples_) {
+		qWarning() << "AnalogTimeSignal::push_sample(): " << display_name()
+			<< " is read only!";
+		return;
+	}
+
 	if (unit_size == size_of_float_)
 		dsample = (double) *(float *)sample;
 	else if (unit_size == size_of_double_)
@@ -160,7 +343,6 @@ void AnalogTimeSignal::push_sample(void *sample, double timestamp,
 		<< ": sample_count_ = " << sample_count_+1;
 	*/
 
-	// TODO: Mutex?
 	last_timestamp_ = timestamp;
 	last_value_ = dsample;
 	if (min_value_ > dsample)
@@ -183,10 +365,12 @@ void AnalogTimeSignal::push_sample(void *sample, double timestamp,
 		<< ": max_value_ = " << max_value_;
 	*/
 
-	// TODO: Mutex?
-	time_->push_back(timestamp);
+	add_timebase_run(timebase_->append(timestamp), 1);
 	data_->push_back(dsample);
 	sample_count_++;
+	compress_cold_samples();
+	retain_old_samples();
+	lock.unlock();
 	Q_EMIT sample_appended();
 
 	bool digits_chngd = false;
@@ -206,7 +390,13 @@ void AnalogTimeSignal::push_samples(void *data,
 	uint64_t samples, double timestamp, uint64_t samplerate, size_t unit_size,
 	int digits, int decimal_places)
 {
-	//lock_guard<recursive_mutex> lock(mutex_);
+	unique_lock<recursive_mutex> lock(mutex_);
+
+	if (mapped_samples_) {
+		qWarning() << "AnalogTimeSignal::push_samples(): " << display_name()
+			<< " is read only!";
+		return;
+	}
 
 	double dsample = 0.0;
 	uint64_t pos = 0;
@@ -214,6 +404,9 @@ void AnalogTimeSignal::push_samples(void *data,
 	if (samplerate > 0)
 		time_stride = 1 / (double)samplerate;
 
+	add_timebase_run(timebase_->append(timestamp, time_stride, samples),
+		samples);
+
 	/*
 	if (timestamp < last_timestamp_) {
 		qWarning() << "AnalogSignal::push_samples(): samples = " << samples
@@ -237,7 +430,6 @@ void AnalogTimeSignal::push_samples(void *data,
 			<< ": remaining_samples = " << remaining_samples;
 		*/
 
-		// TODO: Mutex?
 		if (min_value_ > dsample)
 			min_value_ = dsample;
 		// Ignore infinitiy (overflow) as max value.
@@ -247,17 +439,18 @@ void AnalogTimeSignal::push_samples(void *data,
 			max_value_ = dsample;
 		}
 
-		// TODO: Limit memory!
-		time_->push_back(timestamp);
 		data_->push_back(dsample);
 
 		timestamp += time_stride;
 		++pos;
-		++sample_count_;
 	}
 
+	sample_count_ += samples;
 	last_timestamp_ = timestamp - time_stride;
 	last_value_ = dsample;
+	compress_cold_samples();
+	retain_old_samples();
+	lock.unlock();
 	Q_EMIT sample_appended();
 
 	bool digits_chngd = false;
@@ -273,6 +466,196 @@ void AnalogTimeSignal::push_samples(void *data,
 		Q_EMIT digits_changed(digits_, decimal_places_);
 }
 
+void AnalogTimeSignal::push_samples(const double *timestamps,
+	const double *values, size_t count, int digits, int decimal_places)
+{
+	unique_lock<recursive_mutex> lock(mutex_);
+	if (mapped_samples_) {
+		qWarning() << "AnalogTimeSignal::push_samples(): " << display_name()
+			<< " is read only!";
+		return;
+	}
+	if (count == 0)
+		return;
+
+	for (size_t i = 0; i < count; ++i) {
+		if (min_value_ > values[i])
+			min_value_ = values[i];
+		// Ignore infinitiy (overflow) as max value.
+		if (max_value_ < values[i] &&
+			values[i] != std::numeric_limits<double>::infinity()) {
+
+			max_value_ = values[i];
+		}
+	}
+
+	add_timebase_run(timebase_->append(timestamps, count), count);
+	data_->insert(data_->end(), values, values + count);
+	sample_count_ += count;
+	last_timestamp_ = timestamps[count - 1];
+	last_value_ = values[count - 1];
+	compress_cold_samples();
+	retain_old_samples();
+	lock.unlock();
+	Q_EMIT sample_appended();
+
+	bool digits_chngd = false;
+	if (digits != digits_) {
+		digits_ = digits;
+		digits_chngd = true;
+	}
+	if (decimal_places != decimal_places_) {
+		decimal_places_ = decimal_places;
+		digits_chngd = true;
+	}
+	if (digits_chngd)
+		Q_EMIT digits_changed(digits_, decimal_places_);
+}
+
+void AnalogTimeSignal::push_samples(void *data, uint64_t samples,
+	shared_ptr<Timebase> timebase, size_t timebase_index,
+	size_t unit_size, int digits, int decimal_places)
+{
+	unique_lock<recursive_mutex> lock(mutex_);
+	if (mapped_samples_) {
+		qWarning() << "AnalogTimeSignal::push_samples(): " << display_name()
+			<< " is read only!";
+		return;
+	}
+	if (samples == 0)
+		return;
+
+	if (timebase != timebase_) {
+		if (sample_count_ == 0) {
+			set_timebase(timebase);
+			timebase_->release(timebase_handle_, timebase_index);
+		}
+		else {
+			vector<double> timestamps(samples);
+			timebase->copy(timebase_index, samples, timestamps.data());
+			timebase_index = timebase_->append(timestamps.data(), samples);
+		}
+	}
+	add_timebase_run(timebase_index, samples);
+
+	double dsample = 0.;
+	for (uint64_t pos = 0; pos < samples; ++pos) {
+		if (unit_size == size_of_float_)
+			dsample = (double) ((float *)data)[pos];
+		else if (unit_size == size_of_double_)
+			dsample = ((double *)data)[pos];
+
+		if (min_value_ > dsample)
+			min_value_ = dsample;
+		// Ignore infinitiy (overflow) as max value.
+		if (max_value_ < dsample &&
+			dsample != std::numeric_limits<double>::infinity()) {
+
+			max_value_ = dsample;
+		}
+
+		data_->push_back(dsample);
+	}
+
+	sample_count_ += samples;
+	last_timestamp_ = timebase_->timestamp(timebase_index + samples - 1);
+	last_value_ = dsample;
+	compress_cold_samples();
+	retain_old_samples();
+	lock.unlock();
+	Q_EMIT sample_appended();
+
+	bool digits_chngd = false;
+	if (digits != digits_) {
+		digits_ = digits;
+		digits_chngd = true;
+	}
+	if (decimal_places != decimal_places_) {
+		decimal_places_ = decimal_places;
+		digits_chngd = true;
+	}
+	if (digits_chngd)
+		Q_EMIT digits_changed(digits_, decimal_places_);
+}
+
+shared_ptr<Timebase> AnalogTimeSignal::timebase() const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	return timebase_;
+}
+
+void AnalogTimeSignal::set_mapped_samples(
+	shared_ptr<MappedSamples> mapped_samples, int digits, int decimal_places)
+{
+	unique_lock<recursive_mutex> lock(mutex_);
+	set_timebase(make_shared<Timebase>());
+	data_->clear();
+	compressed_samples_ = make_shared<CompressedSamples>();
+	retained_samples_ = nullptr;
+	mapped_samples_ = mapped_samples;
+	sample_count_ = mapped_samples_->sample_count();
+	digits_ = digits;
+	decimal_places_ = decimal_places;
+	if (sample_count_ > 0) {
+		last_timestamp_ = mapped_samples_->timestamp(sample_count_ - 1);
+		last_value_ = mapped_samples_->value(sample_count_ - 1);
+		min_value_ = mapped_samples_->min_value();
+		max_value_ = mapped_samples_->max_value();
+	}
+	lock.unlock();
+
+	Q_EMIT digits_changed(digits_, decimal_places_);
+	Q_EMIT sample_appended();
+}
+
+bool AnalogTimeSignal::is_read_only() const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	return mapped_samples_ != nullptr;
+}
+
+void AnalogTimeSignal::set_compression_enabled(bool enabled)
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	compression_enabled_ = enabled;
+	timebase_->set_compression_enabled(enabled);
+}
+
+bool AnalogTimeSignal::is_compression_enabled() const
+{
+	return compression_enabled_;
+}
+
+size_t AnalogTimeSignal::compressed_sample_count() const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	return compressed_samples_->sample_count();
+}
+
+bool AnalogTimeSignal::set_retention_policy(double raw_duration,
+	const vector<retention_tier_t> &tiers)
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	if (retained_sample_count() > 0) {
+		qWarning() << "AnalogTimeSignal::set_retention_policy(): "
+			<< display_name() << ": Samples have already been retained!";
+		return false;
+	}
+
+	if (tiers.empty())
+		retained_samples_ = nullptr;
+	else
+		retained_samples_ = make_shared<RetainedSamples>(raw_duration, tiers);
+	next_retention_timestamp_ = 0.;
+	return true;
+}
+
+size_t AnalogTimeSignal::retained_sample_count() const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	return retained_samples_ ? retained_samples_->sample_count() : 0;
+}
+
 double AnalogTimeSignal::signal_start_timestamp() const
 {
 	return signal_start_timestamp_;
@@ -280,18 +663,20 @@ double AnalogTimeSignal::signal_start_timestamp() const
 
 double AnalogTimeSignal::first_timestamp(bool relative_time) const
 {
-	if (time_->empty())
+	lock_guard<recursive_mutex> lock(mutex_);
+	if (sample_count_ == 0)
 		return 0.;
 
 	if (relative_time)
-		return time_->front() - signal_start_timestamp_;
+		return timestamp_at(0) - signal_start_timestamp_;
 	else // NOLINT
-		return time_->front();
+		return timestamp_at(0);
 }
 
 double AnalogTimeSignal::last_timestamp(bool relative_time) const
 {
-	if (time_->empty())
+	lock_guard<recursive_mutex> lock(mutex_);
+	if (sample_count_ == 0)
 		return 0.;
 
 	if (relative_time)
@@ -300,6 +685,155 @@ double AnalogTimeSignal::last_timestamp(bool relative_time) const
 		return last_timestamp_;
 }
 
+double AnalogTimeSignal::timestamp_at(size_t pos) const
+{
+	if (mapped_samples_)
+		return mapped_samples_->timestamp(pos);
+	if (pos < retained_sample_count())
+		return retained_samples_->timestamp(pos);
+	return timebase_->timestamp(timebase_index(pos));
+}
+
+double AnalogTimeSignal::value_at(size_t pos) const
+{
+	if (mapped_samples_)
+		return mapped_samples_->value(pos);
+	const size_t retained_count = retained_sample_count();
+	if (pos < retained_count)
+		return retained_samples_->value(pos);
+	pos -= retained_count;
+	const size_t compressed_count = compressed_samples_->sample_count();
+	if (pos < compressed_count)
+		return compressed_samples_->value(pos);
+	return (*data_)[pos - compressed_count];
+}
+
+void AnalogTimeSignal::compress_cold_samples()
+{
+	if (!compression_enabled_)
+		return;
+
+	size_t count = 0;
+	while (data_->size() - count >=
+			hot_sample_count_ + compression_block_size_) {
+		compressed_samples_->append_block(nullptr,
+			data_->data() + count, compression_block_size_);
+		count += compression_block_size_;
+	}
+	if (count == 0)
+		return;
+
+	data_->erase(data_->begin(), data_->begin() + count);
+}
+
+void AnalogTimeSignal::retain_old_samples()
+{
+	if (!retained_samples_ || last_timestamp_ < next_retention_timestamp_)
+		return;
+	next_retention_timestamp_ = last_timestamp_ + retention_interval_;
+
+	const double raw_start = last_timestamp_ - retained_samples_->raw_duration();
+
+	// Whole compressed blocks, that are older than the raw duration.
+	vector<double> timestamps;
+	vector<double> values;
+	while (compressed_samples_->block_count() > 0) {
+		const size_t pos = retained_samples_->sample_count();
+		const size_t count = compressed_samples_->first_block_sample_count();
+		if (timestamp_at(pos + count - 1) >= raw_start)
+			break;
+		compressed_samples_->take_first_block(timestamps, values);
+		timestamps.resize(count);
+		copy_timestamps(pos, count, timestamps.data());
+		retained_samples_->add_samples(timestamps.data(), values.data(), count);
+	}
+
+	// The hot samples follow the compressed samples.
+	if (compressed_samples_->sample_count() == 0) {
+		const size_t pos = retained_samples_->sample_count();
+		const size_t end = lower_bound_pos(raw_start, false);
+		if (end > pos) {
+			const size_t count = end - pos;
+			timestamps.resize(count);
+			copy_timestamps(pos, count, timestamps.data());
+			retained_samples_->add_samples(
+				timestamps.data(), data_->data(), count);
+			data_->erase(data_->begin(), data_->begin() + count);
+		}
+	}
+
+	retained_samples_->compact(last_timestamp_);
+
+	// The timestamps of the retained samples are not needed anymore. The
+	// runs don't have to be in the order of the timebase (e.g. the same
+	// frame timebase index for several packets), so only the timestamps
+	// before the lowest index, that is still used by a run, are released.
+	const size_t retained_count = retained_samples_->sample_count();
+	if (retained_count == 0)
+		return;
+	const size_t last_pos = retained_count - 1;
+	auto run = std::upper_bound(timebase_runs_.begin(), timebase_runs_.end(),
+		last_pos,
+		[](size_t p, const TimebaseRun &r) { return p < r.pos; }) - 1;
+	size_t release_index = run->index + (last_pos - run->pos) + 1;
+	for (auto it = run + 1; it != timebase_runs_.end(); ++it)
+		release_index = std::min(release_index, it->index);
+	timebase_->release(timebase_handle_, release_index);
+	timebase_runs_.erase(timebase_runs_.begin(), run);
+}
+
+void AnalogTimeSignal::set_timebase(shared_ptr<Timebase> timebase)
+{
+	if (timebase_)
+		timebase_->detach(timebase_handle_);
+	timebase_ = timebase;
+	timebase_->set_compression_enabled(compression_enabled_);
+	timebase_handle_ = timebase_->attach();
+	timebase_runs_.clear();
+}
+
+size_t AnalogTimeSignal::timebase_index(size_t pos) const
+{
+	// Usually all samples are in the last run.
+	auto run = timebase_runs_.end() - 1;
+	if (run->pos > pos) {
+		run = std::upper_bound(timebase_runs_.begin(), timebase_runs_.end(),
+			pos, [](size_t p, const TimebaseRun &r) { return p < r.pos; }) - 1;
+	}
+	return run->index + (pos - run->pos);
+}
+
+void AnalogTimeSignal::copy_timestamps(size_t pos, size_t count,
+	double *timestamps) const
+{
+	auto run = std::upper_bound(timebase_runs_.begin(), timebase_runs_.end(),
+		pos, [](size_t p, const TimebaseRun &r) { return p < r.pos; }) - 1;
+	size_t copied = 0;
+	while (copied < count) {
+		const size_t run_pos = pos + copied;
+		size_t n = count - copied;
+		if (run + 1 != timebase_runs_.end())
+			n = std::min(n, (run + 1)->pos - run_pos);
+		timebase_->copy(run->index + (run_pos - run->pos), n,
+			timestamps + copied);
+		copied += n;
+		++run;
+	}
+}
+
+void AnalogTimeSignal::add_timebase_run(size_t timebase_index, size_t count)
+{
+	if (count == 0)
+		return;
+
+	if (!timebase_runs_.empty()) {
+		const auto &run = timebase_runs_.back();
+		if (run.index + (sample_count_ - run.pos) == timebase_index)
+			return;
+	}
+	timebase_runs_.push_back({ sample_count_, timebase_index });
+}
+
 void AnalogTimeSignal::on_channel_start_timestamp_changed(double timestamp)
 {
 	signal_start_timestamp_ = timestamp;
@@ -21,6 +21,7 @@
 #define DATA_ANALOGTIMESIGNAL_HPP
 
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -30,8 +31,10 @@
 
 #include "src/data/analogbasesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/retainedsamples.hpp"
 
 using std::pair;
+using std::recursive_mutex;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -40,6 +43,10 @@ using std::vector;
 namespace sv {
 namespace data {
 
+class CompressedSamples;
+class MappedSamples;
+class Timebase;
+
 typedef pair<double, double> analog_time_sample_t;
 
 class AnalogTimeSignal : public AnalogBaseSignal
@@ -54,6 +61,7 @@ public:
 		shared_ptr<channels::BaseChannel> parent_channel,
 		double signal_start_timestamp,
 		const string &custom_name = "");
+	~AnalogTimeSignal();
 
 	/**
 	 * Clear all samples from this signal.
@@ -65,6 +73,48 @@ public:
 	 */
 	analog_time_sample_t get_sample(size_t pos, bool relative_time) const;
 
+	/**
+	 * Copy up to count samples, starting at pos, into the given vectors. This
+	 * is much faster than calling get_sample() for every sample, when many
+	 * samples must be read (e.g. for exports).
+	 *
+	 * @param pos The position of the first sample to copy.
+	 * @param count The max. number of samples to copy.
+	 * @param timestamps The vector to store the timestamps to.
+	 * @param values The vector to store the values to.
+	 * @param relative_time Use time relative to the session start time.
+	 *
+	 * @return The number of copied samples.
+	 */
+	size_t get_samples(size_t pos, size_t count, vector<double> &timestamps,
+		vector<double> &values, bool relative_time) const;
+
+	/**
+	 * Copy up to count samples, starting at pos, into the given arrays, that
+	 * must have room for count samples. timestamps or values can be nullptr,
+	 * if they are not needed.
+	 *
+	 * @return The number of copied samples.
+	 */
+	size_t get_samples(size_t pos, size_t count, double *timestamps,
+		double *values, bool relative_time) const;
+
+	/**
+	 * Copy up to count samples for an export or a recording, starting at
+	 * pos and ending before end. Unlike get_samples(), the retained
+	 * (downsampled) samples are copied as one sample per bucket (the mean
+	 * value at the center of the bucket), instead of one interpolated sample
+	 * per position.
+	 *
+	 * @param pos The position of the first sample to copy. It is set to the
+	 *            position after the last copied sample.
+	 *
+	 * @return The number of copied samples.
+	 */
+	size_t get_export_samples(size_t &pos, size_t end, size_t count,
+		vector<double> &timestamps, vector<double> &values,
+		bool relative_time) const;
+
 	/**
 	 * Return the last captured sample.
 	 */
@@ -86,6 +136,30 @@ public:
 	bool get_value_at_timestamp(
 		double timestamp, double &value, bool relative_time) const;
 
+	/**
+	 * Return the position of the first sample with a timestamp that is not
+	 * less than the given timestamp. If all samples are older than the
+	 * timestamp, sample_count() is returned.
+	 *
+	 * @param timestamp The timestamp to search for.
+	 * @param relative_time Use time relative to the session start time.
+	 *
+	 * @return The position of the found sample.
+	 */
+	size_t lower_bound_pos(double timestamp, bool relative_time) const;
+
+	/**
+	 * Return the envelope (min and max value) of the sample at the given
+	 * position. For samples with full resolution, both are the sample value.
+	 */
+	pair<double, double> get_envelope(size_t pos) const;
+
+	/**
+	 * Return the time resolution of the sample at the given position in
+	 * seconds. Samples with full resolution return 0.
+	 */
+	double get_resolution(size_t pos) const;
+
 	/**
 	 * Push a single sample to the signal.
 	 *
@@ -100,6 +174,66 @@ public:
 	void push_samples(void *data, uint64_t samples, double timestamp,
 		uint64_t samplerate, size_t unit_size, int digits, int decimal_places);
 
+	/**
+	 * Push multiple samples with individual timestamps to the signal. The
+	 * timestamps must be in ascending order. sample_appended() is only
+	 * emitted once for all samples.
+	 */
+	void push_samples(const double *timestamps, const double *values,
+		size_t count, int digits, int decimal_places);
+
+	/**
+	 * Push multiple samples, whose timestamps have already been appended to
+	 * a (shared) timebase. An empty signal uses the timebase from now on,
+	 * so signals sampled together store their timestamps only once. If the
+	 * signal already uses another timebase, the timestamps are copied.
+	 */
+	void push_samples(void *data, uint64_t samples,
+		shared_ptr<Timebase> timebase, size_t timebase_index,
+		size_t unit_size, int digits, int decimal_places);
+	shared_ptr<Timebase> timebase() const;
+
+	/**
+	 * Use the samples of a memory mapped session file. The signal is read
+	 * only afterwards, pushing new samples is not possible.
+	 */
+	void set_mapped_samples(shared_ptr<MappedSamples> mapped_samples,
+		int digits, int decimal_places);
+	bool is_read_only() const;
+
+	/**
+	 * Enable or disable the compression of the older samples. When enabled,
+	 * all but the newest samples are stored compressed in memory. Already
+	 * compressed samples stay compressed when disabling the compression.
+	 * This also applies to the timestamps of all signals, that share the
+	 * timebase with this signal.
+	 */
+	void set_compression_enabled(bool enabled);
+	bool is_compression_enabled() const;
+	/** The number of samples, that are stored compressed. */
+	size_t compressed_sample_count() const;
+
+	/**
+	 * Set a tiered retention policy. Samples older than raw_duration are
+	 * aggregated into min/max/mean buckets of the first tier. Buckets older
+	 * than the duration of their tier are moved into the next (coarser)
+	 * tier. The last tier is kept forever. The positions of the samples
+	 * don't change, get_sample() returns the mean of the bucket.
+	 *
+	 * The policy can't be changed, once samples have been retained.
+	 *
+	 * @param raw_duration The time in seconds, samples are kept with full
+	 *                     resolution.
+	 * @param tiers The tiers from fine to coarse. No tiers disable the
+	 *              retention.
+	 *
+	 * @return false if samples have already been retained.
+	 */
+	bool set_retention_policy(double raw_duration,
+		const vector<retention_tier_t> &tiers);
+	/** The number of samples, that are not stored with full resolution. */
+	size_t retained_sample_count() const;
+
 	double signal_start_timestamp() const;
 	double first_timestamp(bool relative_time) const;
 	double last_timestamp(bool relative_time) const;
@@ -130,9 +264,53 @@ public:
 		shared_ptr<vector<double>> data2_vector);
 
 private:
-	shared_ptr<vector<double>> time_;
+	double timestamp_at(size_t pos) const;
+	double value_at(size_t pos) const;
+	/** Move full blocks of old samples into the compressed storage. */
+	void compress_cold_samples();
+	/** Move samples older than the raw duration into the retention tiers. */
+	void retain_old_samples();
+	void set_timebase(shared_ptr<Timebase> timebase);
+	size_t timebase_index(size_t pos) const;
+	void copy_timestamps(size_t pos, size_t count, double *timestamps) const;
+	/** Map the next count samples to the timebase, starting at index. */
+	void add_timebase_run(size_t timebase_index, size_t count);
+
+	/**
+	 * The positions of the signal starting at pos are mapped to the indices
+	 * of the timebase starting at index, until the next run.
+	 */
+	struct TimebaseRun
+	{
+		size_t pos;
+		size_t index;
+	};
+
+	shared_ptr<Timebase> timebase_;
+	size_t timebase_handle_;
+	/** Usually there is only one run, unless the signal missed samples. */
+	vector<TimebaseRun> timebase_runs_;
+	shared_ptr<MappedSamples> mapped_samples_;
+	/** The older values, data_ only holds the newest values. */
+	shared_ptr<CompressedSamples> compressed_samples_;
+	bool compression_enabled_;
+	/** The oldest samples, downsampled. Null without a retention policy. */
+	shared_ptr<RetainedSamples> retained_samples_;
+	double next_retention_timestamp_;
 	double signal_start_timestamp_;
 	double last_timestamp_;
+	/**
+	 * Protects the sample storage. The acquisition thread pushes samples
+	 * while the UI and the Python threads read them.
+	 */
+	mutable recursive_mutex mutex_;
+
+	/** The number of samples, that are compressed together. */
+	static const size_t compression_block_size_ = 4096;
+	/** The number of newest samples, that are never compressed. */
+	static const size_t hot_sample_count_ = 65536;
+	/** The interval in seconds, old samples are moved into the tiers. */
+	static const double retention_interval_;
 
 public Q_SLOTS:
 	void on_channel_start_timestamp_changed(double timestamp);
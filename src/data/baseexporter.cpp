@@ -0,0 +1,135 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "baseexporter.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+BaseExporter::BaseExporter(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &file_name) :
+	QObject(),
+	signals_(signals),
+	file_name_(file_name),
+	cancel_requested_(false),
+	is_running_(false),
+	progress_(-1)
+{
+}
+
+BaseExporter::~BaseExporter()
+{
+	wait();
+}
+
+void BaseExporter::start()
+{
+	if (is_running_)
+		return;
+	if (export_thread_.joinable())
+		export_thread_.join();
+
+	cancel_requested_ = false;
+	is_running_ = true;
+	error_.clear();
+	progress_ = -1;
+	export_thread_ = std::thread(&BaseExporter::export_thread_proc, this);
+}
+
+void BaseExporter::cancel()
+{
+	cancel_requested_ = true;
+}
+
+bool BaseExporter::is_running() const
+{
+	return is_running_;
+}
+
+string BaseExporter::error() const
+{
+	return error_;
+}
+
+void BaseExporter::wait()
+{
+	cancel();
+	if (export_thread_.joinable())
+		export_thread_.join();
+}
+
+bool BaseExporter::update_progress(uint64_t done, uint64_t total)
+{
+	if (cancel_requested_)
+		return false;
+
+	const int progress = total > 0 ? (int)(done * 1000 / total) : 1000;
+	if (progress != progress_) {
+		progress_ = progress;
+		Q_EMIT progress_changed(progress);
+	}
+	return true;
+}
+
+void BaseExporter::export_thread_proc()
+{
+	bool success = false;
+	try {
+		success = export_file();
+	}
+	catch (std::bad_alloc &) {
+		error_ = "Not enough memory to export the signals";
+		success = false;
+	}
+	catch (std::exception &e) {
+		error_ = e.what();
+		success = false;
+	}
+
+	// Don't leave a partial file behind
+	if (!success)
+		std::remove(file_name_.c_str());
+
+	if (!success && cancel_requested_)
+		error_.clear();
+	else if (!success && error_.empty())
+		error_ = "Could not write to file " + file_name_;
+
+	is_running_ = false;
+	Q_EMIT finished(success);
+}
+
+} // namespace data
+} // namespace sv
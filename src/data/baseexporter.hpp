@@ -0,0 +1,102 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DATA_BASEEXPORTER_HPP
+#define DATA_BASEEXPORTER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Base class for the exporters, that write signals to a file in a background
+ * thread.
+ *
+ * The export can be canceled, the progress is reported in per mille. A
+ * partial file is removed when the export fails or is canceled.
+ */
+class BaseExporter : public QObject
+{
+	Q_OBJECT
+
+public:
+	BaseExporter(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &file_name);
+	virtual ~BaseExporter();
+
+	void start();
+	/** Request the export to stop. finished() will be emitted. */
+	void cancel();
+	bool is_running() const;
+	/** The error message of a failed export. */
+	string error() const;
+
+protected:
+	/**
+	 * Write the file. This is called in the export thread. On failure
+	 * error_ can be set, otherwise a generic error message is used.
+	 */
+	virtual bool export_file() = 0;
+	/**
+	 * Cancel the export and wait for the export thread. Derived classes must
+	 * call this in their destructor, because export_file() may still use
+	 * their members.
+	 */
+	void wait();
+	/** Report the progress. Returns false if the export was canceled. */
+	bool update_progress(uint64_t done, uint64_t total);
+
+	const vector<shared_ptr<AnalogTimeSignal>> signals_;
+	const string file_name_;
+	std::atomic<bool> cancel_requested_;
+	string error_;
+
+private:
+	void export_thread_proc();
+
+	std::thread export_thread_;
+	std::atomic<bool> is_running_;
+	int progress_;
+
+Q_SIGNALS:
+	/** The progress of the export in per mille. */
+	void progress_changed(int progress);
+	void finished(bool success);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_BASEEXPORTER_HPP
@@ -0,0 +1,465 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "compressedsamples.hpp"
+
+using std::lock_guard;
+using std::mutex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+enum ColumnMode : uint8_t {
+	/** Decimal numbers stored as (delta encoded) integers. */
+	QuantizedColumn = 0,
+	/** Delta-of-delta of the bit patterns, for monotonic timestamps. */
+	BitDeltaColumn = 1,
+	/** XOR with the previous value, only the non-zero bytes are stored. */
+	XorColumn = 2,
+};
+
+const int max_decimal_places = 9;
+const double pow10[max_decimal_places + 1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+inline uint64_t to_bits(double value)
+{
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+inline double from_bits(uint64_t bits)
+{
+	double value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+void write_varint(vector<uint8_t> &out, uint64_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t read_varint(const uint8_t *&in)
+{
+	uint64_t value = 0;
+	int shift = 0;
+	uint8_t byte;
+	do {
+		byte = *in++;
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+	return value;
+}
+
+inline uint64_t zigzag_encode(uint64_t value)
+{
+	return (value << 1) ^ (0 - (value >> 63));
+}
+
+inline uint64_t zigzag_decode(uint64_t value)
+{
+	return (value >> 1) ^ (0 - (value & 1));
+}
+
+/**
+ * Write the integers as deltas (order 1) or delta-of-deltas (order 2). The
+ * arithmetic is done unsigned, so overflows wrap around and are restored
+ * when decoding.
+ */
+void write_integers(vector<uint8_t> &out, const vector<uint64_t> &integers,
+	int order)
+{
+	uint64_t prev = 0;
+	uint64_t prev_delta = 0;
+	for (const uint64_t integer : integers) {
+		uint64_t delta = integer - prev;
+		write_varint(out, zigzag_encode(order == 1 ? delta : delta - prev_delta));
+		prev = integer;
+		prev_delta = delta;
+	}
+}
+
+void read_integers(const uint8_t *&in, size_t count, int order,
+	uint64_t *integers)
+{
+	uint64_t prev = 0;
+	uint64_t prev_delta = 0;
+	for (size_t i = 0; i < count; ++i) {
+		uint64_t delta = zigzag_decode(read_varint(in));
+		if (order == 2)
+			delta += prev_delta;
+		prev += delta;
+		prev_delta = delta;
+		integers[i] = prev;
+	}
+}
+
+/**
+ * Find the smallest number of decimal places, that represents all values
+ * exactly as integers.
+ */
+bool quantize(const double *values, size_t count, int &decimal_places,
+	vector<uint64_t> &integers)
+{
+	integers.resize(count);
+	for (int dp = 0; dp <= max_decimal_places; ++dp) {
+		const double scale = pow10[dp];
+		size_t i = 0;
+		for (; i < count; ++i) {
+			const double scaled = values[i] * scale;
+			// Integers up to 2^53 are exact in a double.
+			if (!std::isfinite(scaled) || std::fabs(scaled) > 9007199254740992.)
+				return false;
+			const int64_t integer = std::llround(scaled);
+			// Compare the bits, to also preserve the sign of 0.
+			if (to_bits(static_cast<double>(integer) / scale) != to_bits(values[i]))
+				break;
+			integers[i] = static_cast<uint64_t>(integer);
+		}
+		if (i == count) {
+			decimal_places = dp;
+			return true;
+		}
+	}
+	return false;
+}
+
+void write_xor(vector<uint8_t> &out, const double *values, size_t count)
+{
+	uint64_t prev = 0;
+	for (size_t i = 0; i < count; ++i) {
+		const uint64_t bits = to_bits(values[i]);
+		const uint64_t x = bits ^ prev;
+		prev = bits;
+
+		int leading = 0;
+		int trailing = 0;
+		if (x == 0) {
+			leading = 8;
+		}
+		else {
+			while (((x >> (56 - 8 * leading)) & 0xff) == 0)
+				++leading;
+			while (((x >> (8 * trailing)) & 0xff) == 0)
+				++trailing;
+		}
+		out.push_back(static_cast<uint8_t>((leading << 4) | trailing));
+		for (int b = 7 - leading; b >= trailing; --b)
+			out.push_back(static_cast<uint8_t>(x >> (8 * b)));
+	}
+}
+
+void read_xor(const uint8_t *&in, size_t count, double *values)
+{
+	uint64_t prev = 0;
+	for (size_t i = 0; i < count; ++i) {
+		const uint8_t header = *in++;
+		const int leading = header >> 4;
+		const int trailing = header & 0x0f;
+		uint64_t x = 0;
+		for (int b = 7 - leading; b >= trailing; --b)
+			x |= static_cast<uint64_t>(*in++) << (8 * b);
+		prev ^= x;
+		values[i] = from_bits(prev);
+	}
+}
+
+/**
+ * Compress a column. Timestamps are delta-of-delta encoded, values are
+ * delta or XOR encoded.
+ */
+vector<uint8_t> compress_column(const double *data, size_t count,
+	bool is_timestamp)
+{
+	vector<uint8_t> out;
+	out.reserve(count * 2 + 2);
+	const int order = is_timestamp ? 2 : 1;
+
+	int decimal_places;
+	vector<uint64_t> integers;
+	if (quantize(data, count, decimal_places, integers)) {
+		out.push_back(QuantizedColumn);
+		out.push_back(static_cast<uint8_t>(decimal_places));
+		write_integers(out, integers, order);
+	}
+	else if (is_timestamp) {
+		for (size_t i = 0; i < count; ++i)
+			integers[i] = to_bits(data[i]);
+		out.push_back(BitDeltaColumn);
+		out.push_back(0);
+		write_integers(out, integers, order);
+	}
+	else {
+		out.push_back(XorColumn);
+		out.push_back(0);
+		write_xor(out, data, count);
+	}
+
+	out.shrink_to_fit();
+	return out;
+}
+
+void decompress_column(const vector<uint8_t> &column, size_t count,
+	bool is_timestamp, double *data)
+{
+	const uint8_t *in = column.data();
+	const uint8_t mode = *in++;
+	const uint8_t param = *in++;
+	const int order = is_timestamp ? 2 : 1;
+
+	if (mode == XorColumn) {
+		read_xor(in, count, data);
+		return;
+	}
+
+	vector<uint64_t> integers(count);
+	read_integers(in, count, order, integers.data());
+	if (mode == QuantizedColumn) {
+		const double scale = pow10[param];
+		for (size_t i = 0; i < count; ++i) {
+			data[i] = static_cast<double>(
+				static_cast<int64_t>(integers[i])) / scale;
+		}
+	}
+	else {
+		for (size_t i = 0; i < count; ++i)
+			data[i] = from_bits(integers[i]);
+	}
+}
+
+} // namespace
+
+CompressedSamples::CompressedSamples() :
+	removed_count_(0),
+	sample_count_(0),
+	memory_size_(0),
+	cache_counter_(0)
+{
+	// The cache entries must not be moved, references to them are returned.
+	cache_.reserve(cache_size_);
+}
+
+void CompressedSamples::append_block(const double *timestamps,
+	const double *values, size_t count)
+{
+	if (count == 0)
+		return;
+
+	Block block;
+	block.start_pos = removed_count_ + sample_count_;
+	block.count = count;
+	block.first_timestamp = 0.;
+	block.last_timestamp = 0.;
+	if (timestamps) {
+		block.first_timestamp = timestamps[0];
+		block.last_timestamp = timestamps[count - 1];
+		block.timestamps = compress_column(timestamps, count, true);
+	}
+	if (values)
+		block.values = compress_column(values, count, false);
+
+	memory_size_ += sizeof(Block) +
+		block.timestamps.size() + block.values.size();
+	sample_count_ += count;
+	blocks_.push_back(std::move(block));
+}
+
+void CompressedSamples::take_first_block(vector<double> &timestamps,
+	vector<double> &values)
+{
+	if (blocks_.empty()) {
+		timestamps.clear();
+		values.clear();
+		return;
+	}
+
+	const Block &block = blocks_.front();
+	timestamps.clear();
+	values.clear();
+	if (!block.timestamps.empty()) {
+		timestamps.resize(block.count);
+		decompress_column(block.timestamps, block.count, true,
+			timestamps.data());
+	}
+	if (!block.values.empty()) {
+		values.resize(block.count);
+		decompress_column(block.values, block.count, false, values.data());
+	}
+
+	lock_guard<mutex> lock(cache_mutex_);
+	memory_size_ -= sizeof(Block) +
+		block.timestamps.size() + block.values.size();
+	removed_count_ += block.count;
+	sample_count_ -= block.count;
+	blocks_.erase(blocks_.begin());
+}
+
+size_t CompressedSamples::sample_count() const
+{
+	return sample_count_;
+}
+
+size_t CompressedSamples::block_count() const
+{
+	return blocks_.size();
+}
+
+size_t CompressedSamples::memory_size() const
+{
+	return memory_size_;
+}
+
+size_t CompressedSamples::first_block_sample_count() const
+{
+	return blocks_.front().count;
+}
+
+double CompressedSamples::timestamp(size_t pos) const
+{
+	lock_guard<mutex> lock(cache_mutex_);
+	const size_t index = block_index(pos);
+	return decompressed_block(index).timestamps[
+		removed_count_ + pos - blocks_[index].start_pos];
+}
+
+double CompressedSamples::value(size_t pos) const
+{
+	lock_guard<mutex> lock(cache_mutex_);
+	const size_t index = block_index(pos);
+	return decompressed_block(index).values[
+		removed_count_ + pos - blocks_[index].start_pos];
+}
+
+size_t CompressedSamples::copy(size_t pos, size_t count,
+	double *timestamps, double *values) const
+{
+	if (pos >= sample_count_)
+		return 0;
+	count = std::min(count, sample_count_ - pos);
+
+	lock_guard<mutex> lock(cache_mutex_);
+	size_t copied = 0;
+	size_t index = block_index(pos);
+	while (copied < count) {
+		const Block &block = blocks_[index];
+		const CacheEntry &entry = decompressed_block(index);
+		const size_t offset = removed_count_ + pos + copied - block.start_pos;
+		const size_t n = std::min(count - copied, block.count - offset);
+		if (timestamps) {
+			std::copy(entry.timestamps.begin() + offset,
+				entry.timestamps.begin() + offset + n, timestamps + copied);
+		}
+		if (values) {
+			std::copy(entry.values.begin() + offset,
+				entry.values.begin() + offset + n, values + copied);
+		}
+		copied += n;
+		++index;
+	}
+	return copied;
+}
+
+size_t CompressedSamples::lower_bound_pos(double timestamp) const
+{
+	// First block that ends at or after the timestamp.
+	const auto it = std::partition_point(blocks_.begin(), blocks_.end(),
+		[timestamp](const Block &block) {
+			return block.last_timestamp < timestamp;
+		});
+	if (it == blocks_.end())
+		return sample_count_;
+	if (it->first_timestamp >= timestamp)
+		return it->start_pos - removed_count_;
+
+	lock_guard<mutex> lock(cache_mutex_);
+	const CacheEntry &entry = decompressed_block(it - blocks_.begin());
+	const auto ts_it = std::lower_bound(
+		entry.timestamps.begin(), entry.timestamps.end(), timestamp);
+	return it->start_pos - removed_count_ + (ts_it - entry.timestamps.begin());
+}
+
+size_t CompressedSamples::block_index(size_t pos) const
+{
+	const auto it = std::upper_bound(blocks_.begin(), blocks_.end(),
+		removed_count_ + pos,
+		[](size_t p, const Block &block) { return p < block.start_pos; });
+	return (it - blocks_.begin()) - 1;
+}
+
+const CompressedSamples::CacheEntry &CompressedSamples::decompressed_block(
+	size_t index) const
+{
+	const Block &block = blocks_[index];
+	++cache_counter_;
+	for (auto &entry : cache_) {
+		if (entry.start_pos == block.start_pos) {
+			entry.last_used = cache_counter_;
+			return entry;
+		}
+	}
+
+	// Replace the least recently used block.
+	CacheEntry *entry;
+	if (cache_.size() < cache_size_) {
+		cache_.emplace_back();
+		entry = &cache_.back();
+	}
+	else {
+		entry = &*std::min_element(cache_.begin(), cache_.end(),
+			[](const CacheEntry &a, const CacheEntry &b) {
+				return a.last_used < b.last_used;
+			});
+	}
+
+	entry->start_pos = block.start_pos;
+	entry->last_used = cache_counter_;
+	entry->timestamps.clear();
+	entry->values.clear();
+	if (!block.timestamps.empty()) {
+		entry->timestamps.resize(block.count);
+		decompress_column(block.timestamps, block.count, true,
+			entry->timestamps.data());
+	}
+	if (!block.values.empty()) {
+		entry->values.resize(block.count);
+		decompress_column(block.values, block.count, false,
+			entry->values.data());
+	}
+	return *entry;
+}
+
+} // namespace data
+} // namespace sv
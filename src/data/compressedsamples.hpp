@@ -0,0 +1,131 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_COMPRESSEDSAMPLES_HPP
+#define DATA_COMPRESSEDSAMPLES_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using std::mutex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * Lossless compressed storage for blocks of samples that don't change
+ * anymore.
+ *
+ * Every block is compressed column wise. A column is stored as integers,
+ * when all values are decimal numbers with a few decimal places (as usual
+ * for DMM and PSU readings or millisecond timestamps). The integers are
+ * delta (values) or delta-of-delta (timestamps) encoded as variable length
+ * integers. Other timestamps are stored as delta-of-delta of their bit
+ * patterns, other values are XORed with the previous value and only the
+ * non-zero bytes are stored.
+ *
+ * The blocks are decompressed on access. The last used blocks are kept in a
+ * small cache, so sequential access only decompresses every block once.
+ *
+ * A store can also hold only timestamps or only values, the other column is
+ * passed as nullptr then and must not be accessed.
+ */
+class CompressedSamples
+{
+
+public:
+	CompressedSamples();
+
+	/** Compress and append a block of samples. */
+	void append_block(const double *timestamps, const double *values,
+		size_t count);
+
+	/**
+	 * Remove the first (oldest) block and return its decompressed samples.
+	 * The positions of the remaining samples are moved down.
+	 */
+	void take_first_block(vector<double> &timestamps, vector<double> &values);
+
+	size_t sample_count() const;
+	size_t block_count() const;
+	/** The size of the compressed data in bytes. */
+	size_t memory_size() const;
+	/** The number of samples in the first block. */
+	size_t first_block_sample_count() const;
+
+	double timestamp(size_t pos) const;
+	double value(size_t pos) const;
+	/**
+	 * Copy up to count samples, starting at pos.
+	 *
+	 * @return The number of copied samples.
+	 */
+	size_t copy(size_t pos, size_t count,
+		double *timestamps, double *values) const;
+	/**
+	 * Return the position of the first sample with a timestamp that is not
+	 * less than the given timestamp, or sample_count().
+	 */
+	size_t lower_bound_pos(double timestamp) const;
+
+private:
+	struct Block
+	{
+		/** The position, including already removed blocks. */
+		size_t start_pos;
+		size_t count;
+		double first_timestamp;
+		double last_timestamp;
+		vector<uint8_t> timestamps;
+		vector<uint8_t> values;
+	};
+
+	struct CacheEntry
+	{
+		/** The start position of the block, the index isn't stable. */
+		size_t start_pos;
+		uint64_t last_used;
+		vector<double> timestamps;
+		vector<double> values;
+	};
+
+	size_t block_index(size_t pos) const;
+	/** Return the decompressed block. The cache mutex must be locked. */
+	const CacheEntry &decompressed_block(size_t index) const;
+
+	vector<Block> blocks_;
+	/** The number of samples in already removed blocks. */
+	size_t removed_count_;
+	size_t sample_count_;
+	size_t memory_size_;
+
+	mutable mutex cache_mutex_;
+	mutable vector<CacheEntry> cache_;
+	mutable uint64_t cache_counter_;
+
+	static const size_t cache_size_ = 8;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_COMPRESSEDSAMPLES_HPP
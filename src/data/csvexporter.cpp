@@ -0,0 +1,420 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QString>
+
+#include "csvexporter.hpp"
+#include "src/util.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+CsvExporter::CsvExporter(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &file_name) :
+	BaseExporter(signals, file_name),
+	separator_(","),
+	relative_time_(true),
+	combine_timestamps_(false),
+	combined_timeframe_(0.),
+	time_date_secs_(-1),
+	timeframe_too_large_(false),
+	min_sample_delta_(std::numeric_limits<double>::max())
+{
+}
+
+CsvExporter::~CsvExporter()
+{
+	wait();
+}
+
+void CsvExporter::set_separator(const string &separator)
+{
+	separator_ = separator;
+}
+
+void CsvExporter::set_relative_time(bool relative_time)
+{
+	relative_time_ = relative_time;
+}
+
+void CsvExporter::set_combine_timestamps(bool combine_timestamps,
+	double combined_timeframe)
+{
+	combine_timestamps_ = combine_timestamps;
+	combined_timeframe_ = combined_timeframe;
+}
+
+bool CsvExporter::timeframe_too_large() const
+{
+	return timeframe_too_large_;
+}
+
+double CsvExporter::min_sample_delta() const
+{
+	return min_sample_delta_;
+}
+
+bool CsvExporter::export_file()
+{
+	timeframe_too_large_ = false;
+	min_sample_delta_ = std::numeric_limits<double>::max();
+
+	file_.open(file_name_, std::ios::out | std::ios::trunc | std::ios::binary);
+	if (!file_.is_open()) {
+		error_ = "Could not open file " + file_name_;
+		return false;
+	}
+	buffer_.clear();
+	buffer_.reserve(buffer_size_ + 4096);
+
+	bool success;
+	if (combine_timestamps_)
+		success = export_combined();
+	else
+		success = export_signals();
+
+	if (success && !flush(true))
+		success = false;
+	file_.close();
+
+	return success;
+}
+
+bool CsvExporter::export_signals()
+{
+	// Header
+	string start_sep;
+	string device_header_line;
+	string chg_name_header_line;
+	string ch_name_header_line;
+	string signal_name_header_line;
+	for (const auto &signal : signals_) {
+		auto parent_channel = signal->parent_channel();
+		const string device_name = parent_channel->parent_device()->name();
+		const string chg_names = channel_group_names(signal);
+
+		device_header_line += start_sep + device_name; // Time
+		device_header_line += separator_ + device_name; // Value
+		chg_name_header_line += start_sep + chg_names; // Time
+		chg_name_header_line += separator_ + chg_names; // Value
+		ch_name_header_line += start_sep + parent_channel->name(); // Time
+		ch_name_header_line += separator_ + parent_channel->name(); // Value
+		signal_name_header_line += start_sep + "Time " + signal->name(); // Time
+		signal_name_header_line += separator_ + signal->name(); // Value
+
+		start_sep = separator_;
+	}
+	append(device_header_line + "\n");
+	append(chg_name_header_line + "\n");
+	append(ch_name_header_line + "\n");
+	append(signal_name_header_line + "\n");
+
+	// Data. Only the samples that exist when the export starts are exported.
+	// The retained samples are exported with one sample per bucket, so the
+	// signals can advance by a different number of positions per block.
+	vector<size_t> sample_counts;
+	uint64_t total_sample_count = 0;
+	for (const auto &signal : signals_) {
+		sample_counts.push_back(signal->sample_count());
+		total_sample_count += sample_counts.back();
+	}
+
+	vector<size_t> positions(signals_.size(), 0);
+	vector<vector<double>> timestamps(signals_.size());
+	vector<vector<double>> values(signals_.size());
+	while (true) {
+		// Read the next block of every signal column wise...
+		size_t rows = 0;
+		uint64_t exported_sample_count = 0;
+		for (size_t i = 0; i < signals_.size(); ++i) {
+			signals_[i]->get_export_samples(positions[i], sample_counts[i],
+				block_size_, timestamps[i], values[i], relative_time_);
+			rows = std::max(rows, timestamps[i].size());
+			exported_sample_count += std::min(positions[i], sample_counts[i]);
+		}
+		if (rows == 0)
+			break;
+
+		// ... and write it row wise
+		for (size_t row = 0; row < rows; ++row) {
+			for (size_t i = 0; i < signals_.size(); ++i) {
+				if (i > 0)
+					buffer_.append(separator_);
+				if (row < timestamps[i].size()) {
+					append_time(timestamps[i][row]);
+					buffer_.append(separator_);
+					append_value(values[i][row]);
+				}
+				else {
+					buffer_.append(separator_);
+				}
+			}
+			buffer_.push_back('\n');
+			if (!flush(false))
+				return false;
+		}
+
+		if (!update_progress(exported_sample_count, total_sample_count))
+			return false;
+	}
+
+	return update_progress(total_sample_count, total_sample_count);
+}
+
+bool CsvExporter::export_combined()
+{
+	// Header
+	string device_header_line("Time"); // Time
+	string chg_name_header_line("Time"); // Time
+	string ch_name_header_line("Time"); // Time
+	string signal_name_header_line("Time"); // Time
+	for (const auto &signal : signals_) {
+		auto parent_channel = signal->parent_channel();
+		device_header_line += separator_ + parent_channel->parent_device()->name();
+		chg_name_header_line += separator_ + channel_group_names(signal);
+		ch_name_header_line += separator_ + parent_channel->name();
+		signal_name_header_line += separator_ + signal->name();
+	}
+	append(device_header_line + "\n");
+	append(chg_name_header_line + "\n");
+	append(ch_name_header_line + "\n");
+	append(signal_name_header_line + "\n");
+
+	// Data
+	vector<SampleCursor> cursors(signals_.size());
+	uint64_t total_sample_count = 0;
+	for (size_t i = 0; i < signals_.size(); ++i) {
+		init_cursor(cursors[i], signals_[i]);
+		total_sample_count += cursors[i].end;
+	}
+
+	// k-way merge of the signals: The heap holds the timestamp of the actual
+	// sample of every signal, that has samples left, so the next timestamp
+	// is always on top of the heap.
+	typedef pair<double, size_t> heap_entry_t;
+	std::priority_queue<heap_entry_t, vector<heap_entry_t>,
+		std::greater<heap_entry_t>> heap;
+	for (size_t i = 0; i < cursors.size(); ++i) {
+		if (!cursors[i].timestamps.empty())
+			heap.push({ cursors[i].timestamps[0], i });
+	}
+
+	// The positions of the signals that have a value in the actual row
+	vector<size_t> row_signals;
+	vector<bool> is_in_row(cursors.size(), false);
+	uint64_t row_count = 0;
+	while (!heap.empty()) {
+		const double next_timestamp = heap.top().first;
+		while (!heap.empty() &&
+				heap.top().first <= next_timestamp + combined_timeframe_) {
+			row_signals.push_back(heap.top().second);
+			is_in_row[heap.top().second] = true;
+			heap.pop();
+		}
+
+		append_time(next_timestamp);
+		for (size_t i = 0; i < cursors.size(); ++i) {
+			buffer_.append(separator_);
+			if (is_in_row[i]) {
+				const SampleCursor &cursor = cursors[i];
+				append_value(cursor.values[cursor.index]);
+			}
+		}
+		buffer_.push_back('\n');
+		if (!flush(false))
+			return false;
+
+		// Move the cursors of the written values to their next sample. The
+		// smallest time between two samples is checked in the same pass.
+		for (const auto &i : row_signals) {
+			is_in_row[i] = false;
+			SampleCursor &cursor = cursors[i];
+			const double timestamp = cursor.timestamps[cursor.index];
+			next_sample(cursor);
+			if (cursor.index >= cursor.timestamps.size())
+				continue;
+
+			const double next_sample_timestamp =
+				cursor.timestamps[cursor.index];
+			const double delta = next_sample_timestamp - timestamp;
+			if (delta < min_sample_delta_)
+				min_sample_delta_ = delta;
+			if (combined_timeframe_ > 0 && delta < combined_timeframe_) {
+				timeframe_too_large_ = true;
+				error_ = "The combination time frame is too large.";
+				scan_min_sample_delta(cursors);
+				return false;
+			}
+			heap.push({ next_sample_timestamp, i });
+		}
+		row_signals.clear();
+
+		// The progress is counted in positions of the read blocks.
+		if ((++row_count & 0xFFF) == 0) {
+			uint64_t exported_sample_count = 0;
+			for (const auto &cursor : cursors)
+				exported_sample_count += std::min(cursor.next_pos, cursor.end);
+			if (!update_progress(exported_sample_count, total_sample_count))
+				return false;
+		}
+	}
+
+	return update_progress(total_sample_count, total_sample_count);
+}
+
+string CsvExporter::channel_group_names(
+	shared_ptr<AnalogTimeSignal> signal) const
+{
+	string chg_names;
+	string chg_sep;
+	for (const auto &chg_name : signal->parent_channel()->channel_group_names()) {
+		chg_names += chg_sep;
+		if (chg_name.empty())
+			chg_names += "\"\"";
+		else
+			chg_names += chg_name;
+		// TODO: Ugly workaround. Implement escaping or quotation characters?
+		chg_sep = separator_ == "," ? "; " : ", ";
+	}
+	return chg_names;
+}
+
+void CsvExporter::init_cursor(SampleCursor &cursor,
+	shared_ptr<AnalogTimeSignal> signal)
+{
+	cursor.signal = signal;
+	cursor.end = signal->sample_count();
+	cursor.next_pos = 0;
+	cursor.index = 0;
+	signal->get_export_samples(cursor.next_pos, cursor.end, block_size_,
+		cursor.timestamps, cursor.values, relative_time_);
+}
+
+void CsvExporter::next_sample(SampleCursor &cursor)
+{
+	++cursor.index;
+	if (cursor.index < cursor.timestamps.size() ||
+			cursor.next_pos >= cursor.end)
+		return;
+
+	cursor.index = 0;
+	cursor.signal->get_export_samples(cursor.next_pos, cursor.end,
+		block_size_, cursor.timestamps, cursor.values, relative_time_);
+}
+
+void CsvExporter::scan_min_sample_delta(vector<SampleCursor> &cursors)
+{
+	// The deltas up to the actual position of a cursor are already checked.
+	for (auto &cursor : cursors) {
+		if (cursor.index >= cursor.timestamps.size())
+			continue;
+
+		double timestamp = cursor.timestamps[cursor.index];
+		next_sample(cursor);
+		while (cursor.index < cursor.timestamps.size()) {
+			if (cancel_requested_)
+				return;
+			const double next_sample_timestamp =
+				cursor.timestamps[cursor.index];
+			const double delta = next_sample_timestamp - timestamp;
+			if (delta < min_sample_delta_)
+				min_sample_delta_ = delta;
+			timestamp = next_sample_timestamp;
+			next_sample(cursor);
+		}
+	}
+}
+
+void CsvExporter::append(const string &str)
+{
+	buffer_.append(str);
+}
+
+void CsvExporter::append_time(double timestamp)
+{
+	char str[64];
+	size_t length;
+	if (relative_time_) {
+		length = util::format_double(timestamp, 4, str, sizeof(str));
+		buffer_.append(str, length);
+		return;
+	}
+
+	// Same format as util::format_time_date(), but the date and time part
+	// is only formatted when the second changes.
+	const int64_t msecs = (int64_t)(timestamp * 1000);
+	int64_t secs = msecs / 1000;
+	int64_t msec = msecs % 1000;
+	if (msec < 0) {
+		--secs;
+		msec += 1000;
+	}
+	if (secs != time_date_secs_) {
+		time_date_secs_ = secs;
+		time_date_str_ = QDateTime::fromMSecsSinceEpoch(secs * 1000).
+			toString("yyyy.MM.dd hh:mm:ss").toStdString();
+	}
+	buffer_.append(time_date_str_);
+	length = std::snprintf(str, sizeof(str), ".%03d", (int)msec);
+	buffer_.append(str, length);
+}
+
+void CsvExporter::append_value(double value)
+{
+	char str[64];
+	size_t length = util::format_double(value, str, sizeof(str));
+	buffer_.append(str, length);
+}
+
+bool CsvExporter::flush(bool force)
+{
+	if (!force && buffer_.size() < buffer_size_)
+		return true;
+
+	file_.write(buffer_.data(), buffer_.size());
+	buffer_.clear();
+	if (force)
+		file_.flush();
+	return file_.good();
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,140 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CSVEXPORTER_HPP
+#define DATA_CSVEXPORTER_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/data/baseexporter.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Export analog time signals into a CSV file.
+ *
+ * The export runs in its own thread. The samples are read block wise from
+ * the signals, formatted without locale lookups and allocations and written
+ * in large chunks to the file.
+ */
+class CsvExporter : public BaseExporter
+{
+	Q_OBJECT
+
+public:
+	CsvExporter(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &file_name);
+	~CsvExporter();
+
+	void set_separator(const string &separator);
+	void set_relative_time(bool relative_time);
+	/**
+	 * Combine the timestamps of all signals into one time column. Samples
+	 * of other signals that are within the combined_timeframe (in s) after
+	 * the timestamp of a row are written into the same row.
+	 *
+	 * The combined_timeframe must be smaller than the smallest time between
+	 * two samples of a signal, otherwise the export fails and
+	 * timeframe_too_large() returns true.
+	 */
+	void set_combine_timestamps(bool combine_timestamps,
+		double combined_timeframe);
+
+	/** True if the export failed, because the combined timeframe is too large. */
+	bool timeframe_too_large() const;
+	/**
+	 * The smallest time between two samples of a signal, found in a combined
+	 * export. When the export fails because the combined timeframe is too
+	 * large, all remaining samples are checked, too.
+	 */
+	double min_sample_delta() const;
+
+protected:
+	bool export_file() override;
+
+private:
+	/**
+	 * A cursor that reads the samples of a signal block wise. The cursor is
+	 * at the end, when index is not within the block.
+	 */
+	struct SampleCursor {
+		shared_ptr<AnalogTimeSignal> signal;
+		/** The position after the last sample to export. */
+		size_t end;
+		/** The position of the next block. */
+		size_t next_pos;
+		/** The index of the actual sample in the block. */
+		size_t index;
+		vector<double> timestamps;
+		vector<double> values;
+	};
+
+	bool export_signals();
+	bool export_combined();
+	string channel_group_names(shared_ptr<AnalogTimeSignal> signal) const;
+
+	void init_cursor(SampleCursor &cursor, shared_ptr<AnalogTimeSignal> signal);
+	void next_sample(SampleCursor &cursor);
+	/**
+	 * Check the remaining samples of all cursors for the smallest time
+	 * between two samples, after the combined export has been aborted.
+	 */
+	void scan_min_sample_delta(vector<SampleCursor> &cursors);
+
+	void append(const string &str);
+	void append_time(double timestamp);
+	void append_value(double value);
+	bool flush(bool force);
+
+	string separator_;
+	bool relative_time_;
+	bool combine_timestamps_;
+	double combined_timeframe_;
+
+	std::ofstream file_;
+	string buffer_;
+	/** The date and time part of the last formatted absolute timestamp. */
+	int64_t time_date_secs_;
+	string time_date_str_;
+
+	bool timeframe_too_large_;
+	double min_sample_delta_;
+
+	/** Number of samples that are read at once from a signal. */
+	static constexpr size_t block_size_ = 8192;
+	/** Size of the write buffer. */
+	static const size_t buffer_size_ = 1 << 20;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CSVEXPORTER_HPP
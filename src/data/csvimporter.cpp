@@ -0,0 +1,326 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QDate>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QString>
+#include <QTime>
+
+#include "csvimporter.hpp"
+#include "src/util.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::make_pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/** The number of samples that are pushed to a signal at once. */
+const size_t push_block_size = 1 << 20;
+
+inline bool is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+bool parse_uint(const char *begin, const char *end, int &value)
+{
+	if (begin == end)
+		return false;
+	value = 0;
+	for (; begin != end; ++begin) {
+		if (!is_digit(*begin))
+			return false;
+		value = value * 10 + (*begin - '0');
+	}
+	return true;
+}
+
+} // namespace
+
+CsvImporter::CsvImporter(const string &file_name) :
+	file_name_(file_name),
+	separator_(','),
+	skip_rows_(0),
+	time_column_(0),
+	time_format_(CsvTimeFormat::Relative),
+	start_timestamp_(0.),
+	date_hour_timestamp_(0.),
+	row_count_(0),
+	skipped_rows_(0)
+{
+}
+
+void CsvImporter::set_separator(char separator)
+{
+	separator_ = separator;
+}
+
+void CsvImporter::set_skip_rows(size_t skip_rows)
+{
+	skip_rows_ = skip_rows;
+}
+
+void CsvImporter::set_time_column(size_t time_column)
+{
+	time_column_ = time_column;
+}
+
+void CsvImporter::set_time_format(CsvTimeFormat time_format)
+{
+	time_format_ = time_format;
+}
+
+void CsvImporter::set_start_timestamp(double start_timestamp)
+{
+	start_timestamp_ = start_timestamp;
+}
+
+void CsvImporter::add_column(size_t column,
+	shared_ptr<AnalogTimeSignal> signal, int digits, int decimal_places)
+{
+	ColumnMapping mapping;
+	mapping.column = column;
+	mapping.signal = signal;
+	mapping.digits = digits;
+	mapping.decimal_places = decimal_places;
+	mapping.last_timestamp = std::numeric_limits<double>::lowest();
+	mappings_.push_back(std::move(mapping));
+}
+
+bool CsvImporter::run()
+{
+	row_count_ = 0;
+	skipped_rows_ = 0;
+	error_.clear();
+	date_hour_str_.clear();
+
+	if (mappings_.empty()) {
+		error_ = "No columns to import";
+		return false;
+	}
+
+	// The imported samples are appended to the signals.
+	for (auto &mapping : mappings_) {
+		mapping.last_timestamp = mapping.signal->sample_count() > 0 ?
+			mapping.signal->last_timestamp(false) :
+			std::numeric_limits<double>::lowest();
+	}
+
+	QFile file(QString::fromStdString(file_name_));
+	if (!file.open(QIODevice::ReadOnly)) {
+		error_ = "Could not open file " + file_name_;
+		return false;
+	}
+	if (file.size() == 0)
+		return true;
+	const char *data = reinterpret_cast<const char *>(
+		file.map(0, file.size()));
+	if (!data) {
+		error_ = "Could not map file " + file_name_;
+		return false;
+	}
+
+	const char *pos = data;
+	const char *const end = data + file.size();
+	size_t line = 0;
+	while (pos < end) {
+		const char *line_end = static_cast<const char *>(
+			std::memchr(pos, '\n', end - pos));
+		if (!line_end)
+			line_end = end;
+		if (line >= skip_rows_)
+			parse_row(pos, line_end);
+		++line;
+		pos = line_end + 1;
+	}
+
+	for (auto &mapping : mappings_)
+		flush(mapping);
+
+	return true;
+}
+
+size_t CsvImporter::row_count() const
+{
+	return row_count_;
+}
+
+size_t CsvImporter::skipped_rows() const
+{
+	return skipped_rows_;
+}
+
+string CsvImporter::error() const
+{
+	return error_;
+}
+
+void CsvImporter::parse_row(const char *begin, const char *end)
+{
+	// Split the row into fields. Quotes around a field are removed, but
+	// separators in quoted fields are not supported.
+	fields_.clear();
+	const char *field_begin = begin;
+	for (const char *pos = begin; ; ++pos) {
+		if (pos == end || *pos == separator_) {
+			const char *field_end = pos;
+			while (field_begin < field_end && is_space(*field_begin))
+				++field_begin;
+			while (field_end > field_begin && is_space(*(field_end - 1)))
+				--field_end;
+			if (field_end - field_begin >= 2 && *field_begin == '"' &&
+					*(field_end - 1) == '"') {
+				++field_begin;
+				--field_end;
+			}
+			fields_.push_back(make_pair(field_begin, field_end));
+			if (pos == end)
+				break;
+			field_begin = pos + 1;
+		}
+	}
+
+	// Empty lines
+	if (fields_.size() == 1 && fields_[0].first == fields_[0].second)
+		return;
+
+	double timestamp;
+	if (time_column_ >= fields_.size() || !parse_timestamp(
+			fields_[time_column_].first, fields_[time_column_].second,
+			timestamp) || std::isnan(timestamp)) {
+		++skipped_rows_;
+		return;
+	}
+
+	double value;
+	bool out_of_order = false;
+	for (auto &mapping : mappings_) {
+		if (mapping.column >= fields_.size())
+			continue;
+		const auto &field = fields_[mapping.column];
+		if (field.first == field.second ||
+				!util::parse_double(field.first, field.second, value))
+			continue;
+		if (timestamp < mapping.last_timestamp) {
+			out_of_order = true;
+			continue;
+		}
+
+		mapping.timestamps.push_back(timestamp);
+		mapping.values.push_back(value);
+		mapping.last_timestamp = timestamp;
+		if (mapping.timestamps.size() >= push_block_size)
+			flush(mapping);
+	}
+	if (out_of_order)
+		++skipped_rows_;
+	else
+		++row_count_;
+}
+
+bool CsvImporter::parse_timestamp(const char *begin, const char *end,
+	double &timestamp)
+{
+	if (time_format_ == CsvTimeFormat::Relative) {
+		if (!util::parse_double(begin, end, timestamp))
+			return false;
+		timestamp += start_timestamp_;
+		return true;
+	}
+	if (time_format_ == CsvTimeFormat::Absolute)
+		return util::parse_double(begin, end, timestamp);
+
+	// "yyyy.MM.dd hh:mm:ss[.zzz]"
+	if (end - begin < 19 || begin[13] != ':' || begin[16] != ':')
+		return false;
+
+	// Only convert the date and hour with QDateTime when it changes. The
+	// hour is included, to handle daylight saving time changes.
+	if (date_hour_str_.size() != 13 ||
+			date_hour_str_.compare(0, 13, begin, 13) != 0) {
+		int year, month, day, hour;
+		if (!parse_uint(begin, begin + 4, year) ||
+				!parse_uint(begin + 5, begin + 7, month) ||
+				!parse_uint(begin + 8, begin + 10, day) ||
+				!parse_uint(begin + 11, begin + 13, hour))
+			return false;
+		QDateTime date_time(QDate(year, month, day), QTime(hour, 0));
+		if (!date_time.isValid())
+			return false;
+		date_hour_str_.assign(begin, 13);
+		date_hour_timestamp_ = date_time.toMSecsSinceEpoch() / (double)1000;
+	}
+
+	int minutes, seconds;
+	if (!parse_uint(begin + 14, begin + 16, minutes) ||
+			!parse_uint(begin + 17, begin + 19, seconds))
+		return false;
+	double fraction = 0.;
+	const char *pos = begin + 19;
+	if (pos != end) {
+		if (*pos != '.' && *pos != ',')
+			return false;
+		double scale = 0.1;
+		for (++pos; pos != end; ++pos) {
+			if (!is_digit(*pos))
+				return false;
+			fraction += (*pos - '0') * scale;
+			scale /= 10;
+		}
+	}
+
+	timestamp = date_hour_timestamp_ + minutes * 60 + seconds + fraction;
+	return true;
+}
+
+void CsvImporter::flush(ColumnMapping &mapping)
+{
+	if (mapping.timestamps.empty())
+		return;
+
+	mapping.signal->push_samples(
+		mapping.timestamps.data(), mapping.values.data(),
+		mapping.timestamps.size(), mapping.digits, mapping.decimal_places);
+	mapping.timestamps.clear();
+	mapping.values.clear();
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,126 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CSVIMPORTER_HPP
+#define DATA_CSVIMPORTER_HPP
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+enum class CsvTimeFormat {
+	/** Seconds relative to the start timestamp of the import. */
+	Relative,
+	/** Seconds since the epoch. */
+	Absolute,
+	/**
+	 * Local date and time like "yyyy.MM.dd hh:mm:ss.zzz", as written by the
+	 * CSV export. '-' as date separator and 'T' between date and time are
+	 * accepted too.
+	 */
+	DateTime,
+};
+
+/**
+ * Import samples from a CSV file into analog time signals.
+ *
+ * The file is memory mapped and parsed in place, the numbers are parsed
+ * without allocations. Every value column is mapped to a signal, all value
+ * columns share one time column. Empty cells are skipped, so files written
+ * with combined timestamps can be imported too.
+ */
+class CsvImporter
+{
+
+public:
+	explicit CsvImporter(const string &file_name);
+
+	void set_separator(char separator);
+	/** Skip the given number of rows (e.g. the header) at the beginning. */
+	void set_skip_rows(size_t skip_rows);
+	void set_time_column(size_t time_column);
+	void set_time_format(CsvTimeFormat time_format);
+	/** The timestamp the relative times are added to. */
+	void set_start_timestamp(double start_timestamp);
+	/** Import the values of the column into the given signal. */
+	void add_column(size_t column, shared_ptr<AnalogTimeSignal> signal,
+		int digits, int decimal_places);
+
+	/** Import the file. */
+	bool run();
+
+	size_t row_count() const;
+	/**
+	 * The number of rows without a valid timestamp or with a timestamp
+	 * before the last timestamp of a signal. Values that are not in time
+	 * order are not imported.
+	 */
+	size_t skipped_rows() const;
+	string error() const;
+
+private:
+	struct ColumnMapping
+	{
+		size_t column;
+		shared_ptr<AnalogTimeSignal> signal;
+		int digits;
+		int decimal_places;
+		/** The last timestamp of the signal, the timestamps must ascend. */
+		double last_timestamp;
+		vector<double> timestamps;
+		vector<double> values;
+	};
+
+	void parse_row(const char *begin, const char *end);
+	bool parse_timestamp(const char *begin, const char *end, double &timestamp);
+	void flush(ColumnMapping &mapping);
+
+	const string file_name_;
+	char separator_;
+	size_t skip_rows_;
+	size_t time_column_;
+	CsvTimeFormat time_format_;
+	double start_timestamp_;
+	vector<ColumnMapping> mappings_;
+	/** The fields of the current row, reused for all rows. */
+	vector<pair<const char *, const char *>> fields_;
+	/** Cache for DateTime timestamps: "yyyy.MM.dd hh" and its timestamp. */
+	string date_hour_str_;
+	double date_hour_timestamp_;
+	size_t row_count_;
+	size_t skipped_rows_;
+	string error_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CSVIMPORTER_HPP
@@ -133,6 +133,25 @@ Unit get_unit(const sigrok::Unit *sr_unit)
 	return Unit::Unknown;
 }
 
+Unit get_unit(uint32_t sr_unit)
+{
+	// sigrok::Unit::get() throws for unknown IDs (e.g. from files).
+	try {
+		const sigrok::Unit *sr_u = sigrok::Unit::get(sr_unit);
+		return get_unit(sr_u);
+	}
+	catch (sigrok::Error &) {
+		return Unit::Unknown;
+	}
+}
+
+uint32_t get_sr_unit_id(Unit unit)
+{
+	if (unit_sr_unit_map.count(unit) > 0)
+		return unit_sr_unit_map[unit]->id();
+	return 0;
+}
+
 
 DataType get_data_type(const sigrok::DataType *sr_data_type)
 {
@@ -776,6 +776,24 @@ uint64_t get_sr_quantity_flags_id(const set<QuantityFlag> &quantity_flags);
  */
 Unit get_unit(const sigrok::Unit *sr_unit);
 
+/**
+ * Return the corresponding Unit for a sigrok Unit (unit32_t)
+ *
+ * @param sr_unit The sigrok Unit as uint32_t
+ *
+ * @return The Unit.
+ */
+Unit get_unit(uint32_t sr_unit);
+
+/**
+ * Return the corresponding sigrok Unit ID (unit32_t) for a Unit
+ *
+ * @param unit The Unit
+ *
+ * @return The sigrok Unit ID.
+ */
+uint32_t get_sr_unit_id(Unit unit);
+
 
 /**
  * Return the corresponding DataType for a sigrok DataType
@@ -0,0 +1,213 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "histogram.hpp"
+
+namespace sv {
+namespace data {
+
+Histogram::Histogram(size_t bin_count, size_t window_size) :
+	window_size_(window_size),
+	resolution_(0.)
+{
+	// Merging adjacent bins needs an even number of bins.
+	if (bin_count < 2)
+		bin_count = 2;
+	if (bin_count % 2 != 0)
+		++bin_count;
+	bins_.resize(bin_count, 0);
+
+	clear();
+}
+
+void Histogram::clear()
+{
+	std::fill(bins_.begin(), bins_.end(), 0);
+	window_.clear();
+	lower_bound_ = 0.;
+	bin_width_ = 0.;
+	is_initialized_ = false;
+	value_count_ = 0;
+	invalid_count_ = 0;
+}
+
+void Histogram::add_value(double value)
+{
+	if (!std::isfinite(value)) {
+		++invalid_count_;
+		return;
+	}
+
+	if (!is_initialized_)
+		init_range(value);
+
+	// Rebin until the value fits. If the range can't be expanded anymore,
+	// the value is counted in the first/last bin.
+	while (value < lower_bound_ && can_expand())
+		expand_lower();
+	while (value >= upper_bound() && can_expand())
+		expand_upper();
+
+	++bins_[bin_index(value)];
+	++value_count_;
+
+	if (window_size_ > 0) {
+		window_.push_back(value);
+		if (window_.size() > window_size_) {
+			// The range never shrinks, so the old value is still in range.
+			--bins_[bin_index(window_.front())];
+			--value_count_;
+			window_.pop_front();
+		}
+	}
+}
+
+void Histogram::set_resolution(double resolution)
+{
+	resolution_ = std::fabs(resolution);
+}
+
+void Histogram::set_window_size(size_t window_size)
+{
+	window_size_ = window_size;
+	clear();
+}
+
+size_t Histogram::window_size() const
+{
+	return window_size_;
+}
+
+size_t Histogram::bin_count() const
+{
+	return bins_.size();
+}
+
+double Histogram::bin_width() const
+{
+	return bin_width_;
+}
+
+double Histogram::lower_bound() const
+{
+	return lower_bound_;
+}
+
+double Histogram::upper_bound() const
+{
+	return lower_bound_ + bin_width_ * (double)bins_.size();
+}
+
+double Histogram::bin_lower_bound(size_t bin) const
+{
+	return lower_bound_ + bin_width_ * (double)bin;
+}
+
+uint64_t Histogram::bin_value(size_t bin) const
+{
+	return bins_.at(bin);
+}
+
+uint64_t Histogram::max_bin_value() const
+{
+	return *std::max_element(bins_.begin(), bins_.end());
+}
+
+uint64_t Histogram::value_count() const
+{
+	return value_count_;
+}
+
+uint64_t Histogram::invalid_count() const
+{
+	return invalid_count_;
+}
+
+void Histogram::init_range(double value)
+{
+	bin_width_ = resolution_;
+	if (bin_width_ <= 0.)
+		bin_width_ = std::fabs(value) * 1e-6;
+	if (bin_width_ < std::numeric_limits<double>::min())
+		bin_width_ = 1e-12;
+
+	// Center the range around the first value and align it to the bin width,
+	// so that quantized values are always in the middle of a bin.
+	const double half_bin_count = (double)(bins_.size() / 2);
+	lower_bound_ = (std::floor(value / bin_width_ + 0.5) - half_bin_count - 0.5) *
+		bin_width_;
+	is_initialized_ = true;
+}
+
+bool Histogram::can_expand() const
+{
+	const double new_range = 2 * bin_width_ * (double)bins_.size();
+	return std::isfinite(lower_bound_ - new_range) &&
+		std::isfinite(lower_bound_ + new_range);
+}
+
+void Histogram::expand_lower()
+{
+	// The new range is [lower - range, upper) with the doubled bin width.
+	// Old bin i is merged into the new bin (n + i) / 2.
+	const size_t n = bins_.size();
+	for (size_t i = n; i-- > 0; ) {
+		const size_t new_i = (n + i) / 2;
+		if (new_i != i) {
+			bins_[new_i] += bins_[i];
+			bins_[i] = 0;
+		}
+	}
+	lower_bound_ -= bin_width_ * (double)n;
+	bin_width_ *= 2;
+}
+
+void Histogram::expand_upper()
+{
+	// The new range is [lower, upper + range) with the doubled bin width.
+	// Old bin i is merged into the new bin i / 2.
+	const size_t n = bins_.size();
+	for (size_t i = 0; i < n; ++i) {
+		const size_t new_i = i / 2;
+		if (new_i != i) {
+			bins_[new_i] += bins_[i];
+			bins_[i] = 0;
+		}
+	}
+	bin_width_ *= 2;
+}
+
+size_t Histogram::bin_index(double value) const
+{
+	double pos = (value - lower_bound_) / bin_width_;
+	if (pos < 0.)
+		return 0;
+	size_t index = (size_t)pos;
+	if (index >= bins_.size())
+		index = bins_.size() - 1;
+	return index;
+}
+
+} // namespace data
+} // namespace sv
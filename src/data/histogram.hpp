@@ -0,0 +1,112 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_HISTOGRAM_HPP
+#define DATA_HISTOGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+using std::deque;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * A histogram with a fixed number of equally sized bins, that is updated
+ * incrementally with every new value.
+ *
+ * The range of the histogram is adjusted automatically: When a value is
+ * outside of the actual range, the bin width is doubled by merging adjacent
+ * bins, until the value fits. The already counted values don't have to be
+ * re-read for this.
+ *
+ * When a window size is set, only the last window_size values are counted.
+ */
+class Histogram
+{
+
+public:
+	/**
+	 * @param bin_count The number of bins. Must be an even number.
+	 * @param window_size Only count the last window_size values. 0 counts
+	 *                    all values.
+	 */
+	explicit Histogram(size_t bin_count = 100, size_t window_size = 0);
+
+	/**
+	 * Remove all values and reset the range of the histogram.
+	 */
+	void clear();
+
+	/**
+	 * Add a single value to the histogram. Infinite values and NaNs are
+	 * not counted in the bins.
+	 */
+	void add_value(double value);
+
+	/**
+	 * Set the smallest bin width, that is used when the range of the
+	 * histogram is initialized with the first value. This should be the
+	 * resolution of the values, so that quantization steps are visible.
+	 */
+	void set_resolution(double resolution);
+	void set_window_size(size_t window_size);
+	size_t window_size() const;
+
+	size_t bin_count() const;
+	double bin_width() const;
+	double lower_bound() const;
+	double upper_bound() const;
+	/** Return the lower boundary of the given bin. */
+	double bin_lower_bound(size_t bin) const;
+	uint64_t bin_value(size_t bin) const;
+	/** Return the highest count of all bins. */
+	uint64_t max_bin_value() const;
+	/** Return the number of values, that are counted in the bins. */
+	uint64_t value_count() const;
+	/** Return the number of values, that were not counted (inf, NaN). */
+	uint64_t invalid_count() const;
+
+private:
+	void init_range(double value);
+	bool can_expand() const;
+	void expand_lower();
+	void expand_upper();
+	size_t bin_index(double value) const;
+
+	vector<uint64_t> bins_;
+	size_t window_size_;
+	deque<double> window_;
+	double resolution_;
+	double lower_bound_;
+	double bin_width_;
+	bool is_initialized_;
+	uint64_t value_count_;
+	uint64_t invalid_count_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_HISTOGRAM_HPP
@@ -0,0 +1,202 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+#include <QFile>
+#include <QString>
+
+#include "mappedsessionfile.hpp"
+#include "src/data/sessionfile.hpp"
+
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+MappedSamples::MappedSamples(shared_ptr<QFile> file, const uchar *map,
+		const vector<SessionChunkInfo> &chunks) :
+	file_(file),
+	sample_count_(0),
+	min_value_(std::numeric_limits<double>::max()),
+	max_value_(std::numeric_limits<double>::lowest())
+{
+	chunk_positions_.reserve(chunks.size());
+	chunk_timestamps_.reserve(chunks.size());
+	chunk_values_.reserve(chunks.size());
+	for (const auto &chunk : chunks) {
+		if (chunk.sample_count == 0)
+			continue;
+
+		// The chunk data is 8 byte aligned in the file.
+		const double *timestamps =
+			reinterpret_cast<const double *>(map + chunk.data_offset);
+		chunk_positions_.push_back(sample_count_);
+		chunk_timestamps_.push_back(timestamps);
+		chunk_values_.push_back(timestamps + chunk.sample_count);
+		sample_count_ += chunk.sample_count;
+		min_value_ = std::min(min_value_, chunk.min_value);
+		max_value_ = std::max(max_value_, chunk.max_value);
+	}
+}
+
+size_t MappedSamples::sample_count() const
+{
+	return sample_count_;
+}
+
+double MappedSamples::timestamp(size_t pos) const
+{
+	const size_t index = chunk_index(pos);
+	return chunk_timestamps_[index][pos - chunk_positions_[index]];
+}
+
+double MappedSamples::value(size_t pos) const
+{
+	const size_t index = chunk_index(pos);
+	return chunk_values_[index][pos - chunk_positions_[index]];
+}
+
+size_t MappedSamples::copy(size_t pos, size_t count,
+	double *timestamps, double *values) const
+{
+	if (pos >= sample_count_)
+		return 0;
+	if (count > sample_count_ - pos)
+		count = sample_count_ - pos;
+
+	size_t copied = 0;
+	size_t index = chunk_index(pos);
+	while (copied < count) {
+		const size_t chunk_end = index + 1 < chunk_positions_.size() ?
+			chunk_positions_[index + 1] : sample_count_;
+		const size_t chunk_pos = pos - chunk_positions_[index];
+		const size_t n = std::min(count - copied, chunk_end - pos);
+		if (timestamps) {
+			std::memcpy(timestamps + copied,
+				chunk_timestamps_[index] + chunk_pos, n * sizeof(double));
+		}
+		if (values) {
+			std::memcpy(values + copied,
+				chunk_values_[index] + chunk_pos, n * sizeof(double));
+		}
+		copied += n;
+		pos += n;
+		++index;
+	}
+	return copied;
+}
+
+double MappedSamples::min_value() const
+{
+	return min_value_;
+}
+
+double MappedSamples::max_value() const
+{
+	return max_value_;
+}
+
+size_t MappedSamples::chunk_index(size_t pos) const
+{
+	auto it = std::upper_bound(
+		chunk_positions_.begin(), chunk_positions_.end(), pos);
+	return (it - chunk_positions_.begin()) - 1;
+}
+
+
+MappedSessionFile::MappedSessionFile() :
+	map_(nullptr)
+{
+}
+
+bool MappedSessionFile::open(const string &file_name)
+{
+	// Only the index (or the record headers of a file without index) is
+	// read here, the samples are accessed via the mapping.
+	SessionFileReader reader;
+	if (!reader.open(file_name))
+		return false;
+	signals_ = reader.signals();
+	vector<vector<SessionChunkInfo>> signal_chunks;
+	for (uint32_t id = 0; id < signals_.size(); ++id)
+		signal_chunks.push_back(reader.chunks(id));
+	reader.close();
+
+	file_ = make_shared<QFile>(QString::fromStdString(file_name));
+	if (!file_->open(QIODevice::ReadOnly)) {
+		qWarning() << "MappedSessionFile::open(): Could not open file" <<
+			QString::fromStdString(file_name);
+		return false;
+	}
+	const uint64_t map_size = (uint64_t)file_->size();
+	map_ = file_->map(0, (qint64)map_size);
+	if (!map_) {
+		qWarning() << "MappedSessionFile::open(): Could not map file" <<
+			QString::fromStdString(file_name) << ":" << file_->errorString();
+		file_->close();
+		return false;
+	}
+
+	// The file could have been changed after it was read, only use chunks
+	// that are within the mapping.
+	signal_chunks_.clear();
+	for (const auto &chunks : signal_chunks) {
+		signal_chunks_.emplace_back();
+		for (const auto &chunk : chunks) {
+			if (chunk.data_offset <= map_size &&
+					2 * sizeof(double) * chunk.sample_count <=
+						map_size - chunk.data_offset)
+				signal_chunks_.back().push_back(chunk);
+		}
+	}
+
+	file_name_ = file_name;
+	return true;
+}
+
+string MappedSessionFile::file_name() const
+{
+	return file_name_;
+}
+
+const vector<SessionSignalInfo> &MappedSessionFile::signals() const
+{
+	return signals_;
+}
+
+shared_ptr<MappedSamples> MappedSessionFile::samples(uint32_t signal_id) const
+{
+	if (!map_ || signal_id >= signal_chunks_.size())
+		return nullptr;
+	return make_shared<MappedSamples>(
+		file_, map_, signal_chunks_[signal_id]);
+}
+
+} // namespace data
+} // namespace sv
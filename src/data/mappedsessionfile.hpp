@@ -0,0 +1,107 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_MAPPEDSESSIONFILE_HPP
+#define DATA_MAPPEDSESSIONFILE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QFile>
+
+#include "src/data/sessionfile.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * The samples of one signal in a memory mapped session file. The samples
+ * are read directly from the mapped chunks, so the pages are only loaded by
+ * the OS when they are accessed.
+ */
+class MappedSamples
+{
+
+public:
+	MappedSamples(shared_ptr<QFile> file, const uchar *map,
+		const vector<SessionChunkInfo> &chunks);
+
+	size_t sample_count() const;
+	double timestamp(size_t pos) const;
+	double value(size_t pos) const;
+	/**
+	 * Copy up to count samples, starting at pos. timestamps or values can be
+	 * nullptr, if they are not needed.
+	 *
+	 * @return The number of copied samples.
+	 */
+	size_t copy(size_t pos, size_t count,
+		double *timestamps, double *values) const;
+	double min_value() const;
+	double max_value() const;
+
+private:
+	size_t chunk_index(size_t pos) const;
+
+	/** Keep the file open, the mapping is valid as long as the file is. */
+	shared_ptr<QFile> file_;
+	/** The position of the first sample of every chunk. */
+	vector<size_t> chunk_positions_;
+	vector<const double *> chunk_timestamps_;
+	vector<const double *> chunk_values_;
+	size_t sample_count_;
+	double min_value_;
+	double max_value_;
+
+};
+
+/**
+ * Open a session file read only and memory map it. Only the index of the
+ * file is read when it is opened.
+ */
+class MappedSessionFile
+{
+
+public:
+	MappedSessionFile();
+
+	bool open(const string &file_name);
+	string file_name() const;
+	const vector<SessionSignalInfo> &signals() const;
+	shared_ptr<MappedSamples> samples(uint32_t signal_id) const;
+
+private:
+	string file_name_;
+	shared_ptr<QFile> file_;
+	const uchar *map_;
+	vector<SessionSignalInfo> signals_;
+	vector<vector<SessionChunkInfo>> signal_chunks_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_MAPPEDSESSIONFILE_HPP
@@ -0,0 +1,212 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+#include "powerstatistics.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::shared_ptr;
+
+namespace sv {
+namespace data {
+
+PowerStatistics::PowerStatistics() :
+	voltage_signal_(nullptr),
+	current_signal_(nullptr)
+{
+	reset();
+}
+
+void PowerStatistics::set_signals(shared_ptr<AnalogTimeSignal> voltage_signal,
+	shared_ptr<AnalogTimeSignal> current_signal)
+{
+	voltage_signal_ = voltage_signal;
+	current_signal_ = current_signal;
+	reset();
+}
+
+void PowerStatistics::reset()
+{
+	next_voltage_pos_ = voltage_signal_ ? voltage_signal_->sample_count() : 0;
+	next_current_pos_ = current_signal_ ? current_signal_->sample_count() : 0;
+	next_voltage_value_pos_ = next_voltage_pos_;
+	next_current_value_pos_ = next_current_pos_;
+
+	has_voltage_ = false;
+	has_current_ = false;
+	has_values_ = false;
+	last_timestamp_ = 0.;
+	pair_voltage_ = 0.;
+	pair_current_ = 0.;
+	last_current_ = 0.;
+	voltage_ = 0.;
+	voltage_min_ = std::numeric_limits<double>::max();
+	voltage_max_ = std::numeric_limits<double>::lowest();
+	current_ = 0.;
+	current_min_ = std::numeric_limits<double>::max();
+	current_max_ = std::numeric_limits<double>::lowest();
+	resistance_ = 0.;
+	resistance_min_ = std::numeric_limits<double>::max();
+	resistance_max_ = std::numeric_limits<double>::lowest();
+	power_ = 0.;
+	power_min_ = std::numeric_limits<double>::max();
+	power_max_ = std::numeric_limits<double>::lowest();
+	amp_hours_ = 0.;
+	watt_hours_ = 0.;
+}
+
+bool PowerStatistics::update()
+{
+	if (!voltage_signal_ || !current_signal_)
+		return false;
+
+	const size_t voltage_count = voltage_signal_->sample_count();
+	const size_t current_count = current_signal_->sample_count();
+	if (voltage_count < next_voltage_value_pos_ ||
+			current_count < next_current_value_pos_) {
+		// A signal has been cleared.
+		reset();
+		return false;
+	}
+
+	const bool values_updated = update_signal_values();
+	const bool pairs_updated = update_pairs();
+	return values_updated || pairs_updated;
+}
+
+bool PowerStatistics::update_signal_values()
+{
+	const size_t voltage_count = voltage_signal_->sample_count();
+	bool updated = false;
+	while (next_voltage_value_pos_ < voltage_count) {
+		voltage_ = voltage_signal_->get_sample(
+			next_voltage_value_pos_++, false).second;
+		if (voltage_min_ > voltage_)
+			voltage_min_ = voltage_;
+		if (voltage_max_ < voltage_)
+			voltage_max_ = voltage_;
+		updated = true;
+	}
+
+	const size_t current_count = current_signal_->sample_count();
+	while (next_current_value_pos_ < current_count) {
+		current_ = current_signal_->get_sample(
+			next_current_value_pos_++, false).second;
+		if (current_min_ > current_)
+			current_min_ = current_;
+		if (current_max_ < current_)
+			current_max_ = current_;
+		updated = true;
+	}
+
+	return updated;
+}
+
+bool PowerStatistics::update_pairs()
+{
+	const size_t voltage_count = voltage_signal_->sample_count();
+	const size_t current_count = current_signal_->sample_count();
+	if (voltage_count == 0 || current_count == 0)
+		return false;
+
+	// Samples after the last timestamp of the slower signal are processed
+	// with the next update, when the matching samples of the other signal
+	// are available.
+	const double voltage_end =
+		voltage_signal_->get_sample(voltage_count - 1, false).first;
+	const double current_end =
+		current_signal_->get_sample(current_count - 1, false).first;
+	const double end_timestamp =
+		voltage_end < current_end ? voltage_end : current_end;
+
+	bool updated = false;
+	while (next_voltage_pos_ < voltage_count ||
+			next_current_pos_ < current_count) {
+		double voltage_ts = std::numeric_limits<double>::max();
+		double current_ts = std::numeric_limits<double>::max();
+		if (next_voltage_pos_ < voltage_count) {
+			voltage_ts =
+				voltage_signal_->get_sample(next_voltage_pos_, false).first;
+		}
+		if (next_current_pos_ < current_count) {
+			current_ts =
+				current_signal_->get_sample(next_current_pos_, false).first;
+		}
+		const double timestamp =
+			voltage_ts < current_ts ? voltage_ts : current_ts;
+		if (timestamp > end_timestamp)
+			break;
+
+		// Samples with the same timestamp are processed together.
+		if (voltage_ts == timestamp) {
+			pair_voltage_ =
+				voltage_signal_->get_sample(next_voltage_pos_, false).second;
+			has_voltage_ = true;
+			++next_voltage_pos_;
+		}
+		if (current_ts == timestamp) {
+			pair_current_ =
+				current_signal_->get_sample(next_current_pos_, false).second;
+			has_current_ = true;
+			++next_current_pos_;
+		}
+
+		if (has_voltage_ && has_current_) {
+			add_pair(timestamp);
+			updated = true;
+		}
+	}
+
+	return updated;
+}
+
+void PowerStatistics::add_pair(double timestamp)
+{
+	const double resistance = pair_current_ == 0. ?
+		std::numeric_limits<double>::max() : pair_voltage_ / pair_current_;
+	if (resistance_min_ > resistance)
+		resistance_min_ = resistance;
+	if (resistance_max_ < resistance)
+		resistance_max_ = resistance;
+
+	const double power = pair_voltage_ * pair_current_;
+	if (power_min_ > power)
+		power_min_ = power;
+	if (power_max_ < power)
+		power_max_ = power;
+
+	// Trapezoidal rule between the last and the actual pair.
+	if (has_values_) {
+		const double elapsed_hours = (timestamp - last_timestamp_) / 3600.;
+		amp_hours_ += (last_current_ + pair_current_) / 2. * elapsed_hours;
+		watt_hours_ += (power_ + power) / 2. * elapsed_hours;
+	}
+
+	resistance_ = resistance;
+	power_ = power;
+	last_current_ = pair_current_;
+	last_timestamp_ = timestamp;
+	has_values_ = true;
+}
+
+} // namespace data
+} // namespace sv
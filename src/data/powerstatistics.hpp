@@ -0,0 +1,127 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_POWERSTATISTICS_HPP
+#define DATA_POWERSTATISTICS_HPP
+
+#include <cstddef>
+#include <memory>
+
+using std::shared_ptr;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Accumulates the min/max values of voltage, current, resistance and power
+ * and the integrals (Ah, Wh) from all samples of a voltage and a current
+ * signal.
+ *
+ * The voltage and current values are processed for each signal on its own,
+ * so they are also updated while the other signal stalls. For resistance,
+ * power and the integrals, update() merges the samples of both signals in
+ * the order of their timestamps, but only up to the last timestamp of the
+ * slower signal, so the samples of both signals are always aligned. Each
+ * sample is paired with the last value of the other signal and the
+ * integrals are calculated with the trapezoidal rule between two aligned
+ * pairs, using the signal timestamps.
+ */
+class PowerStatistics
+{
+
+public:
+	PowerStatistics();
+
+	void set_signals(shared_ptr<AnalogTimeSignal> voltage_signal,
+		shared_ptr<AnalogTimeSignal> current_signal);
+	/**
+	 * Reset all values. Only samples that are added after the reset are
+	 * processed.
+	 */
+	void reset();
+	/**
+	 * Process the new samples of both signals. Return true, when new values
+	 * are available.
+	 */
+	bool update();
+
+	/** Return true, when there is at least one aligned voltage/current pair. */
+	bool has_values() const { return has_values_; }
+	double voltage() const { return voltage_; }
+	double voltage_min() const { return voltage_min_; }
+	double voltage_max() const { return voltage_max_; }
+	double current() const { return current_; }
+	double current_min() const { return current_min_; }
+	double current_max() const { return current_max_; }
+	double resistance() const { return resistance_; }
+	double resistance_min() const { return resistance_min_; }
+	double resistance_max() const { return resistance_max_; }
+	double power() const { return power_; }
+	double power_min() const { return power_min_; }
+	double power_max() const { return power_max_; }
+	double amp_hours() const { return amp_hours_; }
+	double watt_hours() const { return watt_hours_; }
+
+private:
+	/** Process the new samples of each signal on its own. */
+	bool update_signal_values();
+	/** Merge the aligned samples of both signals into pairs. */
+	bool update_pairs();
+	void add_pair(double timestamp);
+
+	shared_ptr<AnalogTimeSignal> voltage_signal_;
+	shared_ptr<AnalogTimeSignal> current_signal_;
+	/** The next samples for the voltage and current values. */
+	size_t next_voltage_value_pos_;
+	size_t next_current_value_pos_;
+	/** The next samples to merge into pairs. */
+	size_t next_voltage_pos_;
+	size_t next_current_pos_;
+
+	bool has_voltage_;
+	bool has_current_;
+	bool has_values_;
+	double last_timestamp_;
+	/** The values of the actual pair. */
+	double pair_voltage_;
+	double pair_current_;
+	double last_current_;
+	double voltage_;
+	double voltage_min_;
+	double voltage_max_;
+	double current_;
+	double current_min_;
+	double current_max_;
+	double resistance_;
+	double resistance_min_;
+	double resistance_max_;
+	double power_;
+	double power_min_;
+	double power_max_;
+	double amp_hours_;
+	double watt_hours_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_POWERSTATISTICS_HPP
@@ -0,0 +1,269 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "retainedsamples.hpp"
+
+using std::deque;
+using std::make_pair;
+using std::pair;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+inline bool is_same_slot(double timestamp1, double timestamp2,
+	double resolution)
+{
+	if (resolution <= 0.)
+		return false;
+	return std::floor(timestamp1 / resolution) ==
+		std::floor(timestamp2 / resolution);
+}
+
+} // namespace
+
+RetainedSamples::RetainedSamples(double raw_duration,
+		const vector<retention_tier_t> &tiers) :
+	raw_duration_(raw_duration),
+	tiers_(tiers),
+	buckets_(tiers.size()),
+	sample_count_(0)
+{
+	assert(!tiers_.empty());
+}
+
+double RetainedSamples::raw_duration() const
+{
+	return raw_duration_;
+}
+
+const vector<retention_tier_t> &RetainedSamples::tiers() const
+{
+	return tiers_;
+}
+
+void RetainedSamples::add_samples(const double *timestamps,
+	const double *values, size_t count)
+{
+	const double resolution = tiers_[0].first;
+	auto &tier = buckets_[0];
+	for (size_t i = 0; i < count; ++i) {
+		const double value = values[i];
+		if (tier.empty() || !is_same_slot(
+				tier.back().first_timestamp, timestamps[i], resolution)) {
+			tier.push_back({ sample_count_, 1, timestamps[i], timestamps[i],
+				value, value, value });
+		}
+		else {
+			Bucket &bucket = tier.back();
+			++bucket.count;
+			bucket.last_timestamp = timestamps[i];
+			if (value < bucket.min)
+				bucket.min = value;
+			if (value > bucket.max)
+				bucket.max = value;
+			bucket.mean += (value - bucket.mean) / (double)bucket.count;
+		}
+		++sample_count_;
+	}
+}
+
+void RetainedSamples::compact(double last_timestamp)
+{
+	double cutoff = last_timestamp - raw_duration_;
+	for (size_t t = 0; t + 1 < tiers_.size(); ++t) {
+		cutoff -= tiers_[t].second;
+		auto &tier = buckets_[t];
+		while (!tier.empty() && tier.front().last_timestamp < cutoff) {
+			add_bucket(t + 1, tier.front());
+			tier.pop_front();
+		}
+	}
+}
+
+size_t RetainedSamples::sample_count() const
+{
+	return sample_count_;
+}
+
+size_t RetainedSamples::bucket_count() const
+{
+	size_t count = 0;
+	for (const auto &tier : buckets_)
+		count += tier.size();
+	return count;
+}
+
+double RetainedSamples::timestamp(size_t pos) const
+{
+	const Bucket *bucket = find_bucket(pos).second;
+	return bucket_timestamp(*bucket, pos - bucket->start_pos);
+}
+
+double RetainedSamples::value(size_t pos) const
+{
+	return find_bucket(pos).second->mean;
+}
+
+pair<double, double> RetainedSamples::envelope(size_t pos) const
+{
+	const Bucket *bucket = find_bucket(pos).second;
+	return make_pair(bucket->min, bucket->max);
+}
+
+double RetainedSamples::resolution(size_t pos) const
+{
+	return tiers_[find_bucket(pos).first].first;
+}
+
+size_t RetainedSamples::copy(size_t pos, size_t count,
+	double *timestamps, double *values) const
+{
+	if (pos >= sample_count_)
+		return 0;
+	count = std::min(count, sample_count_ - pos);
+
+	size_t copied = 0;
+	while (copied < count) {
+		const Bucket &bucket = *find_bucket(pos + copied).second;
+		const size_t offset = pos + copied - bucket.start_pos;
+		const size_t n = std::min(count - copied, bucket.count - offset);
+		for (size_t i = 0; i < n; ++i) {
+			if (timestamps)
+				timestamps[copied + i] = bucket_timestamp(bucket, offset + i);
+			if (values)
+				values[copied + i] = bucket.mean;
+		}
+		copied += n;
+	}
+	return copied;
+}
+
+size_t RetainedSamples::copy_buckets(size_t &pos, size_t end, size_t count,
+	double *timestamps, double *values) const
+{
+	end = std::min(end, sample_count_);
+	size_t copied = 0;
+	while (copied < count && pos < end) {
+		const Bucket &bucket = *find_bucket(pos).second;
+		if (pos == bucket.start_pos) {
+			timestamps[copied] =
+				(bucket.first_timestamp + bucket.last_timestamp) / 2.;
+		}
+		else {
+			timestamps[copied] = bucket.last_timestamp;
+		}
+		values[copied] = bucket.mean;
+		pos = bucket.start_pos + bucket.count;
+		++copied;
+	}
+	return copied;
+}
+
+size_t RetainedSamples::lower_bound_pos(double timestamp) const
+{
+	// From the oldest (coarsest) to the newest (finest) tier.
+	for (size_t t = buckets_.size(); t-- > 0;) {
+		const auto &tier = buckets_[t];
+		if (tier.empty() || tier.back().last_timestamp < timestamp)
+			continue;
+
+		const Bucket &bucket = *std::partition_point(tier.begin(), tier.end(),
+			[timestamp](const Bucket &b) {
+				return b.last_timestamp < timestamp;
+			});
+		if (bucket.first_timestamp >= timestamp)
+			return bucket.start_pos;
+
+		// The first interpolated timestamp, that is not less than timestamp.
+		// The last timestamp of the bucket is not less than timestamp.
+		const double span = bucket.last_timestamp - bucket.first_timestamp;
+		size_t offset = (size_t)std::ceil(
+			(timestamp - bucket.first_timestamp) / span * (bucket.count - 1));
+		offset = std::min(std::max(offset, (size_t)1), bucket.count - 1);
+		while (offset > 1 && bucket_timestamp(bucket, offset - 1) >= timestamp)
+			--offset;
+		while (offset < bucket.count - 1 &&
+				bucket_timestamp(bucket, offset) < timestamp)
+			++offset;
+		return bucket.start_pos + offset;
+	}
+	return sample_count_;
+}
+
+pair<size_t, const RetainedSamples::Bucket *> RetainedSamples::find_bucket(
+	size_t pos) const
+{
+	// The oldest samples (with the lowest positions) are in the last tier.
+	for (size_t t = buckets_.size(); t-- > 0;) {
+		const auto &tier = buckets_[t];
+		if (tier.empty() || pos >= tier.back().start_pos + tier.back().count)
+			continue;
+
+		const auto it = std::upper_bound(tier.begin(), tier.end(), pos,
+			[](size_t p, const Bucket &bucket) { return p < bucket.start_pos; });
+		return make_pair(t, &*(it - 1));
+	}
+
+	assert(false);
+	return make_pair(0, nullptr);
+}
+
+double RetainedSamples::bucket_timestamp(const Bucket &bucket,
+	size_t offset) const
+{
+	if (offset == 0 || bucket.count <= 1)
+		return bucket.first_timestamp;
+	if (offset >= bucket.count - 1)
+		return bucket.last_timestamp;
+	return bucket.first_timestamp +
+		(bucket.last_timestamp - bucket.first_timestamp) *
+		((double)offset / (double)(bucket.count - 1));
+}
+
+void RetainedSamples::add_bucket(size_t tier, const Bucket &bucket)
+{
+	auto &buckets = buckets_[tier];
+	if (buckets.empty() || !is_same_slot(buckets.back().first_timestamp,
+			bucket.first_timestamp, tiers_[tier].first)) {
+		buckets.push_back(bucket);
+		return;
+	}
+
+	Bucket &back = buckets.back();
+	const double count = (double)(back.count + bucket.count);
+	back.mean = back.mean * ((double)back.count / count) +
+		bucket.mean * ((double)bucket.count / count);
+	back.count += bucket.count;
+	back.last_timestamp = bucket.last_timestamp;
+	back.min = std::min(back.min, bucket.min);
+	back.max = std::max(back.max, bucket.max);
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,137 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_RETAINEDSAMPLES_HPP
+#define DATA_RETAINEDSAMPLES_HPP
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+using std::deque;
+using std::pair;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * A retention tier: 1. the resolution (bucket width) in seconds and 2. the
+ * duration in seconds, the buckets are kept in this tier.
+ */
+typedef pair<double, double> retention_tier_t;
+
+/**
+ * Downsampled storage for the old samples of a signal.
+ *
+ * The samples are aggregated into min/max/mean buckets. The buckets are
+ * moved to the next coarser tier, when they are older than the duration of
+ * their tier. The last tier keeps its buckets forever.
+ *
+ * A bucket still covers the positions of all the samples it was aggregated
+ * from, so the positions of the signal don't change. Reading a position
+ * returns the mean of the bucket with a timestamp interpolated between the
+ * first and the last timestamp of the bucket.
+ */
+class RetainedSamples
+{
+
+public:
+	/**
+	 * @param raw_duration The duration in seconds, the samples are kept
+	 *                     with full resolution.
+	 * @param tiers The retention tiers, from fine to coarse. The resolutions
+	 *              should be multiples of each other.
+	 */
+	RetainedSamples(double raw_duration, const vector<retention_tier_t> &tiers);
+
+	double raw_duration() const;
+	const vector<retention_tier_t> &tiers() const;
+
+	/** Aggregate the next (oldest raw) samples into the first tier. */
+	void add_samples(const double *timestamps, const double *values,
+		size_t count);
+	/** Move the buckets, that are too old for their tier, to the next tier. */
+	void compact(double last_timestamp);
+
+	size_t sample_count() const;
+	size_t bucket_count() const;
+
+	double timestamp(size_t pos) const;
+	double value(size_t pos) const;
+	/** Return the min and max value of the bucket at pos. */
+	pair<double, double> envelope(size_t pos) const;
+	/** Return the resolution of the bucket at pos in seconds. */
+	double resolution(size_t pos) const;
+	/**
+	 * Copy up to count samples, starting at pos.
+	 *
+	 * @return The number of copied samples.
+	 */
+	size_t copy(size_t pos, size_t count,
+		double *timestamps, double *values) const;
+	/**
+	 * Copy one sample per bucket (the mean value at the center of the
+	 * bucket) for up to count buckets, starting with the bucket at pos and
+	 * ending before end. If pos is not the start of its bucket, the last
+	 * timestamp of the bucket is used, so the timestamps are still
+	 * ascending after the samples before pos.
+	 *
+	 * @param pos The position to start at. It is set to the position after
+	 *            the last copied bucket.
+	 *
+	 * @return The number of copied buckets.
+	 */
+	size_t copy_buckets(size_t &pos, size_t end, size_t count,
+		double *timestamps, double *values) const;
+	/**
+	 * Return the position of the first sample with a timestamp that is not
+	 * less than the given timestamp, or sample_count().
+	 */
+	size_t lower_bound_pos(double timestamp) const;
+
+private:
+	struct Bucket
+	{
+		size_t start_pos;
+		size_t count;
+		double first_timestamp;
+		double last_timestamp;
+		double min;
+		double max;
+		double mean;
+	};
+
+	/** Return the tier and the bucket for a position. */
+	pair<size_t, const Bucket *> find_bucket(size_t pos) const;
+	double bucket_timestamp(const Bucket &bucket, size_t offset) const;
+	void add_bucket(size_t tier, const Bucket &bucket);
+
+	double raw_duration_;
+	vector<retention_tier_t> tiers_;
+	/** The buckets of the tiers, the oldest buckets are in the last tier. */
+	vector<deque<Bucket>> buckets_;
+	size_t sample_count_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_RETAINEDSAMPLES_HPP
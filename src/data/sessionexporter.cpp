@@ -0,0 +1,96 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sessionexporter.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/sessionfile.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+SessionExporter::SessionExporter(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &file_name) :
+	BaseExporter(signals, file_name)
+{
+}
+
+SessionExporter::~SessionExporter()
+{
+	wait();
+}
+
+bool SessionExporter::export_file()
+{
+	SessionFileWriter writer;
+	if (!writer.open(file_name_)) {
+		error_ = "Could not open file " + file_name_;
+		return false;
+	}
+
+	// The samples that are added while exporting are not exported.
+	vector<size_t> sample_counts;
+	uint64_t total_sample_count = 0;
+	for (const auto &signal : signals_) {
+		sample_counts.push_back(signal->sample_count());
+		total_sample_count += sample_counts.back();
+	}
+
+	// The retained samples are exported with one sample per bucket, the
+	// progress is counted in positions.
+	vector<double> timestamps;
+	vector<double> values;
+	uint64_t exported_sample_count = 0;
+	for (size_t i = 0; i < signals_.size(); ++i) {
+		const uint32_t id = writer.add_signal(signals_[i]);
+		size_t pos = 0;
+		while (pos < sample_counts[i]) {
+			const size_t start_pos = pos;
+			const size_t count = signals_[i]->get_export_samples(pos,
+				sample_counts[i], block_size_, timestamps, values, false);
+			if (count == 0)
+				break;
+			if (!writer.append_samples(
+					id, timestamps.data(), values.data(), count)) {
+				writer.close();
+				return false;
+			}
+			exported_sample_count += std::min(pos, sample_counts[i]) - start_pos;
+			if (!update_progress(exported_sample_count, total_sample_count)) {
+				writer.close();
+				return false;
+			}
+		}
+	}
+
+	return writer.close();
+}
+
+} // namespace data
+} // namespace sv
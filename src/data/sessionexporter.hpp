@@ -0,0 +1,65 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SESSIONEXPORTER_HPP
+#define DATA_SESSIONEXPORTER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/data/baseexporter.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Export analog time signals into a SmuView session file (*.svs).
+ *
+ * The export runs in its own thread and copies the samples block wise, so
+ * the signals may still be growing while they are exported.
+ */
+class SessionExporter : public BaseExporter
+{
+	Q_OBJECT
+
+public:
+	SessionExporter(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &file_name);
+	~SessionExporter();
+
+protected:
+	bool export_file() override;
+
+private:
+	/** Number of samples that are copied at once from a signal. */
+	static constexpr size_t block_size_ = 65536;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SESSIONEXPORTER_HPP
@@ -0,0 +1,771 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <libsigrokcxx/libsigrokcxx.hpp>
+
+#include <QDebug>
+#include <QString>
+
+#include "sessionfile.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+const char file_magic[8] = { 'S', 'M', 'U', 'V', 'I', 'E', 'W', '\0' };
+const char index_magic[8] = { 'S', 'V', 'I', 'N', 'D', 'E', 'X', '\0' };
+const uint32_t file_version = 1;
+
+const uint32_t record_type_signal = 0x4C474953; // "SIGL"
+const uint32_t record_type_chunk = 0x4B4E4843; // "CHNK"
+const uint32_t record_type_index = 0x58444E49; // "INDX"
+
+const uint64_t file_header_size = 16;
+const uint64_t record_header_size = 16;
+const uint64_t chunk_header_size = 40;
+const uint64_t trailer_size = 16;
+
+template<typename T> void put(string &buffer, const T &value)
+{
+	buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void put_string(string &buffer, const string &str)
+{
+	put(buffer, (uint32_t)str.size());
+	buffer.append(str);
+}
+
+template<typename T> bool get(const char *&pos, const char *end, T &value)
+{
+	if ((size_t)(end - pos) < sizeof(T))
+		return false;
+	std::memcpy(&value, pos, sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
+
+bool get_string(const char *&pos, const char *end, string &str)
+{
+	uint32_t size;
+	if (!get(pos, end, size) || (size_t)(end - pos) < size)
+		return false;
+	str.assign(pos, size);
+	pos += size;
+	return true;
+}
+
+uint64_t padded_size(uint64_t size)
+{
+	return (size + 7) & ~(uint64_t)7;
+}
+
+void put_chunk_header(string &buffer, const SessionChunkInfo &chunk)
+{
+	put(buffer, chunk.signal_id);
+	put(buffer, chunk.sample_count);
+	put(buffer, chunk.first_timestamp);
+	put(buffer, chunk.last_timestamp);
+	put(buffer, chunk.min_value);
+	put(buffer, chunk.max_value);
+}
+
+bool get_chunk_header(const char *&pos, const char *end,
+	SessionChunkInfo &chunk)
+{
+	return get(pos, end, chunk.signal_id) &&
+		get(pos, end, chunk.sample_count) &&
+		get(pos, end, chunk.first_timestamp) &&
+		get(pos, end, chunk.last_timestamp) &&
+		get(pos, end, chunk.min_value) &&
+		get(pos, end, chunk.max_value);
+}
+
+// The sigrok enum getters throw for unknown IDs, which may come from files
+// written by other versions.
+Quantity get_quantity_from_id(uint32_t sr_quantity)
+{
+	try {
+		return datautil::get_quantity(sr_quantity);
+	}
+	catch (sigrok::Error &) {
+		return Quantity::Unknown;
+	}
+}
+
+set<QuantityFlag> get_quantity_flags_from_id(uint64_t sr_quantity_flags)
+{
+	try {
+		return datautil::get_quantity_flags(sr_quantity_flags);
+	}
+	catch (sigrok::Error &) {
+		return set<QuantityFlag>();
+	}
+}
+
+} // namespace
+
+
+SessionFileWriter::SessionFileWriter(size_t chunk_size) :
+	chunk_size_(chunk_size > 0 ? chunk_size : 1),
+	file_(nullptr),
+	offset_(0),
+	buffered_size_(0)
+{
+}
+
+SessionFileWriter::~SessionFileWriter()
+{
+	close();
+}
+
+bool SessionFileWriter::open(const string &file_name)
+{
+	close();
+
+	file_ = std::fopen(file_name.c_str(), "wb");
+	if (!file_) {
+		qWarning() << "SessionFileWriter::open(): Could not open file " <<
+			QString::fromStdString(file_name);
+		return false;
+	}
+
+	file_name_ = file_name;
+	offset_ = 0;
+	buffered_size_ = 0;
+	signals_.clear();
+	signal_offsets_.clear();
+	timestamp_buffers_.clear();
+	value_buffers_.clear();
+	chunks_.clear();
+
+	string header(file_magic, sizeof(file_magic));
+	put(header, file_version);
+	put(header, (uint32_t)0);
+	if (std::fwrite(header.data(), 1, header.size(), file_) != header.size())
+		return false;
+	offset_ = header.size();
+
+	return true;
+}
+
+bool SessionFileWriter::is_open() const
+{
+	return file_ != nullptr;
+}
+
+string SessionFileWriter::file_name() const
+{
+	return file_name_;
+}
+
+uint32_t SessionFileWriter::add_signal(const SessionSignalInfo &info)
+{
+	const uint32_t id = (uint32_t)signals_.size();
+	signals_.push_back(info);
+	signals_.back().id = id;
+	timestamp_buffers_.emplace_back();
+	value_buffers_.emplace_back();
+
+	string payload;
+	put(payload, id);
+	put(payload, datautil::get_sr_quantity_id(info.quantity));
+	put(payload, datautil::get_sr_quantity_flags_id(info.quantity_flags));
+	put(payload, datautil::get_sr_unit_id(info.unit));
+	put(payload, (int32_t)info.digits);
+	put(payload, (int32_t)info.decimal_places);
+	put(payload, info.signal_start_timestamp);
+	put_string(payload, info.device_name);
+	put(payload, (uint32_t)info.channel_group_names.size());
+	for (const auto &chg_name : info.channel_group_names)
+		put_string(payload, chg_name);
+	put_string(payload, info.channel_name);
+	put_string(payload, info.signal_name);
+
+	signal_offsets_.push_back(offset_);
+	write_record(record_type_signal, payload);
+
+	return id;
+}
+
+uint32_t SessionFileWriter::add_signal(shared_ptr<AnalogTimeSignal> signal)
+{
+	SessionSignalInfo info;
+	auto channel = signal->parent_channel();
+	if (channel) {
+		info.channel_name = channel->name();
+		info.channel_group_names = channel->channel_group_names();
+		if (channel->parent_device())
+			info.device_name = channel->parent_device()->name();
+	}
+	info.signal_name = signal->name();
+	info.quantity = signal->quantity();
+	info.quantity_flags = signal->quantity_flags();
+	info.unit = signal->unit();
+	info.digits = signal->digits();
+	info.decimal_places = signal->decimal_places();
+	info.signal_start_timestamp = signal->signal_start_timestamp();
+
+	return add_signal(info);
+}
+
+bool SessionFileWriter::append_samples(uint32_t signal_id,
+	const double *timestamps, const double *values, size_t count)
+{
+	if (!file_ || signal_id >= signals_.size())
+		return false;
+
+	auto &timestamp_buffer = timestamp_buffers_[signal_id];
+	auto &value_buffer = value_buffers_[signal_id];
+	while (count > 0) {
+		const size_t n =
+			std::min(count, chunk_size_ - timestamp_buffer.size());
+		timestamp_buffer.insert(
+			timestamp_buffer.end(), timestamps, timestamps + n);
+		value_buffer.insert(value_buffer.end(), values, values + n);
+		buffered_size_ += n * 2 * sizeof(double);
+		timestamps += n;
+		values += n;
+		count -= n;
+
+		if (timestamp_buffer.size() >= chunk_size_ && !write_chunk(signal_id))
+			return false;
+	}
+
+	return true;
+}
+
+bool SessionFileWriter::flush()
+{
+	if (!file_)
+		return false;
+
+	for (uint32_t id = 0; id < signals_.size(); ++id) {
+		if (!write_chunk(id))
+			return false;
+	}
+	return std::fflush(file_) == 0;
+}
+
+bool SessionFileWriter::sync()
+{
+	if (!flush())
+		return false;
+
+#ifdef _WIN32
+	return _commit(_fileno(file_)) == 0;
+#else
+	return fsync(fileno(file_)) == 0;
+#endif
+}
+
+uint64_t SessionFileWriter::file_size() const
+{
+	return offset_ + buffered_size_;
+}
+
+bool SessionFileWriter::close()
+{
+	if (!file_)
+		return true;
+
+	bool ret = flush();
+
+	// Index
+	if (ret) {
+		const uint64_t index_offset = offset_;
+		string payload;
+		put(payload, (uint32_t)signal_offsets_.size());
+		put(payload, (uint32_t)chunks_.size());
+		for (const auto &signal_offset : signal_offsets_)
+			put(payload, signal_offset);
+		for (const auto &chunk : chunks_) {
+			put(payload, chunk.data_offset);
+			put_chunk_header(payload, chunk);
+		}
+		ret = write_record(record_type_index, payload);
+
+		// Trailer
+		string trailer;
+		put(trailer, index_offset);
+		trailer.append(index_magic, sizeof(index_magic));
+		ret = ret && std::fwrite(
+			trailer.data(), 1, trailer.size(), file_) == trailer.size();
+	}
+
+	ret = std::fclose(file_) == 0 && ret;
+	file_ = nullptr;
+	return ret;
+}
+
+bool SessionFileWriter::write_record(uint32_t type, const string &payload)
+{
+	const uint64_t size = padded_size(payload.size());
+	string record;
+	record.reserve(record_header_size + size);
+	put(record, type);
+	put(record, (uint32_t)0);
+	put(record, size);
+	record.append(payload);
+	record.resize(record_header_size + size, '\0');
+
+	if (std::fwrite(record.data(), 1, record.size(), file_) != record.size())
+		return false;
+	offset_ += record.size();
+	return true;
+}
+
+bool SessionFileWriter::write_chunk(uint32_t signal_id)
+{
+	auto &timestamp_buffer = timestamp_buffers_[signal_id];
+	auto &value_buffer = value_buffers_[signal_id];
+	const size_t count = timestamp_buffer.size();
+	if (count == 0)
+		return true;
+
+	SessionChunkInfo chunk;
+	chunk.signal_id = signal_id;
+	chunk.sample_count = (uint32_t)count;
+	chunk.data_offset = offset_ + record_header_size + chunk_header_size;
+	chunk.first_timestamp = timestamp_buffer.front();
+	chunk.last_timestamp = timestamp_buffer.back();
+	const auto minmax =
+		std::minmax_element(value_buffer.begin(), value_buffer.end());
+	chunk.min_value = *minmax.first;
+	chunk.max_value = *minmax.second;
+
+	// The chunk data is written directly from the buffers, only the headers
+	// are copied.
+	const uint64_t data_size = count * sizeof(double);
+	string header;
+	put(header, record_type_chunk);
+	put(header, (uint32_t)0);
+	put(header, chunk_header_size + 2 * data_size);
+	put_chunk_header(header, chunk);
+
+	if (std::fwrite(header.data(), 1, header.size(), file_) != header.size() ||
+		std::fwrite(timestamp_buffer.data(), sizeof(double), count, file_) != count ||
+		std::fwrite(value_buffer.data(), sizeof(double), count, file_) != count)
+		return false;
+
+	offset_ += header.size() + 2 * data_size;
+	buffered_size_ -= 2 * data_size;
+	chunks_.push_back(chunk);
+	timestamp_buffer.clear();
+	value_buffer.clear();
+	return true;
+}
+
+
+SessionFileReader::SessionFileReader() :
+	has_index_(false)
+{
+}
+
+bool SessionFileReader::open(const string &file_name)
+{
+	close();
+
+	file_.open(file_name, std::ios::in | std::ios::binary);
+	if (!file_.is_open())
+		return false;
+	file_name_ = file_name;
+
+	file_.seekg(0, std::ios::end);
+	const uint64_t file_size = (uint64_t)file_.tellg();
+	if (file_size < file_header_size) {
+		close();
+		return false;
+	}
+
+	// File header
+	string header;
+	if (!read_payload(0, file_header_size, header) ||
+			std::memcmp(header.data(), file_magic, sizeof(file_magic)) != 0) {
+		close();
+		return false;
+	}
+	const char *pos = header.data() + sizeof(file_magic);
+	uint32_t version;
+	get(pos, header.data() + header.size(), version);
+	if (version > file_version) {
+		qWarning() << "SessionFileReader::open(): Unsupported version" <<
+			version;
+		close();
+		return false;
+	}
+
+	// Use the index if the file has been closed properly, scan the file
+	// otherwise.
+	string trailer;
+	if (file_size >= file_header_size + trailer_size &&
+			read_payload(file_size - trailer_size, trailer_size, trailer) &&
+			std::memcmp(trailer.data() + sizeof(uint64_t),
+				index_magic, sizeof(index_magic)) == 0) {
+		uint64_t index_offset;
+		pos = trailer.data();
+		get(pos, trailer.data() + trailer.size(), index_offset);
+		has_index_ = read_index(index_offset, file_size);
+	}
+	if (!has_index_) {
+		signals_.clear();
+		signal_chunks_.clear();
+		if (!scan_records(file_size)) {
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void SessionFileReader::close()
+{
+	if (file_.is_open())
+		file_.close();
+	file_.clear();
+	file_name_.clear();
+	has_index_ = false;
+	signals_.clear();
+	signal_chunks_.clear();
+}
+
+bool SessionFileReader::is_open() const
+{
+	return file_.is_open();
+}
+
+string SessionFileReader::file_name() const
+{
+	return file_name_;
+}
+
+bool SessionFileReader::has_index() const
+{
+	return has_index_;
+}
+
+const vector<SessionSignalInfo> &SessionFileReader::signals() const
+{
+	return signals_;
+}
+
+const vector<SessionChunkInfo> &SessionFileReader::chunks(
+	uint32_t signal_id) const
+{
+	static const vector<SessionChunkInfo> no_chunks;
+	if (signal_id >= signal_chunks_.size())
+		return no_chunks;
+	return signal_chunks_[signal_id];
+}
+
+uint64_t SessionFileReader::sample_count(uint32_t signal_id) const
+{
+	uint64_t count = 0;
+	for (const auto &chunk : chunks(signal_id))
+		count += chunk.sample_count;
+	return count;
+}
+
+bool SessionFileReader::read_chunk(const SessionChunkInfo &chunk,
+	vector<double> &timestamps, vector<double> &values)
+{
+	const std::streamsize data_size = chunk.sample_count * sizeof(double);
+	timestamps.resize(chunk.sample_count);
+	values.resize(chunk.sample_count);
+
+	file_.clear();
+	file_.seekg(chunk.data_offset);
+	file_.read(reinterpret_cast<char *>(timestamps.data()), data_size);
+	file_.read(reinterpret_cast<char *>(values.data()), data_size);
+	return file_.good();
+}
+
+bool SessionFileReader::read_samples(uint32_t signal_id,
+	double start_timestamp, double end_timestamp,
+	vector<double> &timestamps, vector<double> &values)
+{
+	timestamps.clear();
+	values.clear();
+
+	// The chunks of a signal are in ascending time order, so the first
+	// chunk in the range can be found with a binary search.
+	const auto &signal_chunks = chunks(signal_id);
+	auto it = std::partition_point(signal_chunks.begin(), signal_chunks.end(),
+		[start_timestamp](const SessionChunkInfo &chunk) {
+			return chunk.last_timestamp < start_timestamp;
+		});
+
+	vector<double> chunk_timestamps;
+	vector<double> chunk_values;
+	for (; it != signal_chunks.end(); ++it) {
+		if (it->first_timestamp > end_timestamp)
+			break;
+		if (!read_chunk(*it, chunk_timestamps, chunk_values))
+			return false;
+
+		const auto begin = std::lower_bound(
+			chunk_timestamps.begin(), chunk_timestamps.end(), start_timestamp);
+		const auto end = std::upper_bound(
+			begin, chunk_timestamps.end(), end_timestamp);
+		timestamps.insert(timestamps.end(), begin, end);
+		values.insert(values.end(),
+			chunk_values.begin() + (begin - chunk_timestamps.begin()),
+			chunk_values.begin() + (end - chunk_timestamps.begin()));
+	}
+	return true;
+}
+
+bool SessionFileReader::read_index(uint64_t index_offset, uint64_t file_size)
+{
+	// The offsets and sizes come from the file, so check them with
+	// subtractions, that can't overflow. open() made sure, that the file is
+	// larger than the file header and the trailer.
+	string header;
+	if (index_offset < file_header_size ||
+			index_offset > file_size - record_header_size ||
+			!read_payload(index_offset, record_header_size, header))
+		return false;
+
+	const char *pos = header.data();
+	const char *end = header.data() + header.size();
+	uint32_t type;
+	uint32_t reserved;
+	uint64_t size;
+	get(pos, end, type);
+	get(pos, end, reserved);
+	get(pos, end, size);
+	if (type != record_type_index ||
+			size > file_size - index_offset - record_header_size)
+		return false;
+
+	string payload;
+	if (!read_payload(index_offset + record_header_size, size, payload))
+		return false;
+	pos = payload.data();
+	end = payload.data() + payload.size();
+
+	uint32_t signal_count;
+	uint32_t chunk_count;
+	if (!get(pos, end, signal_count) || !get(pos, end, chunk_count))
+		return false;
+
+	// Check the counts before allocating anything, they come from the file.
+	if (signal_count > (size_t)(end - pos) / sizeof(uint64_t))
+		return false;
+	signals_.resize(signal_count);
+	signal_chunks_.resize(signal_count);
+
+	vector<uint64_t> signal_offsets(signal_count);
+	for (auto &signal_offset : signal_offsets) {
+		if (!get(pos, end, signal_offset))
+			return false;
+	}
+	for (uint32_t i = 0; i < chunk_count; ++i) {
+		SessionChunkInfo chunk;
+		if (!get(pos, end, chunk.data_offset) ||
+				!get_chunk_header(pos, end, chunk))
+			return false;
+		// The index may be corrupt, so drop chunks whose data is not
+		// (completely) within the file or not aligned.
+		if (chunk.data_offset < file_header_size ||
+				chunk.data_offset % sizeof(double) != 0 ||
+				chunk.data_offset > file_size ||
+				2 * sizeof(double) * chunk.sample_count >
+					file_size - chunk.data_offset) {
+			qWarning() << "SessionFileReader::read_index(): Dropping chunk" <<
+				i << "outside of the file";
+			continue;
+		}
+		add_chunk(chunk);
+	}
+
+	for (const auto &signal_offset : signal_offsets) {
+		string signal_header;
+		if (signal_offset < file_header_size ||
+				signal_offset > file_size - record_header_size ||
+				!read_payload(signal_offset, record_header_size, signal_header))
+			return false;
+		pos = signal_header.data();
+		end = signal_header.data() + signal_header.size();
+		get(pos, end, type);
+		get(pos, end, reserved);
+		get(pos, end, size);
+		if (type != record_type_signal ||
+				size > file_size - signal_offset - record_header_size ||
+				!read_payload(signal_offset + record_header_size, size, payload) ||
+				!parse_signal(payload, signal_count))
+			return false;
+	}
+
+	return true;
+}
+
+bool SessionFileReader::scan_records(uint64_t file_size)
+{
+	uint64_t offset = file_header_size;
+	while (offset + record_header_size <= file_size) {
+		string header;
+		if (!read_payload(offset, record_header_size, header))
+			break;
+
+		const char *pos = header.data();
+		const char *end = header.data() + header.size();
+		uint32_t type;
+		uint32_t reserved;
+		uint64_t size;
+		get(pos, end, type);
+		get(pos, end, reserved);
+		get(pos, end, size);
+
+		// Stop at an incomplete record (interrupted write) or garbage.
+		if (size > file_size - offset - record_header_size)
+			break;
+
+		const uint64_t payload_offset = offset + record_header_size;
+		if (type == record_type_signal) {
+			string payload;
+			// The signals are written with ascending ids.
+			if (!read_payload(payload_offset, size, payload) ||
+					!parse_signal(payload, (uint32_t)signals_.size() + 1))
+				break;
+		}
+		else if (type == record_type_chunk) {
+			string chunk_header;
+			if (size < chunk_header_size ||
+					!read_payload(payload_offset, chunk_header_size, chunk_header))
+				break;
+			SessionChunkInfo chunk;
+			pos = chunk_header.data();
+			get_chunk_header(pos, chunk_header.data() + chunk_header.size(), chunk);
+			if (chunk_header_size + 2 * sizeof(double) * chunk.sample_count > size)
+				break;
+			chunk.data_offset = payload_offset + chunk_header_size;
+			add_chunk(chunk);
+		}
+		else if (type != record_type_index) {
+			break;
+		}
+
+		offset = payload_offset + size;
+	}
+
+	return true;
+}
+
+bool SessionFileReader::read_payload(uint64_t offset, uint64_t size,
+	string &payload)
+{
+	payload.resize(size);
+	file_.clear();
+	file_.seekg(offset);
+	file_.read(&payload[0], size);
+	return file_.good();
+}
+
+bool SessionFileReader::parse_signal(const string &payload, uint32_t max_id)
+{
+	const char *pos = payload.data();
+	const char *end = payload.data() + payload.size();
+
+	SessionSignalInfo info;
+	uint32_t sr_quantity;
+	uint64_t sr_quantity_flags;
+	uint32_t sr_unit;
+	int32_t digits;
+	int32_t decimal_places;
+	uint32_t chg_count;
+	if (!get(pos, end, info.id) ||
+			!get(pos, end, sr_quantity) ||
+			!get(pos, end, sr_quantity_flags) ||
+			!get(pos, end, sr_unit) ||
+			!get(pos, end, digits) ||
+			!get(pos, end, decimal_places) ||
+			!get(pos, end, info.signal_start_timestamp) ||
+			!get_string(pos, end, info.device_name) ||
+			!get(pos, end, chg_count))
+		return false;
+	for (uint32_t i = 0; i < chg_count; ++i) {
+		string chg_name;
+		if (!get_string(pos, end, chg_name))
+			return false;
+		info.channel_group_names.insert(chg_name);
+	}
+	if (!get_string(pos, end, info.channel_name) ||
+			!get_string(pos, end, info.signal_name))
+		return false;
+	if (info.id >= max_id) {
+		qWarning() << "SessionFileReader::parse_signal(): Invalid signal id" <<
+			info.id;
+		return false;
+	}
+
+	info.quantity = get_quantity_from_id(sr_quantity);
+	info.quantity_flags = get_quantity_flags_from_id(sr_quantity_flags);
+	info.unit = datautil::get_unit(sr_unit);
+	info.digits = digits;
+	info.decimal_places = decimal_places;
+
+	if (info.id >= signals_.size())
+		signals_.resize(info.id + 1);
+	signals_[info.id] = info;
+	if (info.id >= signal_chunks_.size())
+		signal_chunks_.resize(info.id + 1);
+
+	return true;
+}
+
+void SessionFileReader::add_chunk(const SessionChunkInfo &chunk)
+{
+	if (chunk.signal_id >= signal_chunks_.size()) {
+		qWarning() << "SessionFileReader::add_chunk(): Dropping chunk of" <<
+			"unknown signal" << chunk.signal_id;
+		return;
+	}
+	signal_chunks_[chunk.signal_id].push_back(chunk);
+}
+
+} // namespace data
+} // namespace sv
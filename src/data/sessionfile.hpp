@@ -0,0 +1,223 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SESSIONFILE_HPP
+#define DATA_SESSIONFILE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "src/data/datautil.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * SmuView session file format
+ *
+ * A session file holds the samples of one or more analog time signals. The
+ * samples are stored column wise in chunks, so a file can be written while
+ * the samples are coming in and read back by time range without reading the
+ * whole file.
+ *
+ * All values are stored in the byte order of the writing host, which is
+ * little endian on all supported platforms. A file with the other byte
+ * order is rejected by the reader, because its version doesn't match.
+ * Every record starts at an 8 byte boundary:
+ *
+ *   File header:   char[8] magic "SMUVIEW\0", uint32 version, uint32 reserved
+ *   Records:       uint32 type, uint32 reserved, uint64 payload size, payload
+ *     Signal:      id, quantity, quantity flags, unit (sigrok IDs), digits,
+ *                  decimal places, start timestamp, device name, channel
+ *                  group names, channel name, signal name
+ *     Chunk:       uint32 signal id, uint32 sample count, double first/last
+ *                  timestamp, double min/max value, double[] timestamps,
+ *                  double[] values
+ *     Index:       offsets of all signal records and the headers of all
+ *                  chunks
+ *   Trailer:       uint64 offset of the index record, char[8] "SVINDEX\0"
+ *
+ * The index and the trailer are only written when the file is closed. A file
+ * without them (e.g. of an interrupted recording) can still be read, the
+ * index is then rebuilt by scanning the records. An incomplete last record
+ * is ignored.
+ */
+
+/** The meta data of a signal in a session file. */
+struct SessionSignalInfo
+{
+	uint32_t id;
+	string device_name;
+	set<string> channel_group_names;
+	string channel_name;
+	string signal_name;
+	Quantity quantity;
+	set<QuantityFlag> quantity_flags;
+	Unit unit;
+	int digits;
+	int decimal_places;
+	double signal_start_timestamp;
+};
+
+/** The header of a chunk of samples in a session file. */
+struct SessionChunkInfo
+{
+	uint32_t signal_id;
+	uint32_t sample_count;
+	/** File offset of the timestamps, the values follow the timestamps. */
+	uint64_t data_offset;
+	double first_timestamp;
+	double last_timestamp;
+	double min_value;
+	double max_value;
+};
+
+/**
+ * Write a session file in a streaming fashion. The samples of every signal
+ * are buffered until a chunk is full or flush() is called.
+ */
+class SessionFileWriter
+{
+
+public:
+	explicit SessionFileWriter(size_t chunk_size = 65536);
+	~SessionFileWriter();
+
+	bool open(const string &file_name);
+	bool is_open() const;
+	string file_name() const;
+
+	/**
+	 * Add a signal to the file. The id of the info is ignored.
+	 *
+	 * @return The id of the signal in the file.
+	 */
+	uint32_t add_signal(const SessionSignalInfo &info);
+	/** Add a signal with the meta data of the given signal. */
+	uint32_t add_signal(shared_ptr<AnalogTimeSignal> signal);
+
+	/**
+	 * Append samples to a signal. The timestamps must be in ascending
+	 * order.
+	 */
+	bool append_samples(uint32_t signal_id, const double *timestamps,
+		const double *values, size_t count);
+
+	/** Write all buffered samples to the file. */
+	bool flush();
+	/** Flush and make sure the data is on the disk (fsync). */
+	bool sync();
+	/** The size of the file, including the buffered samples. */
+	uint64_t file_size() const;
+
+	/** Flush and write the index. */
+	bool close();
+
+private:
+	bool write_record(uint32_t type, const string &payload);
+	bool write_chunk(uint32_t signal_id);
+
+	const size_t chunk_size_;
+	std::FILE *file_;
+	string file_name_;
+	uint64_t offset_;
+	uint64_t buffered_size_;
+	vector<SessionSignalInfo> signals_;
+	vector<uint64_t> signal_offsets_;
+	vector<vector<double>> timestamp_buffers_;
+	vector<vector<double>> value_buffers_;
+	vector<SessionChunkInfo> chunks_;
+
+};
+
+/**
+ * Read a session file with random access by time range.
+ */
+class SessionFileReader
+{
+
+public:
+	SessionFileReader();
+
+	bool open(const string &file_name);
+	void close();
+	bool is_open() const;
+	string file_name() const;
+	/**
+	 * False, if the file has no index (e.g. the recording was interrupted)
+	 * and the index was rebuilt by scanning the file.
+	 */
+	bool has_index() const;
+
+	const vector<SessionSignalInfo> &signals() const;
+	/** Return the chunks of a signal, in ascending time order. */
+	const vector<SessionChunkInfo> &chunks(uint32_t signal_id) const;
+	uint64_t sample_count(uint32_t signal_id) const;
+
+	/** Read all samples of a chunk. */
+	bool read_chunk(const SessionChunkInfo &chunk,
+		vector<double> &timestamps, vector<double> &values);
+	/**
+	 * Read all samples of a signal with a timestamp within the given range.
+	 * Only the chunks that overlap the range are read.
+	 */
+	bool read_samples(uint32_t signal_id,
+		double start_timestamp, double end_timestamp,
+		vector<double> &timestamps, vector<double> &values);
+
+private:
+	bool read_index(uint64_t index_offset, uint64_t file_size);
+	bool scan_records(uint64_t file_size);
+	/**
+	 * Read size bytes at offset. The caller must have checked, that the
+	 * bytes are within the file.
+	 */
+	bool read_payload(uint64_t offset, uint64_t size, string &payload);
+	/**
+	 * Parse a signal record. The ids come from the file, so only ids lower
+	 * than max_id are accepted.
+	 */
+	bool parse_signal(const string &payload, uint32_t max_id);
+	/** Add a chunk. Chunks of unknown signals are dropped. */
+	void add_chunk(const SessionChunkInfo &chunk);
+
+	std::ifstream file_;
+	string file_name_;
+	bool has_index_;
+	vector<SessionSignalInfo> signals_;
+	vector<vector<SessionChunkInfo>> signal_chunks_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SESSIONFILE_HPP
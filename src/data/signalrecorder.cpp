@@ -0,0 +1,311 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "signalrecorder.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/sessionfile.hpp"
+
+using std::lock_guard;
+using std::shared_ptr;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+SignalRecorder::SignalRecorder(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &file_name) :
+	signals_(signals),
+	file_name_(file_name),
+	sync_interval_(1.),
+	max_file_size_((uint64_t)1 << 30),
+	max_file_duration_(24 * 60 * 60),
+	stop_(true),
+	recorded_samples_(0)
+{
+}
+
+SignalRecorder::~SignalRecorder()
+{
+	stop();
+}
+
+void SignalRecorder::set_sync_interval(double sync_interval)
+{
+	sync_interval_ = sync_interval;
+}
+
+void SignalRecorder::set_max_file_size(uint64_t max_file_size)
+{
+	max_file_size_ = max_file_size;
+}
+
+void SignalRecorder::set_max_file_duration(double max_file_duration)
+{
+	max_file_duration_ = max_file_duration;
+}
+
+bool SignalRecorder::start()
+{
+	if (record_thread_.joinable())
+		return false;
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		file_names_.clear();
+		error_.clear();
+		recorded_samples_ = 0;
+		signal_positions_.assign(signals_.size(), 0);
+		signals_cleared_.assign(signals_.size(), false);
+	}
+	string error;
+	if (!open_file(error)) {
+		qWarning() << "SignalRecorder:" << QString::fromStdString(error);
+		lock_guard<mutex> lock(mutex_);
+		error_ = error;
+		return false;
+	}
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = false;
+	}
+
+	// The connections are queued, so the slots are never running in the
+	// acquisition thread while the recorder is destroyed. The new samples
+	// are read by the record thread.
+	for (size_t i = 0; i < signals_.size(); ++i) {
+		connections_.push_back(connect(
+			signals_[i].get(), &AnalogBaseSignal::samples_cleared,
+			this, [this, i]() { on_samples_cleared(i); },
+			Qt::QueuedConnection));
+	}
+
+	record_thread_ = std::thread(&SignalRecorder::record_loop, this);
+	return true;
+}
+
+void SignalRecorder::stop()
+{
+	if (!record_thread_.joinable())
+		return;
+
+	for (const auto &connection : connections_)
+		disconnect(connection);
+	connections_.clear();
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	record_thread_.join();
+}
+
+bool SignalRecorder::is_running() const
+{
+	return record_thread_.joinable();
+}
+
+vector<string> SignalRecorder::file_names() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return file_names_;
+}
+
+uint64_t SignalRecorder::recorded_samples() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return recorded_samples_;
+}
+
+string SignalRecorder::error() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return error_;
+}
+
+void SignalRecorder::on_samples_cleared(size_t signal_index)
+{
+	lock_guard<mutex> lock(mutex_);
+	signals_cleared_[signal_index] = true;
+}
+
+void SignalRecorder::record_loop()
+{
+	using clock = std::chrono::steady_clock;
+	const auto sync_interval = std::chrono::duration_cast<clock::duration>(
+		std::chrono::duration<double>(sync_interval_));
+	const auto max_file_duration =
+		std::chrono::duration_cast<clock::duration>(
+			std::chrono::duration<double>(max_file_duration_));
+
+	auto file_start = clock::now();
+	auto last_sync = file_start;
+	bool stop = false;
+	while (!stop) {
+		{
+			unique_lock<mutex> lock(mutex_);
+			stop_cond_.wait_until(lock, last_sync + sync_interval,
+				[this]() { return stop_; });
+			stop = stop_;
+		}
+
+		string error;
+		if (!write_samples(error)) {
+			set_error(error);
+			return;
+		}
+
+		const auto now = clock::now();
+		if ((max_file_size_ > 0 && writer_.file_size() >= max_file_size_) ||
+				(max_file_duration_ > 0 &&
+					now - file_start >= max_file_duration)) {
+			// The signal ids are the same in every file.
+			if (!writer_.close()) {
+				set_error("Could not close file " + writer_.file_name());
+				return;
+			}
+			if (!open_file(error)) {
+				set_error(error);
+				return;
+			}
+			file_start = now;
+		}
+		else if (!writer_.sync()) {
+			set_error("Could not sync file " + writer_.file_name());
+			return;
+		}
+		last_sync = now;
+	}
+
+	if (!writer_.close())
+		set_error("Could not close file " + writer_.file_name());
+}
+
+bool SignalRecorder::write_samples(string &error)
+{
+	for (size_t i = 0; i < signals_.size(); ++i) {
+		const auto &signal = signals_[i];
+		size_t pos;
+		{
+			lock_guard<mutex> lock(mutex_);
+			if (signals_cleared_[i]) {
+				signal_positions_[i] = 0;
+				signals_cleared_[i] = false;
+			}
+			pos = signal_positions_[i];
+		}
+		// The signal was cleared, but the queued samples_cleared() hasn't
+		// arrived yet.
+		if (signal->sample_count() < pos)
+			pos = 0;
+
+		// The retained samples are only written, when the recording is
+		// started with old samples or has fallen behind. They are written
+		// with one sample per bucket.
+		uint64_t samples = 0;
+		while (true) {
+			const size_t count = signal->get_export_samples(pos,
+				signal->sample_count(), block_size_, timestamps_, values_,
+				false);
+			if (count == 0)
+				break;
+			if (!writer_.append_samples((uint32_t)i, timestamps_.data(),
+					values_.data(), count)) {
+				error = "Could not write to file " + writer_.file_name();
+				return false;
+			}
+			samples += count;
+		}
+
+		lock_guard<mutex> lock(mutex_);
+		signal_positions_[i] = pos;
+		recorded_samples_ += samples;
+	}
+
+	return true;
+}
+
+bool SignalRecorder::open_file(string &error)
+{
+	string base_name = file_name_;
+	const string suffix = ".svs";
+	if (base_name.size() >= suffix.size() &&
+			base_name.compare(base_name.size() - suffix.size(),
+				suffix.size(), suffix) == 0) {
+		base_name.erase(base_name.size() - suffix.size());
+	}
+
+	size_t file_number;
+	{
+		lock_guard<mutex> lock(mutex_);
+		file_number = file_names_.size() + 1;
+	}
+	char number[16];
+	std::snprintf(number, sizeof(number), "_%04zu", file_number);
+	const string file_name = base_name + number + suffix;
+
+	if (!writer_.open(file_name)) {
+		error = "Could not open file " + file_name;
+		return false;
+	}
+	for (const auto &signal : signals_)
+		writer_.add_signal(signal);
+	// Write the signal records right away, so the file is readable, even
+	// when there are no samples yet.
+	if (!writer_.sync()) {
+		error = "Could not write to file " + file_name;
+		return false;
+	}
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		file_names_.push_back(file_name);
+	}
+	Q_EMIT file_changed(QString::fromStdString(file_name));
+
+	return true;
+}
+
+void SignalRecorder::set_error(const string &error)
+{
+	qWarning() << "SignalRecorder:" << QString::fromStdString(error);
+	{
+		lock_guard<mutex> lock(mutex_);
+		error_ = error;
+	}
+	Q_EMIT recording_error(QString::fromStdString(error));
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,146 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SIGNALRECORDER_HPP
+#define DATA_SIGNALRECORDER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "src/data/sessionfile.hpp"
+
+using std::condition_variable;
+using std::mutex;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Record signals continuously to session files while they are acquired.
+ *
+ * A background thread reads the new samples of every signal with
+ * get_samples() once per sync interval, writes them to the file and syncs
+ * the file to disk, so only the samples since the last sync are lost on a
+ * crash. The recording is split into several files by size and time.
+ *
+ * The acquisition is never blocked by the disk, the signals keep all
+ * samples that are not yet written.
+ */
+class SignalRecorder : public QObject
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * @param signals The signals to record.
+	 * @param file_name The base file name. The number of the file is
+	 *                  appended (e.g. "soak_0001.svs").
+	 */
+	SignalRecorder(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &file_name);
+	~SignalRecorder();
+
+	/** Set the time between two syncs to disk in seconds. */
+	void set_sync_interval(double sync_interval);
+	/** Start a new file, when the file is larger. 0 disables the limit. */
+	void set_max_file_size(uint64_t max_file_size);
+	/**
+	 * Start a new file, after the given time in seconds. 0 disables the
+	 * limit.
+	 */
+	void set_max_file_duration(double max_file_duration);
+
+	/**
+	 * Start the recording. Samples that are already in a signal are
+	 * recorded, too.
+	 *
+	 * If the recording can't be started, false is returned and error() is
+	 * set, recording_error() is not emitted.
+	 */
+	bool start();
+	/** Stop the recording, write the remaining samples and close the file. */
+	void stop();
+	bool is_running() const;
+
+	/** The names of all files written so far. */
+	vector<string> file_names() const;
+	uint64_t recorded_samples() const;
+	string error() const;
+
+private:
+	void on_samples_cleared(size_t signal_index);
+	void record_loop();
+	/**
+	 * Write the new samples of all signals to the file. On failure the error
+	 * message is set.
+	 */
+	bool write_samples(string &error);
+	/** Open the next file. On failure the error message is set. */
+	bool open_file(string &error);
+	void set_error(const string &error);
+
+	/** The number of samples that are read from a signal at once. */
+	static constexpr size_t block_size_ = 65536;
+
+	const vector<shared_ptr<AnalogTimeSignal>> signals_;
+	const string file_name_;
+	double sync_interval_;
+	uint64_t max_file_size_;
+	double max_file_duration_;
+
+	SessionFileWriter writer_;
+	vector<string> file_names_;
+	/** The position of the next sample to write for every signal. */
+	vector<size_t> signal_positions_;
+	/** Signals that were cleared since the last write. */
+	vector<bool> signals_cleared_;
+	vector<double> timestamps_;
+	vector<double> values_;
+
+	mutable mutex mutex_;
+	condition_variable stop_cond_;
+	bool stop_;
+	uint64_t recorded_samples_;
+	string error_;
+	std::thread record_thread_;
+	vector<QMetaObject::Connection> connections_;
+
+Q_SIGNALS:
+	void file_changed(const QString &file_name);
+	void recording_error(const QString &error);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SIGNALRECORDER_HPP
@@ -0,0 +1,173 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "spectrum.hpp"
+
+using std::complex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+const double pi = std::acos(-1);
+}
+
+Spectrum::Spectrum(size_t fft_size) :
+	fft_size_(0),
+	max_frequency_(0.)
+{
+	set_fft_size(fft_size);
+}
+
+void Spectrum::set_fft_size(size_t fft_size)
+{
+	// Round up to the next power of 2.
+	size_t size = 2;
+	while (size < fft_size)
+		size <<= 1;
+	if (size == fft_size_)
+		return;
+	fft_size_ = size;
+
+	size_t bits = 0;
+	while (((size_t)1 << bits) < fft_size_)
+		++bits;
+
+	window_.resize(fft_size_);
+	twiddles_.resize(fft_size_ / 2);
+	bit_reverse_.resize(fft_size_);
+	for (size_t i = 0; i < fft_size_; ++i) {
+		// Hann window
+		window_[i] = 0.5 * (1. - std::cos(2. * pi * i / (fft_size_ - 1)));
+
+		size_t reversed = 0;
+		for (size_t b = 0; b < bits; ++b) {
+			if (i & ((size_t)1 << b))
+				reversed |= (size_t)1 << (bits - 1 - b);
+		}
+		bit_reverse_[i] = reversed;
+	}
+	for (size_t i = 0; i < fft_size_ / 2; ++i)
+		twiddles_[i] = std::polar(1., -2. * pi * i / fft_size_);
+
+	buffer_.resize(fft_size_);
+	magnitudes_db_.assign(fft_size_ / 2, -std::numeric_limits<double>::infinity());
+	values_.reserve(fft_size_);
+
+	clear();
+}
+
+size_t Spectrum::fft_size() const
+{
+	return fft_size_;
+}
+
+size_t Spectrum::bin_count() const
+{
+	return fft_size_ / 2;
+}
+
+void Spectrum::clear()
+{
+	values_.clear();
+	first_timestamp_ = 0.;
+	last_timestamp_ = 0.;
+}
+
+bool Spectrum::add_sample(double timestamp, double value)
+{
+	if (!std::isfinite(value))
+		value = 0.;
+
+	if (values_.empty())
+		first_timestamp_ = timestamp;
+	last_timestamp_ = timestamp;
+	values_.push_back(value);
+
+	if (values_.size() < fft_size_)
+		return false;
+
+	calculate();
+	values_.clear();
+	return true;
+}
+
+const vector<double> &Spectrum::magnitudes_db() const
+{
+	return magnitudes_db_;
+}
+
+double Spectrum::max_frequency() const
+{
+	return max_frequency_;
+}
+
+void Spectrum::calculate()
+{
+	// Remove the DC part, it would dominate the spectrum.
+	double mean = 0.;
+	for (const double value : values_)
+		mean += value;
+	mean /= (double)fft_size_;
+
+	for (size_t i = 0; i < fft_size_; ++i) {
+		buffer_[bit_reverse_[i]] =
+			complex<double>((values_[i] - mean) * window_[i], 0.);
+	}
+
+	// Iterative radix-2 FFT
+	for (size_t len = 2; len <= fft_size_; len <<= 1) {
+		const size_t half = len / 2;
+		const size_t twiddle_step = fft_size_ / len;
+		for (size_t start = 0; start < fft_size_; start += len) {
+			for (size_t k = 0; k < half; ++k) {
+				const complex<double> t =
+					twiddles_[k * twiddle_step] * buffer_[start + k + half];
+				const complex<double> u = buffer_[start + k];
+				buffer_[start + k] = u + t;
+				buffer_[start + k + half] = u - t;
+			}
+		}
+	}
+
+	// Single sided amplitude spectrum, corrected by the coherent gain of the
+	// Hann window (0.5).
+	const double scale = 4. / (double)fft_size_;
+	for (size_t i = 0; i < fft_size_ / 2; ++i) {
+		const double magnitude = std::abs(buffer_[i]) * scale;
+		magnitudes_db_[i] = 20. * std::log10(
+			magnitude + std::numeric_limits<double>::min());
+	}
+
+	const double duration = last_timestamp_ - first_timestamp_;
+	if (duration > 0.) {
+		const double samplerate = (double)(fft_size_ - 1) / duration;
+		max_frequency_ = samplerate / 2.;
+	}
+}
+
+} // namespace data
+} // namespace sv
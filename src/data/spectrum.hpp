@@ -0,0 +1,100 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SPECTRUM_HPP
+#define DATA_SPECTRUM_HPP
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+using std::complex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * Calculates successive magnitude spectra of a stream of samples.
+ *
+ * The samples are collected until fft_size samples are available, then the
+ * spectrum of these samples is calculated (with a Hann window and the mean
+ * value removed) and a new block of samples is started. Every sample is only
+ * processed once and the window coefficients, the twiddle factors and the bit
+ * reversal table are calculated only when the FFT size changes.
+ *
+ * The samples don't need to have an exact samplerate; the samplerate of a
+ * spectrum is calculated from the timestamps of its first and last sample.
+ */
+class Spectrum
+{
+
+public:
+	/**
+	 * @param fft_size The size of the FFT. Must be a power of 2.
+	 */
+	explicit Spectrum(size_t fft_size = 8192);
+
+	/**
+	 * Set a new FFT size. Must be a power of 2. The collected samples are
+	 * discarded.
+	 */
+	void set_fft_size(size_t fft_size);
+	size_t fft_size() const;
+	/** Return the number of frequency bins (fft_size / 2). */
+	size_t bin_count() const;
+
+	/**
+	 * Discard all collected samples.
+	 */
+	void clear();
+
+	/**
+	 * Add a sample. Return true, when a new spectrum has been calculated.
+	 */
+	bool add_sample(double timestamp, double value);
+
+	/**
+	 * Return the magnitudes of the last spectrum in dB, with bin_count()
+	 * entries.
+	 */
+	const vector<double> &magnitudes_db() const;
+	/** Return the frequency of the last bin of the last spectrum. */
+	double max_frequency() const;
+
+private:
+	void calculate();
+
+	size_t fft_size_;
+	vector<double> window_;
+	vector<complex<double>> twiddles_;
+	vector<size_t> bit_reverse_;
+	vector<complex<double>> buffer_;
+	vector<double> values_;
+	double first_timestamp_;
+	double last_timestamp_;
+	vector<double> magnitudes_db_;
+	double max_frequency_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SPECTRUM_HPP
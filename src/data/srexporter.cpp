@@ -0,0 +1,268 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <glibmm.h>
+#include <libsigrokcxx/libsigrokcxx.hpp>
+
+#include <QDebug>
+#include <QString>
+
+#include "srexporter.hpp"
+#include "config.h"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+
+using std::map;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+SrExporter::SrExporter(shared_ptr<sigrok::Context> sr_context,
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &file_name) :
+	BaseExporter(signals, file_name),
+	sr_context_(sr_context),
+	samplerate_(0)
+{
+}
+
+SrExporter::~SrExporter()
+{
+	wait();
+}
+
+void SrExporter::set_samplerate(uint64_t samplerate)
+{
+	samplerate_ = samplerate;
+}
+
+uint64_t SrExporter::samplerate() const
+{
+	return samplerate_;
+}
+
+bool SrExporter::export_file()
+{
+	// sigrok::Error is a std::exception and is handled by BaseExporter.
+	try {
+		return export_signals();
+	}
+	catch (Glib::Error &e) {
+		error_ = e.what();
+		return false;
+	}
+}
+
+bool SrExporter::export_signals()
+{
+	const auto output_formats = sr_context_->output_formats();
+	if (output_formats.count("srzip") == 0) {
+		error_ = "The libsigrok output module \"srzip\" is not available";
+		return false;
+	}
+
+	// The sigrok device for the output module, with one analog channel per
+	// signal.
+	auto sr_device = sr_context_->create_user_device(
+		"SmuView", "Export", SV_VERSION_STRING);
+	vector<SampleCursor> cursors;
+	vector<shared_ptr<sigrok::Channel>> sr_channels;
+	vector<const sigrok::Quantity *> sr_quantities;
+	vector<const sigrok::Unit *> sr_units;
+	vector<vector<const sigrok::QuantityFlag *>> sr_quantity_flags;
+	set<string> channel_names;
+	double start_timestamp = std::numeric_limits<double>::max();
+	double end_timestamp = std::numeric_limits<double>::lowest();
+	for (const auto &signal : signals_) {
+		const size_t count = signal->sample_count();
+		if (count == 0)
+			continue;
+		if (!datautil::is_valid_sr_quantity(signal->quantity())) {
+			qWarning() << "SrExporter::export_signals(): Skipping signal" <<
+				signal->display_name() << "with an unknown quantity";
+			continue;
+		}
+
+		// Channel names must be unique.
+		string name = signal->name();
+		for (int i = 2; channel_names.count(name) > 0; ++i)
+			name = signal->name() + " (" + std::to_string(i) + ")";
+		channel_names.insert(name);
+
+		sr_channels.push_back(sr_device->add_channel(
+			(unsigned int)sr_channels.size(), sigrok::ChannelType::ANALOG,
+			name));
+		sr_quantities.push_back(sigrok::Quantity::get(
+			datautil::get_sr_quantity_id(signal->quantity())));
+		// libsigrok has no unknown unit, export those signals as unitless.
+		const uint32_t sr_unit_id = datautil::get_sr_unit_id(signal->unit());
+		if (sr_unit_id > 0)
+			sr_units.push_back(sigrok::Unit::get(sr_unit_id));
+		else
+			sr_units.push_back(sigrok::Unit::UNITLESS);
+		sr_quantity_flags.push_back(sigrok::QuantityFlag::flags_from_mask(
+			(unsigned int)datautil::get_sr_quantity_flags_id(
+				signal->quantity_flags())));
+
+		SampleCursor cursor;
+		cursor.signal = signal;
+		cursor.count = count;
+		cursor.pos = 0;
+		cursor.block_start = 0;
+		signal->get_samples(0, std::min(block_size_, count),
+			cursor.timestamps, cursor.values, false);
+		start_timestamp = std::min(start_timestamp, cursor.timestamps.front());
+		end_timestamp = std::max(end_timestamp, signal->last_timestamp(false));
+		cursors.push_back(std::move(cursor));
+	}
+	if (cursors.empty()) {
+		error_ = "No signals to export";
+		return false;
+	}
+
+	if (samplerate_ == 0)
+		samplerate_ = calc_samplerate();
+	const double sample_count =
+		std::floor((end_timestamp - start_timestamp) * samplerate_);
+	if (!(sample_count < max_sample_count_)) {
+		error_ = "The export would have more than " +
+			std::to_string(max_sample_count_) + " samples per channel at " +
+			std::to_string(samplerate_) + " Hz. Please set a lower samplerate.";
+		return false;
+	}
+	const uint64_t total_sample_count = 1 + (uint64_t)sample_count;
+
+	auto output = output_formats.at("srzip")->create_output(
+		file_name_, sr_device);
+
+	output->receive(sr_context_->create_header_packet(
+		Glib::DateTime::create_now_local((gint64)start_timestamp)));
+	map<const sigrok::ConfigKey *, Glib::VariantBase> meta;
+	meta[sigrok::ConfigKey::SAMPLERATE] =
+		Glib::Variant<guint64>::create(samplerate_);
+	output->receive(sr_context_->create_meta_packet(meta));
+
+	// Resample all signals to the common time base, one block per packet
+	// and channel (the srzip module only accepts one channel per packet).
+	vector<float> data(block_size_);
+	uint64_t sample_pos = 0;
+	while (sample_pos < total_sample_count) {
+		const size_t count = (size_t)std::min(
+			(uint64_t)block_size_, total_sample_count - sample_pos);
+		for (size_t i = 0; i < cursors.size(); ++i) {
+			auto &cursor = cursors[i];
+			for (size_t j = 0; j < count; ++j) {
+				const double timestamp = start_timestamp +
+					(double)(sample_pos + j) / samplerate_;
+				while (cursor.pos + 1 < cursor.count &&
+						sample_timestamp(cursor, cursor.pos + 1) <= timestamp)
+					next_sample(cursor);
+
+				// No value before the first sample of the signal
+				if (sample_timestamp(cursor, cursor.pos) > timestamp)
+					data[j] = std::numeric_limits<float>::quiet_NaN();
+				else
+					data[j] = (float)sample_value(cursor);
+			}
+
+			output->receive(sr_context_->create_analog_packet(
+				vector<shared_ptr<sigrok::Channel>> { sr_channels[i] },
+				data.data(), (unsigned int)count, sr_quantities[i],
+				sr_units[i], sr_quantity_flags[i]));
+		}
+
+		sample_pos += count;
+		if (!update_progress(sample_pos, total_sample_count))
+			return false;
+	}
+
+	output->receive(sr_context_->create_end_packet());
+	return true;
+}
+
+uint64_t SrExporter::calc_samplerate() const
+{
+	// Use the median of the first time deltas, so that single gaps or
+	// bursts don't matter.
+	double min_delta = std::numeric_limits<double>::max();
+	vector<double> timestamps;
+	vector<double> values;
+	vector<double> deltas;
+	for (const auto &signal : signals_) {
+		signal->get_samples(0, 1001, timestamps, values, false);
+		deltas.clear();
+		for (size_t i = 1; i < timestamps.size(); ++i) {
+			if (timestamps[i] > timestamps[i - 1])
+				deltas.push_back(timestamps[i] - timestamps[i - 1]);
+		}
+		if (deltas.empty())
+			continue;
+		auto median = deltas.begin() + deltas.size() / 2;
+		std::nth_element(deltas.begin(), median, deltas.end());
+		min_delta = std::min(min_delta, *median);
+	}
+
+	if (min_delta == std::numeric_limits<double>::max())
+		return 1;
+	return std::max((uint64_t)1, (uint64_t)std::ceil(1 / min_delta));
+}
+
+void SrExporter::next_sample(SampleCursor &cursor)
+{
+	++cursor.pos;
+	if (cursor.pos >= cursor.count ||
+			cursor.pos - cursor.block_start < cursor.timestamps.size())
+		return;
+
+	cursor.block_start = cursor.pos;
+	cursor.signal->get_samples(cursor.pos,
+		std::min(block_size_, cursor.count - cursor.pos),
+		cursor.timestamps, cursor.values, false);
+}
+
+double SrExporter::sample_timestamp(const SampleCursor &cursor,
+	size_t pos) const
+{
+	// The next sample may not be in the current block.
+	if (pos - cursor.block_start < cursor.timestamps.size())
+		return cursor.timestamps[pos - cursor.block_start];
+	return cursor.signal->get_sample(pos, false).first;
+}
+
+double SrExporter::sample_value(const SampleCursor &cursor) const
+{
+	return cursor.values[cursor.pos - cursor.block_start];
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,107 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SREXPORTER_HPP
+#define DATA_SREXPORTER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/data/baseexporter.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sigrok {
+class Context;
+}
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Export analog time signals into a sigrok session file (*.sr), that can be
+ * opened with PulseView and sigrok-cli.
+ *
+ * The file is written with the libsigrok "srzip" output module. Sigrok
+ * sessions have one samplerate for all channels, so the signals are
+ * resampled to a common time base (the last value of a signal is held until
+ * the next sample). The export runs in its own thread and reads the signals
+ * block wise, so the memory usage doesn't depend on the size of the signals.
+ */
+class SrExporter : public BaseExporter
+{
+	Q_OBJECT
+
+public:
+	SrExporter(shared_ptr<sigrok::Context> sr_context,
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &file_name);
+	~SrExporter();
+
+	/**
+	 * Set the samplerate of the exported session in Hz. If the samplerate
+	 * is 0 (default), it is calculated from the median time between two
+	 * samples of the fastest signal.
+	 */
+	void set_samplerate(uint64_t samplerate);
+	uint64_t samplerate() const;
+
+protected:
+	bool export_file() override;
+
+private:
+	/** A cursor that reads the samples of a signal block wise. */
+	struct SampleCursor {
+		shared_ptr<AnalogTimeSignal> signal;
+		size_t count;
+		size_t pos;
+		size_t block_start;
+		vector<double> timestamps;
+		vector<double> values;
+	};
+
+	bool export_signals();
+	uint64_t calc_samplerate() const;
+	void next_sample(SampleCursor &cursor);
+	double sample_timestamp(const SampleCursor &cursor, size_t pos) const;
+	double sample_value(const SampleCursor &cursor) const;
+
+	shared_ptr<sigrok::Context> sr_context_;
+	uint64_t samplerate_;
+
+	/** Number of samples that are read from a signal or sent at once. */
+	static constexpr size_t block_size_ = 65536;
+	/**
+	 * The max. number of samples per channel. Exports with more samples are
+	 * refused, a wrong samplerate or timestamp could fill the disk.
+	 */
+	static constexpr uint64_t max_sample_count_ = 100000000;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SREXPORTER_HPP
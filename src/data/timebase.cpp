@@ -0,0 +1,196 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "timebase.hpp"
+#include "src/data/compressedsamples.hpp"
+
+using std::lock_guard;
+using std::recursive_mutex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+const size_t npos = std::numeric_limits<size_t>::max();
+
+} // namespace
+
+Timebase::Timebase() :
+	first_index_(0),
+	compression_enabled_(true)
+{
+}
+
+size_t Timebase::append(double timestamp)
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	const size_t index = size();
+	timestamps_.push_back(timestamp);
+	compress_cold_timestamps();
+	return index;
+}
+
+size_t Timebase::append(const double *timestamps, size_t count)
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	const size_t index = size();
+	timestamps_.insert(timestamps_.end(), timestamps, timestamps + count);
+	compress_cold_timestamps();
+	return index;
+}
+
+size_t Timebase::append(double timestamp, double stride, size_t count)
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	const size_t index = size();
+	timestamps_.reserve(timestamps_.size() + count);
+	for (size_t i = 0; i < count; ++i) {
+		timestamps_.push_back(timestamp);
+		timestamp += stride;
+	}
+	compress_cold_timestamps();
+	return index;
+}
+
+size_t Timebase::size() const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	return first_index_ + compressed_timestamps_.sample_count() +
+		timestamps_.size();
+}
+
+double Timebase::timestamp(size_t index) const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	const size_t compressed_end =
+		first_index_ + compressed_timestamps_.sample_count();
+	if (index < compressed_end)
+		return compressed_timestamps_.timestamp(index - first_index_);
+	return timestamps_[index - compressed_end];
+}
+
+void Timebase::copy(size_t index, size_t count, double *timestamps) const
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	const size_t compressed_end =
+		first_index_ + compressed_timestamps_.sample_count();
+	size_t copied = 0;
+	if (index < compressed_end) {
+		copied = compressed_timestamps_.copy(
+			index - first_index_, count, timestamps, nullptr);
+	}
+	if (copied < count) {
+		const size_t hot_index = index + copied - compressed_end;
+		std::copy(timestamps_.begin() + hot_index,
+			timestamps_.begin() + hot_index + (count - copied),
+			timestamps + copied);
+	}
+}
+
+void Timebase::set_compression_enabled(bool enabled)
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	compression_enabled_ = enabled;
+}
+
+size_t Timebase::attach()
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	// Reuse the handle of a detached user.
+	for (size_t handle = 0; handle < released_indices_.size(); ++handle) {
+		if (released_indices_[handle] == npos) {
+			released_indices_[handle] = first_index_;
+			return handle;
+		}
+	}
+	released_indices_.push_back(first_index_);
+	return released_indices_.size() - 1;
+}
+
+void Timebase::detach(size_t handle)
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	released_indices_[handle] = npos;
+	drop_released_timestamps();
+}
+
+void Timebase::release(size_t handle, size_t index)
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+	released_indices_[handle] = index;
+	drop_released_timestamps();
+}
+
+void Timebase::compress_cold_timestamps()
+{
+	if (!compression_enabled_)
+		return;
+
+	size_t count = 0;
+	while (timestamps_.size() - count >=
+			hot_timestamp_count_ + compression_block_size_) {
+		compressed_timestamps_.append_block(
+			timestamps_.data() + count, nullptr, compression_block_size_);
+		count += compression_block_size_;
+	}
+	if (count == 0)
+		return;
+
+	timestamps_.erase(timestamps_.begin(), timestamps_.begin() + count);
+}
+
+void Timebase::drop_released_timestamps()
+{
+	if (released_indices_.empty())
+		return;
+	// Without users, no timestamps are needed anymore.
+	size_t released_index = *std::min_element(
+		released_indices_.begin(), released_indices_.end());
+	if (released_index == npos)
+		released_index = size();
+
+	vector<double> timestamps;
+	vector<double> values;
+	while (compressed_timestamps_.block_count() > 0) {
+		const size_t block_end = first_index_ +
+			compressed_timestamps_.first_block_sample_count();
+		if (block_end > released_index)
+			return;
+		compressed_timestamps_.take_first_block(timestamps, values);
+		first_index_ = block_end;
+	}
+
+	// The hot timestamps follow the compressed timestamps.
+	if (released_index > first_index_) {
+		const size_t count =
+			std::min(released_index - first_index_, timestamps_.size());
+		timestamps_.erase(timestamps_.begin(), timestamps_.begin() + count);
+		first_index_ += count;
+	}
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,118 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_TIMEBASE_HPP
+#define DATA_TIMEBASE_HPP
+
+#include <mutex>
+#include <vector>
+
+#include "src/data/compressedsamples.hpp"
+
+using std::recursive_mutex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * The timestamps of one or more signals.
+ *
+ * Signals of channels, that are sampled together (e.g. the channels of a
+ * multi-channel packet), share one timebase. Every signal maps its sample
+ * positions to indices of the timebase and stores only its values.
+ *
+ * The older timestamps are stored compressed. Signals, that don't need the
+ * timestamps before an index anymore (see AnalogTimeSignal retention
+ * policy), release them, so the timebase can drop them when all attached
+ * signals have released them.
+ *
+ * All methods are thread safe, the signals of a timebase can be read while
+ * the acquisition appends new timestamps.
+ */
+class Timebase
+{
+
+public:
+	Timebase();
+
+	/**
+	 * Append a single timestamp.
+	 *
+	 * @return The index of the timestamp.
+	 */
+	size_t append(double timestamp);
+	/**
+	 * Append count timestamps.
+	 *
+	 * @return The index of the first timestamp.
+	 */
+	size_t append(const double *timestamps, size_t count);
+	/**
+	 * Append count equidistant timestamps, starting at timestamp.
+	 *
+	 * @return The index of the first timestamp.
+	 */
+	size_t append(double timestamp, double stride, size_t count);
+
+	/** The index after the last timestamp. */
+	size_t size() const;
+	double timestamp(size_t index) const;
+	void copy(size_t index, size_t count, double *timestamps) const;
+
+	/**
+	 * Enable or disable the compression of the older timestamps. Already
+	 * compressed timestamps stay compressed when disabling the compression.
+	 */
+	void set_compression_enabled(bool enabled);
+
+	/**
+	 * Register a user of the timebase.
+	 *
+	 * @return The handle for release() and detach().
+	 */
+	size_t attach();
+	void detach(size_t handle);
+	/** The user doesn't need the timestamps before index anymore. */
+	void release(size_t handle, size_t index);
+
+private:
+	void compress_cold_timestamps();
+	void drop_released_timestamps();
+
+	/** The index of the first available (not dropped) timestamp. */
+	size_t first_index_;
+	CompressedSamples compressed_timestamps_;
+	vector<double> timestamps_;
+	bool compression_enabled_;
+	/** The released index of every user, or npos for detached users. */
+	vector<size_t> released_indices_;
+	mutable recursive_mutex mutex_;
+
+	/** The number of timestamps, that are compressed together. */
+	static const size_t compression_block_size_ = 4096;
+	/** The number of newest timestamps, that are never compressed. */
+	static const size_t hot_timestamp_count_ = 65536;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_TIMEBASE_HPP
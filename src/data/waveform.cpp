@@ -0,0 +1,201 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "waveform.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+const double pi = std::acos(-1);
+}
+
+Waveform::Waveform() :
+	type_(WaveformType::Sine),
+	amplitude_(1.),
+	offset_(0.),
+	periode_(1.),
+	phi_(0.),
+	interval_(.1)
+{
+}
+
+void Waveform::set_type(WaveformType type)
+{
+	type_ = type;
+}
+
+WaveformType Waveform::type() const
+{
+	return type_;
+}
+
+void Waveform::set_amplitude(double amplitude)
+{
+	amplitude_ = amplitude;
+}
+
+double Waveform::amplitude() const
+{
+	return amplitude_;
+}
+
+void Waveform::set_offset(double offset)
+{
+	offset_ = offset;
+}
+
+double Waveform::offset() const
+{
+	return offset_;
+}
+
+void Waveform::set_periode(double periode)
+{
+	periode_ = periode;
+}
+
+double Waveform::periode() const
+{
+	return periode_;
+}
+
+void Waveform::set_phase(double phi)
+{
+	phi_ = phi;
+}
+
+double Waveform::phase() const
+{
+	return phi_;
+}
+
+void Waveform::set_interval(double interval)
+{
+	interval_ = interval;
+}
+
+double Waveform::interval() const
+{
+	return interval_;
+}
+
+void Waveform::set_points(const vector<double> &times,
+	const vector<double> &values)
+{
+	assert(times.size() == values.size());
+
+	point_times_ = times;
+	point_values_ = values;
+	point_values_.resize(point_times_.size());
+}
+
+vector<double> Waveform::point_times() const
+{
+	return point_times_;
+}
+
+vector<double> Waveform::point_values() const
+{
+	return point_values_;
+}
+
+uint64_t Waveform::sample_count() const
+{
+	if (interval_ <= 0 || periode_ <= 0)
+		return 0;
+	return (uint64_t)std::floor(periode_ / interval_);
+}
+
+double Waveform::sample_value(uint64_t sample) const
+{
+	// Every periode starts at t = 0, so the time doesn't lose precision
+	// for long running waveforms.
+	const uint64_t count = sample_count();
+	if (count == 0)
+		return offset_;
+	return value((double)(sample % count) * interval_);
+}
+
+double Waveform::value(double t) const
+{
+	if (type_ == WaveformType::Arbitrary) {
+		if (point_times_.empty())
+			return offset_;
+		if (point_times_.size() == 1)
+			return point_values_[0];
+
+		// Find the two points around t. The last point is connected to the
+		// first point of the next periode.
+		const auto it = std::upper_bound(
+			point_times_.begin(), point_times_.end(), t);
+		double t0, t1, v0, v1;
+		if (it == point_times_.begin()) {
+			t0 = point_times_.back() - periode_;
+			v0 = point_values_.back();
+			t1 = point_times_.front();
+			v1 = point_values_.front();
+		}
+		else if (it == point_times_.end()) {
+			t0 = point_times_.back();
+			v0 = point_values_.back();
+			t1 = point_times_.front() + periode_;
+			v1 = point_values_.front();
+		}
+		else {
+			const size_t pos = it - point_times_.begin();
+			t0 = point_times_[pos-1];
+			v0 = point_values_[pos-1];
+			t1 = point_times_[pos];
+			v1 = point_values_[pos];
+		}
+		if (t1 <= t0)
+			return v0;
+		return v0 + (v1 - v0) * (t - t0) / (t1 - t0);
+	}
+
+	const double x = 2 * pi * t / periode_ + phi_;
+	double value;
+	if (type_ == WaveformType::Sine)
+		value = std::sin(x);
+	else if (type_ == WaveformType::Square)
+		value = std::sin(x) < 0 ? -1 : 1;
+	else if (type_ == WaveformType::Triangle)
+		value = (std::asin(std::sin(x))) / (pi/2);
+	else if (type_ == WaveformType::Sawtooth)
+		// y = −arctan(cotan(x))
+		value = -1 * std::atan(1 / std::tan(x)) / (pi/2);
+	else if (type_ == WaveformType::SawtoothInv)
+		value = std::atan(1 / std::tan(x)) / (pi/2);
+	else
+		value = 0;
+
+	return (amplitude_ * value) + offset_;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,103 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_WAVEFORM_HPP
+#define DATA_WAVEFORM_HPP
+
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+enum class WaveformType {
+	Sine,
+	Square,
+	Triangle,
+	Sawtooth,
+	SawtoothInv,
+	/** Linear interpolation between arbitrary points. */
+	Arbitrary,
+};
+
+/**
+ * A periodic waveform that is evaluated on demand for every sample.
+ *
+ * Unlike a table of values, the waveform only stores its parameters (and
+ * the points of an arbitrary waveform), so the memory usage doesn't depend
+ * on the number of samples.
+ */
+class Waveform
+{
+
+public:
+	Waveform();
+
+	void set_type(WaveformType type);
+	WaveformType type() const;
+	void set_amplitude(double amplitude);
+	double amplitude() const;
+	void set_offset(double offset);
+	double offset() const;
+	void set_periode(double periode);
+	double periode() const;
+	/** The phase offset in rad. */
+	void set_phase(double phi);
+	double phase() const;
+	/** Time between two samples in s. */
+	void set_interval(double interval);
+	double interval() const;
+
+	/**
+	 * Set the points of an arbitrary waveform. The times are relative to the
+	 * start of the periode and must be in ascending order. The last point
+	 * is connected to the first point of the next periode.
+	 */
+	void set_points(const vector<double> &times, const vector<double> &values);
+	vector<double> point_times() const;
+	vector<double> point_values() const;
+
+	/** The number of samples per periode. */
+	uint64_t sample_count() const;
+	/**
+	 * Return the value of the given sample. The sample is counted from
+	 * the start of the first periode and can be greater than sample_count().
+	 */
+	double sample_value(uint64_t sample) const;
+	/** Return the value at time t (in s) within a periode. */
+	double value(double t) const;
+
+private:
+	WaveformType type_;
+	double amplitude_;
+	double offset_;
+	double periode_;
+	double phi_;
+	double interval_;
+	vector<double> point_times_;
+	vector<double> point_values_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_WAVEFORM_HPP
@@ -39,6 +39,7 @@
 #include "src/session.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/hardwarechannel.hpp"
+#include "src/data/timebase.hpp"
 #include "src/data/properties/uint64property.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
@@ -59,7 +60,9 @@ namespace devices {
 HardwareDevice::HardwareDevice(
 		const shared_ptr<sigrok::Context> sr_context,
 		shared_ptr<sigrok::HardwareDevice> sr_device) :
-	BaseDevice(sr_context, sr_device)
+	BaseDevice(sr_context, sr_device),
+	frame_timebase_index_(0),
+	frame_timebase_count_(0)
 {
 	// Set options for different device types
 	// TODO: Multiple DeviceTypes per HardwareDevice
@@ -240,6 +243,7 @@ void HardwareDevice::feed_in_frame_begin()
 {
 	// TODO: use std::chrono / std::time
 	frame_start_timestamp_ = QDateTime::currentMSecsSinceEpoch() / (double)1000;
+	frame_timebase_count_ = 0;
 	frame_began_ = true;
 }
 
@@ -271,6 +275,44 @@ void HardwareDevice::feed_in_analog(shared_ptr<sigrok::Analog> sr_analog)
 	sr_analog->get_data_as_float(data.get());
 	float *channel_data = data.get();
 
+	// The timestamps are stored once for all channels of the packet (and
+	// for all packets of a frame), the signals only store their values.
+	shared_ptr<data::Timebase> timebase;
+	size_t timebase_index;
+	if (frame_began_ && frame_timebase_count_ == num_samples) {
+		timebase = frame_timebase_;
+		timebase_index = frame_timebase_index_;
+	}
+	else {
+		// TODO: use std::chrono / std::time
+		double timestamp;
+		if (frame_began_)
+			timestamp = frame_start_timestamp_;
+		else
+			timestamp = QDateTime::currentMSecsSinceEpoch() / (double)1000;
+		double time_stride = 0.;
+		if (samplerate > 0)
+			time_stride = 1 / (double)samplerate;
+
+		if (frame_began_) {
+			if (!frame_timebase_)
+				frame_timebase_ = make_shared<data::Timebase>();
+			timebase = frame_timebase_;
+		}
+		else {
+			auto &channels_timebase = timebases_[sr_channels];
+			if (!channels_timebase)
+				channels_timebase = make_shared<data::Timebase>();
+			timebase = channels_timebase;
+		}
+		timebase_index = timebase->append(timestamp, time_stride, num_samples);
+
+		if (frame_began_) {
+			frame_timebase_index_ = timebase_index;
+			frame_timebase_count_ = num_samples;
+		}
+	}
+
 	for (const auto &sr_channel : sr_channels) {
 		/*
 		qWarning() << "HardwareDevice::feed_in_analog(): HardwareDevice = " <<
@@ -285,16 +327,8 @@ void HardwareDevice::feed_in_analog(shared_ptr<sigrok::Analog> sr_analog)
 		auto channel = static_pointer_cast<channels::HardwareChannel>(
 			sr_channel_map_[sr_channel]);
 
-		// TODO: use std::chrono / std::time
-		double timestamp;
-		if (frame_began_)
-			timestamp = frame_start_timestamp_;
-		else
-			timestamp = QDateTime::currentMSecsSinceEpoch() / (double)1000;
-
-		//channel->push_sample_sr_analog(channel_data++, timestamp, sr_analog);
 		channel->push_interleaved_samples(channel_data++, num_samples,
-			sr_channels.size(), timestamp, samplerate, sr_analog);
+			sr_channels.size(), timebase, timebase_index, sr_analog);
 	}
 }
 
@@ -25,6 +25,7 @@
 #include <mutex>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
@@ -50,6 +51,7 @@ using std::set;
 using std::shared_ptr;
 using std::string;
 using std::unordered_set;
+using std::vector;
 
 namespace sigrok {
 class Channel;
@@ -65,6 +67,7 @@ namespace channels {
 class BaseChannel;
 }
 namespace data {
+class Timebase;
 namespace properties {
 class UInt64Property;
 }
@@ -117,6 +120,16 @@ protected:
 
 private:
 	double frame_start_timestamp_;
+	/**
+	 * The timebase for the packets of a frame. All packets of a frame with
+	 * the same number of samples share the same timestamps.
+	 */
+	shared_ptr<data::Timebase> frame_timebase_;
+	size_t frame_timebase_index_;
+	size_t frame_timebase_count_;
+	/** The timebases for packets outside of frames, per set of channels. */
+	map<vector<shared_ptr<sigrok::Channel>>, shared_ptr<data::Timebase>>
+		timebases_;
 	uint64_t cur_samplerate_;
 	shared_ptr<data::properties::UInt64Property> samplerate_prop_;
 
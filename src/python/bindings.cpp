@@ -17,11 +17,15 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <pybind11/embed.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 
 #include "bindings.hpp"
@@ -34,6 +38,7 @@
 #include "src/data/analogsamplesignal.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/csvimporter.hpp"
 #include "src/data/datautil.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
@@ -41,9 +46,15 @@
 #include "src/devices/hardwaredevice.hpp"
 #include "src/devices/userdevice.hpp"
 #include "src/python/pystreambuf.hpp"
+#include "src/python/signalsubscription.hpp"
 #include "src/python/uiproxy.hpp"
 
+using std::dynamic_pointer_cast;
+using std::make_pair;
+using std::make_shared;
 using std::set;
+using std::shared_ptr;
+using std::string;
 
 using namespace pybind11::literals; // for the ""_a
 namespace py = pybind11;
@@ -118,6 +129,7 @@ void init_Session(py::module &m)
 		"    A Dict where the key is the device id and the value is the device object.");
 	py_session.def("connect_device", &sv::Session::connect_device,
 		py::arg("conn_str"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Connect a new device. For some devices (like DMMs) you may want to "
 		"wait a fixed time, until the first sample has arrived and an `AnalogSignal` "
 		"object has been created. Example:\n"
@@ -145,6 +157,7 @@ void init_Session(py::module &m)
 		"    The created user device object.");
 	py_session.def("remove_device", &sv::Session::remove_device,
 		py::arg("device"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Close a device and remove it from the session. This will also delete all aquired data!\n\n"
 		"Parameters\n"
 		"-------\n"
@@ -202,6 +215,95 @@ void init_Device(py::module &m)
 	py_user_device.doc() = "An user generated (virtual) device for storing custom data and showing a custom tab.";
 }
 
+namespace {
+
+typedef py::array_t<double, py::array::c_style | py::array::forcecast>
+	sample_array_t;
+
+void check_sample_array(const sample_array_t &array, const char *name)
+{
+	if (array.ndim() != 1)
+		throw py::value_error(string(name) + " must be a one-dimensional array");
+}
+
+/**
+ * The first new timestamp must not be NaN and not before the last timestamp
+ * of the signal (if any).
+ */
+void check_first_timestamp(double timestamp,
+	const sv::data::AnalogTimeSignal *signal)
+{
+	if (std::isnan(timestamp))
+		throw py::value_error("timestamps must not be NaN");
+	if (signal && signal->sample_count() > 0 &&
+			timestamp < signal->last_timestamp(false))
+		throw py::value_error(
+			"timestamps must not be before the last timestamp of the signal");
+}
+
+void check_sample_arrays(const sample_array_t &timestamps,
+	const sample_array_t &values, const sv::data::AnalogTimeSignal *signal)
+{
+	check_sample_array(timestamps, "timestamps");
+	check_sample_array(values, "values");
+	if (timestamps.size() != values.size())
+		throw py::value_error("timestamps and values must have the same size");
+	if (timestamps.size() == 0)
+		return;
+
+	const double *ts = timestamps.data();
+	check_first_timestamp(ts[0], signal);
+	for (py::ssize_t i = 1; i < timestamps.size(); ++i) {
+		// NaN fails every comparison
+		if (!(ts[i] >= ts[i-1])) {
+			if (std::isnan(ts[i]))
+				throw py::value_error("timestamps must not be NaN");
+			throw py::value_error("timestamps must be in ascending order");
+		}
+	}
+}
+
+/** The signal of the user channel, the samples will be pushed to (if any). */
+shared_ptr<sv::data::AnalogTimeSignal> user_channel_signal(
+	sv::channels::UserChannel &channel, sv::data::Quantity quantity,
+	const set<sv::data::QuantityFlag> &quantity_flags)
+{
+	const auto signal_map = channel.signal_map();
+	const auto it = signal_map.find(make_pair(quantity, quantity_flags));
+	if (it == signal_map.end() || it->second.empty())
+		return nullptr;
+	return dynamic_pointer_cast<sv::data::AnalogTimeSignal>(it->second[0]);
+}
+
+void user_channel_push_samples(sv::channels::UserChannel &channel,
+	const sample_array_t &timestamps, const sample_array_t &values,
+	sv::data::Quantity quantity, set<sv::data::QuantityFlag> quantity_flags,
+	sv::data::Unit unit, int digits, int decimal_places)
+{
+	check_sample_arrays(timestamps, values,
+		user_channel_signal(channel, quantity, quantity_flags).get());
+	py::gil_scoped_release release;
+	channel.push_samples(timestamps.data(), values.data(), values.size(),
+		quantity, quantity_flags, unit, digits, decimal_places);
+}
+
+void user_channel_push_samples_samplerate(sv::channels::UserChannel &channel,
+	const sample_array_t &values, double timestamp, uint64_t samplerate,
+	sv::data::Quantity quantity, set<sv::data::QuantityFlag> quantity_flags,
+	sv::data::Unit unit, int digits, int decimal_places)
+{
+	check_sample_array(values, "values");
+	if (values.size() == 0)
+		return;
+	check_first_timestamp(timestamp,
+		user_channel_signal(channel, quantity, quantity_flags).get());
+	py::gil_scoped_release release;
+	channel.push_samples(values.data(), values.size(), timestamp, samplerate,
+		quantity, quantity_flags, unit, digits, decimal_places);
+}
+
+} // namespace
+
 void init_Channel(py::module &m)
 {
 	py::class_<sv::channels::BaseChannel, std::shared_ptr<sv::channels::BaseChannel>> py_base_channel(m, "BaseChannel");
@@ -272,8 +374,179 @@ void init_Channel(py::module &m)
 		"    The total number of digits.\n"
 		"decimal_places : int\n"
 		"    The number of decimal places.");
+	py_user_channel.def("push_samples", &user_channel_push_samples,
+		py::arg("timestamps"), py::arg("values"), py::arg("quantity"),
+		py::arg("quantity_flags"), py::arg("unit"), py::arg("digits"),
+		py::arg("decimal_places"),
+		"Push multiple samples with individual timestamps to the channel. All samples are appended at once, "
+		"which is much faster than calling `push_sample()` for every sample.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timestamps : numpy.ndarray\n"
+		"    The absolute timestamps in seconds, in ascending order and not before the last timestamp of the signal.\n"
+		"values : numpy.ndarray\n"
+		"    The sample values. Must have the same size as `timestamps`.\n"
+		"quantity : Quantity\n"
+		"    The `Quantity` of the new signal.\n"
+		"quantity_flags : Set[QuantityFlag]\n"
+		"    The `QuantityFlag`s of the new signal.\n"
+		"unit : Unit\n"
+		"    The `Unit` of the new signal.\n"
+		"digits : int\n"
+		"    The total number of digits.\n"
+		"decimal_places : int\n"
+		"    The number of decimal places.");
+	py_user_channel.def("push_samples", &user_channel_push_samples_samplerate,
+		py::arg("values"), py::arg("timestamp"), py::arg("samplerate"),
+		py::arg("quantity"), py::arg("quantity_flags"), py::arg("unit"),
+		py::arg("digits"), py::arg("decimal_places"),
+		"Push multiple equidistant samples to the channel. All samples are appended at once, "
+		"which is much faster than calling `push_sample()` for every sample.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"values : numpy.ndarray\n"
+		"    The sample values.\n"
+		"timestamp : float\n"
+		"    The absolute timestamp of the first sample in seconds.\n"
+		"samplerate : int\n"
+		"    The samplerate in Hz.\n"
+		"quantity : Quantity\n"
+		"    The `Quantity` of the new signal.\n"
+		"quantity_flags : Set[QuantityFlag]\n"
+		"    The `QuantityFlag`s of the new signal.\n"
+		"unit : Unit\n"
+		"    The `Unit` of the new signal.\n"
+		"digits : int\n"
+		"    The total number of digits.\n"
+		"decimal_places : int\n"
+		"    The number of decimal places.");
+}
+
+namespace {
+
+/**
+ * Return the number of samples in the range, a negative count means all
+ * samples up to the end of the signal.
+ */
+size_t signal_range_count(const sv::data::AnalogTimeSignal &signal,
+	size_t pos, py::ssize_t count)
+{
+	const size_t sample_count = signal.sample_count();
+	if (pos >= sample_count)
+		return 0;
+	if (count >= 0 && (size_t)count < sample_count - pos)
+		return (size_t)count;
+	return sample_count - pos;
+}
+
+/**
+ * Copy the samples in the range into two NumPy arrays (timestamps and
+ * values), with one bulk copy directly into the arrays. Views on the signal
+ * storage are not possible: The newest samples are in vectors that are
+ * reallocated when they grow and the older samples are compressed or
+ * downsampled.
+ */
+py::tuple signal_get_samples(const sv::data::AnalogTimeSignal &signal,
+	size_t pos, py::ssize_t count, bool relative_time)
+{
+	size_t n = signal_range_count(signal, pos, count);
+	py::array_t<double> timestamps(n);
+	py::array_t<double> values(n);
+	double *timestamps_data = timestamps.mutable_data();
+	double *values_data = values.mutable_data();
+	{
+		py::gil_scoped_release release;
+		n = signal.get_samples(
+			pos, n, timestamps_data, values_data, relative_time);
+	}
+	if ((py::ssize_t)n < timestamps.size()) {
+		timestamps.resize({ (py::ssize_t)n });
+		values.resize({ (py::ssize_t)n });
+	}
+	return py::make_tuple(timestamps, values);
+}
+
+py::array_t<double> signal_get_timestamps(
+	const sv::data::AnalogTimeSignal &signal,
+	size_t pos, py::ssize_t count, bool relative_time)
+{
+	size_t n = signal_range_count(signal, pos, count);
+	py::array_t<double> timestamps(n);
+	double *timestamps_data = timestamps.mutable_data();
+	{
+		py::gil_scoped_release release;
+		n = signal.get_samples(pos, n, timestamps_data, nullptr, relative_time);
+	}
+	if ((py::ssize_t)n < timestamps.size())
+		timestamps.resize({ (py::ssize_t)n });
+	return timestamps;
+}
+
+py::array_t<double> signal_get_values(const sv::data::AnalogTimeSignal &signal,
+	size_t pos, py::ssize_t count)
+{
+	size_t n = signal_range_count(signal, pos, count);
+	py::array_t<double> values(n);
+	double *values_data = values.mutable_data();
+	{
+		py::gil_scoped_release release;
+		n = signal.get_samples(pos, n, nullptr, values_data, false);
+	}
+	if ((py::ssize_t)n < values.size())
+		values.resize({ (py::ssize_t)n });
+	return values;
+}
+
+py::tuple signal_get_samples_by_time(const sv::data::AnalogTimeSignal &signal,
+	double start_timestamp, double end_timestamp, bool relative_time)
+{
+	const size_t start_pos =
+		signal.lower_bound_pos(start_timestamp, relative_time);
+	const size_t end_pos = signal.lower_bound_pos(end_timestamp, relative_time);
+	const size_t count = end_pos > start_pos ? end_pos - start_pos : 0;
+	return signal_get_samples(signal, start_pos, count, relative_time);
+}
+
+void signal_push_samples(sv::data::AnalogTimeSignal &signal,
+	const sample_array_t &timestamps, const sample_array_t &values,
+	int digits, int decimal_places)
+{
+	check_sample_arrays(timestamps, values, &signal);
+	py::gil_scoped_release release;
+	signal.push_samples(timestamps.data(), values.data(), values.size(),
+		digits, decimal_places);
+}
+
+void signal_push_samples_samplerate(sv::data::AnalogTimeSignal &signal,
+	const sample_array_t &values, double timestamp, uint64_t samplerate,
+	int digits, int decimal_places)
+{
+	check_sample_array(values, "values");
+	if (values.size() == 0)
+		return;
+	check_first_timestamp(timestamp, &signal);
+	py::gil_scoped_release release;
+	signal.push_samples((void *)values.data(), values.size(), timestamp,
+		samplerate, sizeof(double), digits, decimal_places);
+}
+
+shared_ptr<sv::python::SignalSubscription> signal_subscribe(
+	shared_ptr<sv::data::AnalogTimeSignal> signal, py::function callback,
+	double max_rate, bool relative_time)
+{
+	auto subscription = make_shared<sv::python::SignalSubscription>(
+		signal, callback, max_rate, relative_time);
+	sv::python::SubscriptionDispatcher::instance().add(subscription);
+	return subscription;
 }
 
+size_t process_subscriptions(double timeout)
+{
+	return sv::python::SubscriptionDispatcher::instance().process(timeout);
+}
+
+} // namespace
+
 void init_Signal(py::module &m)
 {
 	/*
@@ -302,6 +575,17 @@ void init_Signal(py::module &m)
 		"int\n"
 		"    The number of samples.");
 
+	py::class_<sv::python::SignalSubscription, std::shared_ptr<sv::python::SignalSubscription>> py_signal_subscription(m, "SignalSubscription");
+	py_signal_subscription.doc() = "A callback, that receives the new samples of a signal. See `AnalogTimeSignal.subscribe()`.";
+	py_signal_subscription.def("unsubscribe", &sv::python::SignalSubscription::unsubscribe,
+		"Stop receiving samples. Samples, that haven't been delivered yet, are dropped.");
+	py_signal_subscription.def("is_subscribed", &sv::python::SignalSubscription::is_subscribed,
+		"Return if the callback still receives samples.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the callback still receives samples.");
+
 	py::class_<sv::data::AnalogTimeSignal, std::shared_ptr<sv::data::AnalogTimeSignal>> py_analog_time_signal(m, "AnalogTimeSignal", py_base_signal);
 	py_analog_time_signal.doc() = "A signal with time-value pairs.";
 	py_analog_time_signal.def("get_sample", &sv::data::AnalogTimeSignal::get_sample,
@@ -344,6 +628,260 @@ void init_Signal(py::module &m)
 		"    The total number of digits.\n"
 		"decimal_places : int\n"
 		"    The number of decimal places.");
+	py_analog_time_signal.def("push_samples", &signal_push_samples,
+		py::arg("timestamps"), py::arg("values"), py::arg("digits"),
+		py::arg("decimal_places"),
+		"Push multiple samples with individual timestamps to the signal. All samples are appended at once, "
+		"which is much faster than calling `push_sample()` for every sample.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timestamps : numpy.ndarray\n"
+		"    The absolute timestamps in seconds, in ascending order and not before the last timestamp of the signal.\n"
+		"values : numpy.ndarray\n"
+		"    The sample values. Must have the same size as `timestamps`.\n"
+		"digits : int\n"
+		"    The total number of digits.\n"
+		"decimal_places : int\n"
+		"    The number of decimal places.");
+	py_analog_time_signal.def("push_samples", &signal_push_samples_samplerate,
+		py::arg("values"), py::arg("timestamp"), py::arg("samplerate"),
+		py::arg("digits"), py::arg("decimal_places"),
+		"Push multiple equidistant samples to the signal. All samples are appended at once, "
+		"which is much faster than calling `push_sample()` for every sample.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"values : numpy.ndarray\n"
+		"    The sample values.\n"
+		"timestamp : float\n"
+		"    The absolute timestamp of the first sample in seconds.\n"
+		"samplerate : int\n"
+		"    The samplerate in Hz.\n"
+		"digits : int\n"
+		"    The total number of digits.\n"
+		"decimal_places : int\n"
+		"    The number of decimal places.");
+	py_analog_time_signal.def("get_samples", &signal_get_samples,
+		py::arg("pos") = 0, py::arg("count") = -1, py::arg("relative_time") = false,
+		"Return the timestamps and the values of a range of samples as NumPy arrays. This is much "
+		"faster than calling `get_sample()` for every sample.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position of the first sample.\n"
+		"count : int\n"
+		"    The number of samples. When negative, all samples up to the end of the signal are returned.\n"
+		"relative_time : bool\n"
+		"    When `True`, the returned timestamps are relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[numpy.ndarray, numpy.ndarray]\n"
+		"    The timestamps in seconds and the values.");
+	py_analog_time_signal.def("get_timestamps", &signal_get_timestamps,
+		py::arg("pos") = 0, py::arg("count") = -1, py::arg("relative_time") = false,
+		"Return the timestamps of a range of samples as NumPy array.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position of the first sample.\n"
+		"count : int\n"
+		"    The number of samples. When negative, all samples up to the end of the signal are returned.\n"
+		"relative_time : bool\n"
+		"    When `True`, the returned timestamps are relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"numpy.ndarray\n"
+		"    The timestamps in seconds.");
+	py_analog_time_signal.def("get_values", &signal_get_values,
+		py::arg("pos") = 0, py::arg("count") = -1,
+		"Return the values of a range of samples as NumPy array.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position of the first sample.\n"
+		"count : int\n"
+		"    The number of samples. When negative, all samples up to the end of the signal are returned.\n\n"
+		"Returns\n"
+		"-------\n"
+		"numpy.ndarray\n"
+		"    The values.");
+	py_analog_time_signal.def("get_samples_by_time", &signal_get_samples_by_time,
+		py::arg("start_timestamp"), py::arg("end_timestamp"), py::arg("relative_time") = false,
+		"Return the timestamps and the values of all samples with `start_timestamp <= timestamp < end_timestamp` "
+		"as NumPy arrays.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"start_timestamp : float\n"
+		"    The start of the time range in seconds.\n"
+		"end_timestamp : float\n"
+		"    The end of the time range in seconds (exclusive).\n"
+		"relative_time : bool\n"
+		"    When `True`, the timestamps are relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[numpy.ndarray, numpy.ndarray]\n"
+		"    The timestamps in seconds and the values.");
+	py_analog_time_signal.def("lower_bound_pos", &sv::data::AnalogTimeSignal::lower_bound_pos,
+		py::arg("timestamp"), py::arg("relative_time") = false,
+		"Return the position of the first sample with a timestamp that is not less than the given "
+		"timestamp. If all samples are older, `sample_count()` is returned.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timestamp : float\n"
+		"    The timestamp in seconds.\n"
+		"relative_time : bool\n"
+		"    When `True`, the timestamp is relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The position of the sample.");
+	py_analog_time_signal.def("get_envelope", &sv::data::AnalogTimeSignal::get_envelope,
+		py::arg("pos"),
+		"Return the envelope of the sample at the given position. For samples with full resolution, "
+		"min and max are the sample value. For downsampled samples, see `set_retention_policy()`, "
+		"they are the min and max value of the bucket.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position/number of the sample.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[float, float]\n"
+		"    The min and the max value.");
+	py_analog_time_signal.def("get_resolution", &sv::data::AnalogTimeSignal::get_resolution,
+		py::arg("pos"),
+		"Return the time resolution of the sample at the given position.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position/number of the sample.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The resolution (bucket width) in seconds, 0 for samples with full resolution.");
+	py_analog_time_signal.def("set_retention_policy", &sv::data::AnalogTimeSignal::set_retention_policy,
+		py::arg("raw_duration"), py::arg("tiers"),
+		"Set a tiered retention policy for the signal. Samples older than `raw_duration` are "
+		"downsampled into min/max/mean buckets. The positions of the samples don't change, "
+		"`get_sample()` returns the mean of the bucket. The policy can't be changed, once samples "
+		"have been downsampled.\n\n"
+		"Example: Keep 1 hour with full resolution, 1 day with 1 s buckets and the rest with 1 min buckets:\n"
+		"```\n"
+		"signal.set_retention_policy(3600, [(1, 86400), (60, 0)])\n"
+		"```\n\n"
+		"Parameters\n"
+		"----------\n"
+		"raw_duration : float\n"
+		"    The time in seconds, the samples are kept with full resolution.\n"
+		"tiers : List[Tuple[float, float]]\n"
+		"    The tiers from fine to coarse, each with the resolution and the duration in seconds. "
+		"The last tier is kept forever. An empty list disables the retention.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if samples have already been downsampled.");
+	py_analog_time_signal.def("retained_sample_count", &sv::data::AnalogTimeSignal::retained_sample_count,
+		"Return the number of downsampled samples.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of samples, that are not stored with full resolution.");
+	py_analog_time_signal.def("subscribe", &signal_subscribe,
+		py::arg("callback"), py::arg("max_rate") = 10., py::arg("relative_time") = false,
+		"Call a function with the new samples of the signal, instead of polling the signal. The new "
+		"samples are collected and delivered in batches by `smuview.process_subscriptions()`, "
+		"which must be called by the script. Example:\n"
+		"```\n"
+		"def on_samples(timestamps, values):\n"
+		"    print(\"{} new samples, last value = {}\".format(len(values), values[-1]))\n\n"
+		"subscription = signal.subscribe(on_samples, max_rate=20)\n"
+		"while True:\n"
+		"    smuview.process_subscriptions(1.0)\n"
+		"```\n\n"
+		"Parameters\n"
+		"----------\n"
+		"callback : Callable[[numpy.ndarray, numpy.ndarray], None]\n"
+		"    The function, that is called with the timestamps and the values of the new samples.\n"
+		"max_rate : float\n"
+		"    The max. number of calls per second. The samples in between are collected into one batch, "
+		"no sample is missed. When `0`, every call of `process_subscriptions()` delivers the new samples.\n"
+		"relative_time : bool\n"
+		"    When `True`, the timestamps are relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"SignalSubscription\n"
+		"    The subscription, use `SignalSubscription.unsubscribe()` to stop receiving samples.");
+
+	m.def("process_subscriptions", &process_subscriptions,
+		py::arg("timeout") = 1.,
+		"Wait until new samples for one or more `SignalSubscription`s are due and call their "
+		"callbacks in the calling thread. The waiting doesn't block other Python threads.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timeout : float\n"
+		"    The max. time to wait in seconds.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of callbacks, that have been called.");
+
+	py::class_<sv::data::CsvImporter> py_csv_importer(m, "CsvImporter");
+	py_csv_importer.doc() = "A fast importer for CSV files into `AnalogTimeSignal`s.\n\n"
+		"Example:\n"
+		"```\n"
+		"user_dev = Session.add_user_device()\n"
+		"ch = user_dev.add_user_channel(\"Reference\", \"\")\n"
+		"sig = ch.add_signal(smuview.Quantity.Voltage, set(), smuview.Unit.Volt)\n"
+		"importer = smuview.CsvImporter(\"reference.csv\")\n"
+		"importer.set_skip_rows(1)\n"
+		"importer.add_column(1, sig, 7, 4)\n"
+		"importer.run()\n"
+		"```";
+	py_csv_importer.def(py::init<const std::string &>(), py::arg("file_name"),
+		"Create a new importer for the given CSV file.");
+	py_csv_importer.def("set_separator", &sv::data::CsvImporter::set_separator,
+		py::arg("separator"),
+		"Set the field separator. The default is \",\".");
+	py_csv_importer.def("set_skip_rows", &sv::data::CsvImporter::set_skip_rows,
+		py::arg("skip_rows"),
+		"Set the number of rows to skip at the beginning of the file (e.g. the header).");
+	py_csv_importer.def("set_time_column", &sv::data::CsvImporter::set_time_column,
+		py::arg("time_column"),
+		"Set the (zero based) column of the timestamps. The default is 0.");
+	py_csv_importer.def("set_time_format", &sv::data::CsvImporter::set_time_format,
+		py::arg("time_format"),
+		"Set the `CsvTimeFormat` of the timestamps. The default is `CsvTimeFormat.Relative`.");
+	py_csv_importer.def("set_start_timestamp", &sv::data::CsvImporter::set_start_timestamp,
+		py::arg("start_timestamp"),
+		"Set the absolute timestamp in seconds, the relative timestamps are added to.");
+	py_csv_importer.def("add_column", &sv::data::CsvImporter::add_column,
+		py::arg("column"), py::arg("signal"), py::arg("digits"),
+		py::arg("decimal_places"),
+		"Import the values of a column into a signal.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"column : int\n"
+		"    The (zero based) column of the values.\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal to import the values to.\n"
+		"digits : int\n"
+		"    The total number of digits.\n"
+		"decimal_places : int\n"
+		"    The number of decimal places.");
+	py_csv_importer.def("run", &sv::data::CsvImporter::run,
+		py::call_guard<py::gil_scoped_release>(),
+		"Import the file.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the file could be imported.");
+	py_csv_importer.def("row_count", &sv::data::CsvImporter::row_count,
+		"Return the number of imported rows.");
+	py_csv_importer.def("skipped_rows", &sv::data::CsvImporter::skipped_rows,
+		"Return the number of rows without a valid timestamp or with a "
+		"timestamp before the last timestamp of a signal. The values, that "
+		"are not in time order, are not imported.");
+	py_csv_importer.def("error", &sv::data::CsvImporter::error,
+		"Return the error message, if the import failed.");
 
 	py::class_<sv::data::AnalogSampleSignal, std::shared_ptr<sv::data::AnalogSampleSignal>> py_analog_sample_signal(m, "AnalogSampleSignal", py_base_signal);
 	py_analog_sample_signal.doc() = "A signal with key-value pairs.";
@@ -393,6 +931,7 @@ void init_Configurable(py::module &m)
 		"    The name of the configurable.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_config<bool>,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set a boolean value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -402,6 +941,7 @@ void init_Configurable(py::module &m)
 		"    The bool value to set.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_config<int32_t>,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set an integer value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -411,6 +951,7 @@ void init_Configurable(py::module &m)
 		"    The int value to set.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_config<uint64_t>,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set an unsigned integer value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -420,6 +961,7 @@ void init_Configurable(py::module &m)
 		"    The (unsigned) int value to set.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_config<double>,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set a double value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -429,6 +971,7 @@ void init_Configurable(py::module &m)
 		"    The float value to set.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_config<std::string>,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set a string value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -438,6 +981,7 @@ void init_Configurable(py::module &m)
 		"    The string value to set.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_measured_quantity_config,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set a measured quantity value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -447,6 +991,7 @@ void init_Configurable(py::module &m)
 		"    The measured quantity value to set.");
 	py_configurable.def("get_bool_config", &sv::devices::Configurable::get_config<bool>,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return a boolean value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -458,6 +1003,7 @@ void init_Configurable(py::module &m)
 		"    The bool value of the config key.");
 	py_configurable.def("get_int_config", &sv::devices::Configurable::get_config<int32_t>,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return an integer value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -469,6 +1015,7 @@ void init_Configurable(py::module &m)
 		"    The int value of the config key.");
 	py_configurable.def("get_uint_config", &sv::devices::Configurable::get_config<uint64_t>,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return an unsigned integer value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -480,6 +1027,7 @@ void init_Configurable(py::module &m)
 		"    The (unsigned) int value of the config key.");
 	py_configurable.def("get_double_config", &sv::devices::Configurable::get_config<double>,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return a double value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -491,6 +1039,7 @@ void init_Configurable(py::module &m)
 		"    The float value of the config key.");
 	py_configurable.def("get_string_config", &sv::devices::Configurable::get_config<std::string>,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return a string value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -502,6 +1051,7 @@ void init_Configurable(py::module &m)
 		"    The string value of the config key.");
 	py_configurable.def("get_measured_quantity_config", &sv::devices::Configurable::get_measured_quantity_config,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return a measured quantity value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -512,18 +1062,21 @@ void init_Configurable(py::module &m)
 		"Tuple[Quantity, Set[QuantityFlag]]\n"
 		"    The measured quantity value of the config key.");
 	py_configurable.def("getable_configs", &sv::devices::Configurable::getable_configs,
+		py::call_guard<py::gil_scoped_release>(),
 		"Return all getable config keys.\n\n"
 		"Returns\n"
 		"-------\n"
 		"List[ConfigKey]\n"
 		"    All getable config keys.");
 	py_configurable.def("setable_configs", &sv::devices::Configurable::setable_configs,
+		py::call_guard<py::gil_scoped_release>(),
 		"Return all setable config keys.\n\n"
 		"Returns\n"
 		"-------\n"
 		"List[ConfigKey]\n"
 		"    All setable config keys.");
 	py_configurable.def("listable_configs", &sv::devices::Configurable::listable_configs,
+		py::call_guard<py::gil_scoped_release>(),
 		"Return all listable config keys.\n\n"
 		"Returns\n"
 		"-------\n"
@@ -1306,6 +1859,15 @@ void init_Enums(py::module &m)
 	py_unit.value("Unknown", sv::data::Unit::Unknown);
 	m.attr("__pdoc__")["Unit.Unknown"] = "Unknown";
 
+	py::enum_<sv::data::CsvTimeFormat> py_csv_time_format(m, "CsvTimeFormat",
+		"Enum of all time formats for the CSV import.");
+	py_csv_time_format.value("Relative", sv::data::CsvTimeFormat::Relative);
+	m.attr("__pdoc__")["CsvTimeFormat.Relative"] = "Seconds relative to the start timestamp of the import.";
+	py_csv_time_format.value("Absolute", sv::data::CsvTimeFormat::Absolute);
+	m.attr("__pdoc__")["CsvTimeFormat.Absolute"] = "Seconds since the epoch.";
+	py_csv_time_format.value("DateTime", sv::data::CsvTimeFormat::DateTime);
+	m.attr("__pdoc__")["CsvTimeFormat.DateTime"] = "Local date and time in the format \"yyyy.MM.dd hh:mm:ss.zzz\".";
+
 	// Qt enumerations
 	py::enum_<Qt::DockWidgetArea> py_dock_area(m, "DockArea",
 		"Enum of all possible docking locations for a view.");
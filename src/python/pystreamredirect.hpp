@@ -21,7 +21,6 @@
 #define PYTHON_PYSTREAMREDIRECT_HPP
 
 #include <iostream>
-#include <memory>
 #include <string>
 
 #include <pybind11/pybind11.h>
@@ -31,7 +30,6 @@
 #include "src/python/pystreambuf.hpp"
 #include "src/python/smuscriptrunner.hpp"
 
-using std::shared_ptr;
 using std::string;
 
 namespace py = pybind11;
@@ -44,7 +42,7 @@ class __attribute__((visibility("hidden"))) PyStreamRedirect : public QObject
 	Q_OBJECT
 
 public:
-    explicit PyStreamRedirect(shared_ptr<SmuScriptRunner> script_runner) :
+    explicit PyStreamRedirect(SmuScriptRunner *script_runner) :
 		script_runner_(script_runner)
 	{
 		auto sys_module = py::module::import("sys");
@@ -60,7 +58,7 @@ public:
 		auto py_stdout_buf = py::cast(
 			stdout_buf_, py::return_value_policy::reference);
 		connect(stdout_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stdout);
+			script_runner_, &SmuScriptRunner::send_py_stdout);
 
 		stderr_buf_ = new PyStreamBuf(
 			py::str(py::getattr(old_stderr_, "encoding", default_encoding)),
@@ -68,7 +66,7 @@ public:
 		auto py_stderr_buf = py::cast(
 			stderr_buf_, py::return_value_policy::reference);
 		connect(stderr_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stderr);
+			script_runner_, &SmuScriptRunner::send_py_stderr);
 
 		sys_module.attr("stdout") = py_stdout_buf;
 		sys_module.attr("stderr") = py_stderr_buf;
@@ -87,13 +85,14 @@ public:
 		stderr_buf_->py_close();
 
 		disconnect(stdout_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stdout);
+			script_runner_, &SmuScriptRunner::send_py_stdout);
 		disconnect(stderr_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stderr);
+			script_runner_, &SmuScriptRunner::send_py_stderr);
 	}
 
 private:
-	shared_ptr<SmuScriptRunner> script_runner_;
+	/** The runner outlives the redirect, it joins the interpreter thread. */
+	SmuScriptRunner *script_runner_;
 	py::object old_stdout_;
 	py::object old_stderr_;
 	PyStreamBuf *stdout_buf_;
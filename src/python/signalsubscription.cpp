@@ -0,0 +1,250 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <QObject>
+
+#include "signalsubscription.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+using std::unique_lock;
+using std::vector;
+
+namespace py = pybind11;
+
+namespace sv {
+namespace python {
+
+SignalSubscription::SignalSubscription(
+		shared_ptr<data::AnalogTimeSignal> signal, py::function callback,
+		double max_rate, bool relative_time) :
+	signal_(signal),
+	callback_(callback),
+	min_interval_(max_rate > 0. ? 1. / max_rate : 0.),
+	relative_time_(relative_time),
+	subscribed_(true),
+	next_pos_(signal->sample_count()),
+	last_delivery_time_(-std::numeric_limits<double>::infinity()),
+	cleared_(make_shared<std::atomic<bool>>(false))
+{
+	// The signals are emitted by the acquisition thread, so the samples are
+	// not read here, but by the script thread in deliver().
+	sample_appended_conn_ = QObject::connect(
+		signal_.get(), &data::AnalogTimeSignal::sample_appended,
+		[]() { SubscriptionDispatcher::instance().notify(); });
+	auto cleared = cleared_;
+	samples_cleared_conn_ = QObject::connect(
+		signal_.get(), &data::AnalogTimeSignal::samples_cleared,
+		[cleared]() {
+			*cleared = true;
+			SubscriptionDispatcher::instance().notify();
+		});
+}
+
+SignalSubscription::~SignalSubscription()
+{
+	unsubscribe();
+}
+
+void SignalSubscription::unsubscribe()
+{
+	if (!subscribed_.exchange(false))
+		return;
+
+	QObject::disconnect(sample_appended_conn_);
+	QObject::disconnect(samples_cleared_conn_);
+	SubscriptionDispatcher::instance().remove(this);
+}
+
+bool SignalSubscription::is_subscribed() const
+{
+	return subscribed_;
+}
+
+bool SignalSubscription::has_new_samples() const
+{
+	if (!subscribed_)
+		return false;
+	return *cleared_ || signal_->sample_count() > next_pos_;
+}
+
+double SignalSubscription::next_delivery_time() const
+{
+	return last_delivery_time_ + min_interval_;
+}
+
+bool SignalSubscription::deliver(double now)
+{
+	if (!subscribed_)
+		return false;
+
+	if (cleared_->exchange(false))
+		next_pos_ = 0;
+	const size_t sample_count = signal_->sample_count();
+	if (sample_count <= next_pos_)
+		return false;
+
+	size_t count = sample_count - next_pos_;
+	py::array_t<double> timestamps(count);
+	py::array_t<double> values(count);
+	double *timestamps_data = timestamps.mutable_data();
+	double *values_data = values.mutable_data();
+	{
+		py::gil_scoped_release release;
+		count = signal_->get_samples(next_pos_, count,
+			timestamps_data, values_data, relative_time_);
+	}
+	if ((py::ssize_t)count < timestamps.size()) {
+		timestamps.resize({ (py::ssize_t)count });
+		values.resize({ (py::ssize_t)count });
+	}
+	next_pos_ += count;
+	last_delivery_time_ = now;
+
+	callback_(timestamps, values);
+	return true;
+}
+
+
+const double SubscriptionDispatcher::max_wait_time_ = .1;
+
+SubscriptionDispatcher &SubscriptionDispatcher::instance()
+{
+	static SubscriptionDispatcher dispatcher;
+	return dispatcher;
+}
+
+double SubscriptionDispatcher::now()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SubscriptionDispatcher::add(shared_ptr<SignalSubscription> subscription)
+{
+	lock_guard<mutex> lock(mutex_);
+	subscriptions_.push_back(subscription);
+}
+
+void SubscriptionDispatcher::remove(const SignalSubscription *subscription)
+{
+	// Destroyed after the mutex has been unlocked.
+	shared_ptr<SignalSubscription> removed;
+
+	lock_guard<mutex> lock(mutex_);
+	auto it = std::find_if(subscriptions_.begin(), subscriptions_.end(),
+		[subscription](const shared_ptr<SignalSubscription> &s) {
+			return s.get() == subscription;
+		});
+	if (it == subscriptions_.end())
+		return;
+	removed = *it;
+	subscriptions_.erase(it);
+}
+
+void SubscriptionDispatcher::clear()
+{
+	vector<shared_ptr<SignalSubscription>> subscriptions;
+	{
+		lock_guard<mutex> lock(mutex_);
+		subscriptions.swap(subscriptions_);
+	}
+	for (const auto &subscription : subscriptions)
+		subscription->unsubscribe();
+}
+
+void SubscriptionDispatcher::notify()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+	}
+	cv_.notify_all();
+}
+
+size_t SubscriptionDispatcher::process(double timeout)
+{
+	const double deadline = now() + std::max(timeout, 0.);
+	vector<shared_ptr<SignalSubscription>> due;
+	while (true) {
+		{
+			py::gil_scoped_release release;
+			unique_lock<mutex> lock(mutex_);
+			double time = now();
+			double next_time;
+			due = due_subscriptions(time, next_time);
+			if (due.empty() && time < deadline) {
+				// Wake up for new samples, for the next due batch, at the
+				// deadline or to check for a stop request.
+				const double wait_time = std::min(
+					{ next_time, deadline, time + max_wait_time_ }) - time;
+				cv_.wait_for(lock, std::chrono::duration<double>(wait_time));
+				time = now();
+				due = due_subscriptions(time, next_time);
+			}
+		}
+
+		// Raise the KeyboardInterrupt of SmuScriptRunner::stop().
+		if (PyErr_CheckSignals() != 0)
+			throw py::error_already_set();
+		if (!due.empty() || now() >= deadline)
+			break;
+	}
+
+	size_t delivered = 0;
+	const double time = now();
+	for (const auto &subscription : due) {
+		if (subscription->deliver(time))
+			++delivered;
+	}
+	return delivered;
+}
+
+vector<shared_ptr<SignalSubscription>>
+	SubscriptionDispatcher::due_subscriptions(
+		double time, double &next_time) const
+{
+	vector<shared_ptr<SignalSubscription>> due;
+	next_time = std::numeric_limits<double>::infinity();
+	for (const auto &subscription : subscriptions_) {
+		if (!subscription->has_new_samples())
+			continue;
+		const double delivery_time = subscription->next_delivery_time();
+		if (delivery_time <= time)
+			due.push_back(subscription);
+		else
+			next_time = std::min(next_time, delivery_time);
+	}
+	return due;
+}
+
+} // namespace python
+} // namespace sv
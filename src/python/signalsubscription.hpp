@@ -0,0 +1,140 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_SIGNALSUBSCRIPTION_HPP
+#define PYTHON_SIGNALSUBSCRIPTION_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+
+#include <QMetaObject>
+
+using std::shared_ptr;
+using std::vector;
+
+namespace py = pybind11;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace python {
+
+/**
+ * A Python callback, that receives the new samples of a signal.
+ *
+ * The new samples are collected and delivered in batches (as NumPy arrays)
+ * by SubscriptionDispatcher::process(), that is called from the script
+ * thread. A batch is delivered at most max_rate times per second.
+ */
+class SignalSubscription
+{
+
+public:
+	SignalSubscription(shared_ptr<data::AnalogTimeSignal> signal,
+		py::function callback, double max_rate, bool relative_time);
+	~SignalSubscription();
+
+	/** Stop receiving samples. */
+	void unsubscribe();
+	bool is_subscribed() const;
+
+	/** True if there are samples, that haven't been delivered yet. */
+	bool has_new_samples() const;
+	/** The earliest time (see SubscriptionDispatcher::now()) of the next batch. */
+	double next_delivery_time() const;
+	/**
+	 * Call the callback with all new samples. The GIL must be held.
+	 *
+	 * @return True if samples have been delivered.
+	 */
+	bool deliver(double now);
+
+private:
+	shared_ptr<data::AnalogTimeSignal> signal_;
+	py::function callback_;
+	double min_interval_;
+	bool relative_time_;
+	std::atomic<bool> subscribed_;
+	/** The position of the first sample, that hasn't been delivered. */
+	size_t next_pos_;
+	double last_delivery_time_;
+	/** Set by the acquisition thread, when the signal has been cleared. */
+	shared_ptr<std::atomic<bool>> cleared_;
+	QMetaObject::Connection sample_appended_conn_;
+	QMetaObject::Connection samples_cleared_conn_;
+
+};
+
+/**
+ * Wakes up the script thread, when new samples have arrived for one of the
+ * subscriptions and delivers the batches.
+ */
+class SubscriptionDispatcher
+{
+
+public:
+	static SubscriptionDispatcher &instance();
+
+	/** Monotonic time in seconds. */
+	static double now();
+
+	void add(shared_ptr<SignalSubscription> subscription);
+	void remove(const SignalSubscription *subscription);
+	/** Remove all subscriptions. The GIL must be held. */
+	void clear();
+	/** Called by the acquisition threads, when a signal got new samples. */
+	void notify();
+
+	/**
+	 * Wait until batches are due or the timeout (in seconds) has expired and
+	 * deliver them. Must be called with the GIL held, the GIL is released
+	 * while waiting.
+	 *
+	 * @return The number of delivered batches.
+	 */
+	size_t process(double timeout);
+
+private:
+	SubscriptionDispatcher() = default;
+
+	/** Collect the due subscriptions. The mutex must be locked. */
+	vector<shared_ptr<SignalSubscription>> due_subscriptions(
+		double time, double &next_time) const;
+
+	vector<shared_ptr<SignalSubscription>> subscriptions_;
+	mutable std::mutex mutex_;
+	std::condition_variable cv_;
+
+	/** The max. time the GIL is released, to handle a stop request. */
+	static const double max_wait_time_;
+
+};
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_SIGNALSUBSCRIPTION_HPP
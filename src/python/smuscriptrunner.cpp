@@ -17,7 +17,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 
@@ -33,11 +35,15 @@
 #include "src/python/bindings.hpp"
 #include "src/python/pystreambuf.hpp"
 #include "src/python/pystreamredirect.hpp"
+#include "src/python/signalsubscription.hpp"
 #include "src/python/uihelper.hpp"
 #include "src/python/uiproxy.hpp"
 
+using std::lock_guard;
 using std::make_shared;
+using std::mutex;
 using std::string;
+using std::unique_lock;
 
 using namespace pybind11::literals; // for the ""_a
 namespace py = pybind11;
@@ -47,6 +53,9 @@ namespace python {
 
 SmuScriptRunner::SmuScriptRunner(Session &session) :
 	session_(session),
+	script_pending_(false),
+	shutdown_(false),
+	ui_proxy_(nullptr),
 	is_running_(false)
 {
 	ui_helper_ = make_shared<UiHelper>(session_);
@@ -54,10 +63,7 @@ SmuScriptRunner::SmuScriptRunner(Session &session) :
 
 SmuScriptRunner::~SmuScriptRunner()
 {
-	/*
-	if (script_thread_.joinable())
-		script_thread_.join();
-	*/
+	shutdown();
 }
 
 void SmuScriptRunner::run(const string &file_name)
@@ -75,13 +81,29 @@ void SmuScriptRunner::run(const string &file_name)
 		return;
 	}
 
-	script_file_name_ = file_name;
-	script_thread_ = std::thread(&SmuScriptRunner::script_thread_proc, this);
-	script_thread_.detach();
+	{
+		lock_guard<mutex> lock(script_mutex_);
+		if (is_running_ || script_pending_) {
+			Q_EMIT script_error("SmuScriptRunner",
+				tr("A script is already running!").toStdString());
+			return;
+		}
+		script_file_name_ = file_name;
+		script_pending_ = true;
+	}
+
+	// The interpreter is started once and then reused for all scripts.
+	if (!interpreter_thread_.joinable()) {
+		interpreter_thread_ =
+			std::thread(&SmuScriptRunner::interpreter_thread_proc, this);
+	}
+	script_cv_.notify_one();
 }
 
 void SmuScriptRunner::stop()
 {
+	// The interpreter thread is the Python main thread, so the
+	// KeyboardInterrupt is raised in the running script.
 	if (is_running_)
 		PyErr_SetInterrupt();
 }
@@ -91,48 +113,117 @@ bool SmuScriptRunner::is_running()
 	return is_running_;
 }
 
-void SmuScriptRunner::script_thread_proc()
+void SmuScriptRunner::shutdown()
 {
-	// TODO: mutex?
-
-	qWarning() << "SmuScriptRunner::script_thread_proc() executing " <<
-		QString::fromStdString(script_file_name_);
+	if (!interpreter_thread_.joinable())
+		return;
 
-	is_running_ = true;
-	Q_EMIT script_started();
+	{
+		lock_guard<mutex> lock(script_mutex_);
+		shutdown_ = true;
+		script_pending_ = false;
+	}
+	script_cv_.notify_one();
+
+	// Interrupt the script until it has finished, it could catch the
+	// KeyboardInterrupt or wait for the UI. The interpreter thread needs the
+	// mutex to quit, so the interpreter is alive while the mutex is locked.
+	while (true) {
+		{
+			lock_guard<mutex> lock(script_mutex_);
+			if (!is_running_)
+				break;
+			PyErr_SetInterrupt();
+			if (ui_proxy_)
+				ui_proxy_->cancel_wait();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	interpreter_thread_.join();
+}
 
+void SmuScriptRunner::interpreter_thread_proc()
+{
 	py::scoped_interpreter guard{};
 
+	// Import the smuview module once, it stays cached like all modules
+	// imported by the scripts.
 	py::module smuview_module = py::module::import("smuview");
 
-	// Redirect python stdout + stderr
-	PyStreamRedirect py_stream_redirect{ shared_from_this() };
-
-	/*
-	 * NOTE: Setting Session and UiProxy as locals does not work!
-	 * When executing a script, the globals() inside a function are missing the
-	 * additional stuff like imported modules, function pointer and also
-	 * everyhthing provided by the locals dict. Setting Session and UiProxy in
-	 * addition to py::globals() as globals did the trick. See:
-	 * https://medium.com/just-me-me-programming-life/python-c-and-symbols-4628fb71a257
-	 */
-	UiProxy *ui_proxy = new UiProxy(session_, ui_helper_);
-	auto globals = py::dict(
-		**py::globals(),
-		"Session"_a=py::cast(session_, py::return_value_policy::reference),
-		"UiProxy"_a=py::cast(ui_proxy, py::return_value_policy::reference));
-
-	try {
-		py::eval_file(script_file_name_, globals);
+	UiProxy ui_proxy(session_, ui_helper_);
+	{
+		lock_guard<mutex> lock(script_mutex_);
+		ui_proxy_ = &ui_proxy;
 	}
-	catch (py::error_already_set &ex) {
-		Q_EMIT send_py_stderr(ex.what());
-		Q_EMIT script_error("SmuScriptRunner py::error_already_set", ex.what());
+
+	while (true) {
+		string file_name;
+		{
+			// Let the Python threads of former scripts run while waiting.
+			py::gil_scoped_release release;
+			unique_lock<mutex> lock(script_mutex_);
+			script_cv_.wait(lock,
+				[this] { return script_pending_ || shutdown_; });
+			if (shutdown_) {
+				ui_proxy_ = nullptr;
+				break;
+			}
+			file_name = script_file_name_;
+			script_pending_ = false;
+			is_running_ = true;
+		}
+
+		run_script(file_name, &ui_proxy);
 	}
+}
 
-	qWarning() << "SmuScriptRunner::script_thread_proc() has finished!";
-	Q_EMIT script_finished();
+void SmuScriptRunner::run_script(const string &file_name, UiProxy *ui_proxy)
+{
+	qWarning() << "SmuScriptRunner::run_script() executing " <<
+		QString::fromStdString(file_name);
+
+	Q_EMIT script_started();
+
+	{
+		// Redirect python stdout + stderr
+		PyStreamRedirect py_stream_redirect{ this };
+
+		/*
+		 * NOTE: Setting Session and UiProxy as locals does not work!
+		 * When executing a script, the globals() inside a function are missing
+		 * the additional stuff like imported modules, function pointer and also
+		 * everyhthing provided by the locals dict. Setting Session and UiProxy
+		 * in addition to py::globals() as globals did the trick. See:
+		 * https://medium.com/just-me-me-programming-life/python-c-and-symbols-4628fb71a257
+		 *
+		 * The globals are a copy of the (unmodified) __main__ globals, so
+		 * every script starts with fresh globals.
+		 */
+		auto globals = py::dict(
+			**py::globals(),
+			"__file__"_a=file_name,
+			"Session"_a=py::cast(session_, py::return_value_policy::reference),
+			"UiProxy"_a=py::cast(ui_proxy, py::return_value_policy::reference));
+
+		// Drop an interrupt, that was meant for the previous script.
+		if (PyErr_CheckSignals() != 0)
+			PyErr_Clear();
+
+		try {
+			py::eval_file(file_name, globals);
+		}
+		catch (py::error_already_set &ex) {
+			Q_EMIT send_py_stderr(ex.what());
+			Q_EMIT script_error("SmuScriptRunner py::error_already_set", ex.what());
+		}
+
+		// The callbacks of the script must not be called anymore.
+		SubscriptionDispatcher::instance().clear();
+	}
+
+	qWarning() << "SmuScriptRunner::run_script() has finished!";
 	is_running_ = false;
+	Q_EMIT script_finished();
 }
 
 } // namespace python
@@ -20,7 +20,10 @@
 #ifndef PYTHON_SMUSCRIPTRUNNER_HPP
 #define PYTHON_SMUSCRIPTRUNNER_HPP
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 
@@ -37,10 +40,16 @@ class Session;
 namespace python {
 
 class UiHelper;
+class UiProxy;
 
-class SmuScriptRunner :
-	public QObject,
-	public std::enable_shared_from_this<SmuScriptRunner>
+/**
+ * Runs SmuScripts in one long-lived embedded Python interpreter.
+ *
+ * The interpreter is started with the first script and lives in its own
+ * thread until the runner is destroyed. Imported modules stay cached
+ * between the runs, but every script gets its own globals.
+ */
+class SmuScriptRunner : public QObject
 {
 	Q_OBJECT
 
@@ -51,15 +60,28 @@ public:
 	void run(const std::string &file_name);
 	void stop();
 	bool is_running();
+	/**
+	 * Interrupt a running script and stop the interpreter thread. Must be
+	 * called before the session is destroyed.
+	 */
+	void shutdown();
 
 private:
-	void script_thread_proc();
+	void interpreter_thread_proc();
+	void run_script(const string &file_name, UiProxy *ui_proxy);
 
 	Session &session_;
 	shared_ptr<UiHelper> ui_helper_;
+	/** The script, that is waiting for the interpreter thread. */
 	string script_file_name_;
-	std::thread script_thread_;
-	bool is_running_;
+	bool script_pending_;
+	bool shutdown_;
+	/** The UiProxy of the interpreter thread, guarded by script_mutex_. */
+	UiProxy *ui_proxy_;
+	std::mutex script_mutex_;
+	std::condition_variable script_cv_;
+	std::thread interpreter_thread_;
+	std::atomic<bool> is_running_;
 
 Q_SIGNALS:
 	void script_error(const std::string &sender, const std::string &msg);
@@ -107,7 +107,7 @@ string UiProxy::ui_add_device_tab(shared_ptr<devices::BaseDevice> device)
 	string id;
 	init_wait_for_tab_added(id);
 	Q_EMIT add_device_tab(device);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return id;
@@ -119,7 +119,7 @@ string UiProxy::ui_add_data_view(const string &tab_id, Qt::DockWidgetArea area,
 	string id;
 	init_wait_for_view_added(id);
 	Q_EMIT add_data_view(tab_id, area, signal);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return id;
@@ -132,7 +132,7 @@ string UiProxy::ui_add_control_view(const string &tab_id,
 	string id;
 	init_wait_for_view_added(id);
 	Q_EMIT add_control_view(tab_id, area, configurable);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return id;
@@ -144,7 +144,7 @@ string UiProxy::ui_add_time_plot_view(const string &tab_id,
 	string id;
 	init_wait_for_view_added(id);
 	Q_EMIT add_time_plot_view(tab_id, area);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return id;
@@ -156,7 +156,7 @@ string UiProxy::ui_add_xy_plot_view(const string &tab_id,
 	string id;
 	init_wait_for_view_added(id);
 	Q_EMIT add_xy_plot_view(tab_id, area);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return id;
@@ -170,7 +170,7 @@ string UiProxy::ui_add_power_panel_view(const string &tab_id,
 	string id;
 	init_wait_for_view_added(id);
 	Q_EMIT add_power_panel_view(tab_id, area, voltage_signal, current_signal);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return id;
@@ -183,7 +183,7 @@ string UiProxy::ui_add_value_panel_view(const string &tab_id,
 	string id;
 	init_wait_for_view_added(id);
 	Q_EMIT add_value_panel_view(tab_id, area, channel);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return id;
@@ -196,7 +196,7 @@ string UiProxy::ui_add_value_panel_view(const string &tab_id,
 	string id;
 	init_wait_for_view_added(id);
 	Q_EMIT add_value_panel_view(tab_id, area, signal);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return id;
@@ -223,7 +223,7 @@ string UiProxy::ui_add_curve_to_time_plot_view(const string &tab_id,
 	string id;
 	init_wait_for_curve_added(id);
 	Q_EMIT add_curve_to_time_plot_view(tab_id, view_id, signal);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return id;
@@ -237,7 +237,7 @@ string UiProxy::ui_add_curve_to_xy_plot_view(const string &tab_id,
 	string id;
 	init_wait_for_curve_added(id);
 	Q_EMIT add_curve_to_xy_plot_view(tab_id, view_id, x_signal, y_signal);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return id;
@@ -262,7 +262,7 @@ bool UiProxy::ui_show_message_box(const std::string &title,
 	bool ok;
 	init_wait_for_message_box(ok);
 	Q_EMIT show_message_box(title, text);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	return ok;
@@ -275,7 +275,7 @@ py::object UiProxy::ui_show_string_input_dialog(const string &title,
 	QVariant qvar;
 	init_wait_for_input_dialog(ok, qvar);
 	Q_EMIT show_string_input_dialog(title, label, value);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	if (!ok)
@@ -292,7 +292,7 @@ py::object UiProxy::ui_show_double_input_dialog(const string &title,
 	init_wait_for_input_dialog(ok, qvar);
 	Q_EMIT show_double_input_dialog(
 		title, label, value, decimals, step, min, max);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	if (!ok)
@@ -307,7 +307,7 @@ py::object UiProxy::ui_show_int_input_dialog(const string &title,
 	QVariant qvar;
 	init_wait_for_input_dialog(ok, qvar);
 	Q_EMIT show_int_input_dialog(title, label, value, step, min, max);
-	event_loop_.exec();
+	wait_for_signal();
 	finish_wait_for_signal();
 
 	if (!ok)
@@ -413,6 +413,19 @@ void UiProxy::init_wait_for_input_dialog(bool &ok, QVariant &qvar, int timeout)
 	}
 }
 
+void UiProxy::wait_for_signal()
+{
+	// Let the other Python threads run, while waiting for the UI.
+	py::gil_scoped_release release;
+	event_loop_.exec();
+}
+
+void UiProxy::cancel_wait()
+{
+	// The event loop is running in the interpreter thread.
+	QMetaObject::invokeMethod(&event_loop_, "quit", Qt::QueuedConnection);
+}
+
 void UiProxy::finish_wait_for_signal()
 {
 	if (event_loop_finished_conn_)
@@ -116,12 +116,20 @@ public:
 	py::object ui_show_int_input_dialog(const string &title,
 		const string &label, int value, int step, int min, int max);
 
+	/**
+	 * Stop waiting for the UI, e.g. when the application is closed. Can be
+	 * called from any thread.
+	 */
+	void cancel_wait();
+
 private:
 	void init_wait_for_tab_added(string &id, int timeout = 1000);
 	void init_wait_for_view_added(string &id, int timeout = 1000);
 	void init_wait_for_curve_added(string &id, int timeout = 1000);
 	void init_wait_for_message_box(bool &ok, int timeout = 0);
 	void init_wait_for_input_dialog(bool &ok, QVariant &qvar, int timeout = 0);
+	/** Run the event loop until the UI has answered. Releases the GIL. */
+	void wait_for_signal();
 	void finish_wait_for_signal();
 
 	Session &session_;
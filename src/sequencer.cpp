@@ -0,0 +1,213 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QVariant>
+
+#include "sequencer.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/waveform.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::vector;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::steady_clock;
+
+namespace sv {
+
+Sequencer::Sequencer(shared_ptr<data::properties::DoubleProperty> property) :
+	QObject(),
+	property_(property),
+	record_channel_(nullptr),
+	record_quantity_(data::Quantity::Unknown),
+	waveform_(nullptr),
+	repeat_count_(0),
+	stop_requested_(false),
+	is_running_(false)
+{
+	assert(property_);
+
+	// Resolve everything needed for the recording up front, so the
+	// sequencer thread doesn't have to.
+	record_unit_ = property_->unit();
+	for (const auto &q_pair : data::datautil::get_quantity_name_map()) {
+		if (data::datautil::get_units_from_quantity(q_pair.first).count(
+				record_unit_) > 0) {
+			record_quantity_ = q_pair.first;
+			break;
+		}
+	}
+	record_digits_ = (int)property_->digits();
+	record_decimal_places_ = (int)property_->decimal_places();
+}
+
+Sequencer::~Sequencer()
+{
+	stop();
+}
+
+void Sequencer::set_sequence(const vector<double> &values,
+	const vector<double> &delays)
+{
+	assert(values.size() == delays.size());
+
+	if (is_running_)
+		return;
+
+	waveform_ = nullptr;
+	sequence_.clear();
+	for (size_t i=0; i<values.size() && i<delays.size(); ++i) {
+		if (delays[i] <= 0)
+			continue;
+		sequence_.push_back({ (int)i, values[i], delays[i] });
+	}
+}
+
+void Sequencer::set_waveform(shared_ptr<data::Waveform> waveform)
+{
+	if (is_running_)
+		return;
+
+	sequence_.clear();
+	waveform_ = waveform;
+}
+
+void Sequencer::set_repeat_count(int repeat_count)
+{
+	if (is_running_)
+		return;
+
+	repeat_count_ = repeat_count;
+}
+
+void Sequencer::set_record_channel(shared_ptr<channels::UserChannel> channel)
+{
+	if (is_running_)
+		return;
+
+	record_channel_ = channel;
+}
+
+bool Sequencer::start()
+{
+	stop();
+
+	SequenceStep step;
+	if (!get_step(0, step))
+		return false;
+
+	stop_requested_ = false;
+	is_running_ = true;
+	sequencer_thread_ = std::thread(&Sequencer::sequencer_thread_proc, this);
+	return true;
+}
+
+void Sequencer::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_requested_ = true;
+	}
+	stop_cond_.notify_all();
+
+	if (sequencer_thread_.joinable())
+		sequencer_thread_.join();
+}
+
+bool Sequencer::is_running() const
+{
+	return is_running_;
+}
+
+bool Sequencer::get_step(uint64_t index, SequenceStep &step) const
+{
+	const uint64_t cycle_length =
+		waveform_ ? waveform_->sample_count() : sequence_.size();
+	if (cycle_length == 0)
+		return false;
+	if (repeat_count_ > 0 && index / cycle_length >= (uint64_t)repeat_count_)
+		return false;
+
+	if (waveform_) {
+		step.pos = -1;
+		step.value = waveform_->sample_value(index);
+		step.delay = waveform_->interval();
+	}
+	else {
+		step = sequence_[index % cycle_length];
+	}
+	return true;
+}
+
+void Sequencer::sequencer_thread_proc()
+{
+	// The deadlines are calculated from the steady clock, the recorded
+	// timestamps are the wall clock time at the start of the sequence plus
+	// the elapsed steady clock time.
+	const auto start_time = steady_clock::now();
+	const double start_timestamp =
+		QDateTime::currentMSecsSinceEpoch() / (double)1000;
+	auto deadline = start_time;
+
+	uint64_t index = 0;
+	SequenceStep step;
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (!stop_requested_ && get_step(index, step)) {
+		lock.unlock();
+		property_->change_value(QVariant(step.value));
+		const double timestamp = start_timestamp +
+			duration<double>(steady_clock::now() - start_time).count();
+		if (record_channel_) {
+			record_channel_->push_sample(step.value, timestamp,
+				record_quantity_, record_quantity_flags_, record_unit_,
+				record_digits_, record_decimal_places_);
+		}
+		Q_EMIT step_applied(step.pos, step.value, timestamp);
+		lock.lock();
+
+		// The next deadline is relative to the last deadline and not to the
+		// time the value was written, so the sequence doesn't drift.
+		deadline += duration_cast<steady_clock::duration>(
+			duration<double>(step.delay));
+		stop_cond_.wait_until(lock, deadline, [this] {
+			return stop_requested_;
+		});
+		++index;
+	}
+	lock.unlock();
+
+	is_running_ = false;
+	Q_EMIT finished();
+}
+
+} // namespace sv
@@ -0,0 +1,137 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEQUENCER_HPP
+#define SEQUENCER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+
+#include "src/data/datautil.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+namespace channels {
+class UserChannel;
+}
+namespace data {
+class Waveform;
+namespace properties {
+class DoubleProperty;
+}
+}
+
+/**
+ * The Sequencer applies a sequence of values to a double property in its
+ * own thread.
+ *
+ * Every step is scheduled to an absolute deadline on the steady clock, so
+ * neither the GUI load nor the time a config write takes add up to a drift
+ * of the sequence. The actual time each value has been applied at can be
+ * recorded into a user channel.
+ *
+ * The values are either taken from a table (set_sequence()) or calculated
+ * for every step from a waveform (set_waveform()).
+ */
+class Sequencer : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit Sequencer(
+		shared_ptr<sv::data::properties::DoubleProperty> property);
+	~Sequencer();
+
+	/**
+	 * Set the sequence. Steps with a delay <= 0 are skipped, like they
+	 * never were applied to the device. The sequence can only be changed
+	 * while the sequencer is not running.
+	 */
+	void set_sequence(const vector<double> &values,
+		const vector<double> &delays);
+	/**
+	 * Set a waveform, that is evaluated for every step. This replaces the
+	 * sequence table until a new sequence is set.
+	 */
+	void set_waveform(shared_ptr<sv::data::Waveform> waveform);
+	/** Number of cycles to run, 0 for an infinite number of cycles. */
+	void set_repeat_count(int repeat_count);
+	/** Record the applied values into the given channel (or nullptr). */
+	void set_record_channel(shared_ptr<channels::UserChannel> channel);
+
+	bool start();
+	void stop();
+	bool is_running() const;
+
+private:
+	struct SequenceStep {
+		int pos;
+		double value;
+		double delay;
+	};
+
+	/**
+	 * Get the step with the given index, counted from the start of the
+	 * first cycle. Returns false when the sequence has ended.
+	 */
+	bool get_step(uint64_t index, SequenceStep &step) const;
+	void sequencer_thread_proc();
+
+	shared_ptr<sv::data::properties::DoubleProperty> property_;
+	shared_ptr<channels::UserChannel> record_channel_;
+	data::Quantity record_quantity_;
+	set<data::QuantityFlag> record_quantity_flags_;
+	data::Unit record_unit_;
+	int record_digits_;
+	int record_decimal_places_;
+	vector<SequenceStep> sequence_;
+	shared_ptr<sv::data::Waveform> waveform_;
+	int repeat_count_;
+	std::thread sequencer_thread_;
+	std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	bool stop_requested_;
+	std::atomic<bool> is_running_;
+
+Q_SIGNALS:
+	/**
+	 * A step has been applied. pos is the position in the sequence passed
+	 * to set_sequence() or -1 for a waveform, timestamp is the actual time
+	 * of the config write.
+	 */
+	void step_applied(int pos, double value, double timestamp);
+	void finished();
+
+};
+
+} // namespace sv
+
+#endif // SEQUENCER_HPP
@@ -26,15 +26,21 @@
 #include <vector>
 
 #include <QDebug>
+#include <QFileInfo>
 
 #include "session.hpp"
 #include "config.h"
 #include "src/devicemanager.hpp"
 #include "src/util.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/mappedsessionfile.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/hardwaredevice.hpp"
 #include "src/devices/userdevice.hpp"
 #include "src/python/smuscriptrunner.hpp"
+#include "src/ui/widgets/plot/timeaxiscontroller.hpp"
 
 using std::list;
 using std::make_pair;
@@ -60,6 +66,9 @@ Session::Session(DeviceManager &device_manager) :
 	connect(smu_script_runner_.get(), &python::SmuScriptRunner::script_error,
 		this, &Session::error_handler);
 
+	time_axis_controller_ =
+		make_shared<ui::widgets::plot::TimeAxisController>();
+
 	// Connect devices
 	for (const auto &device : device_manager.user_spec_devices()) {
 		this->add_device(device);
@@ -68,6 +77,9 @@ Session::Session(DeviceManager &device_manager) :
 
 Session::~Session()
 {
+	// A running script uses the session and the devices.
+	smu_script_runner_->shutdown();
+
 	for (auto &device_pair_ : device_map_)
 		device_pair_.second->close();
 }
@@ -138,6 +150,56 @@ shared_ptr<devices::UserDevice> Session::add_user_device()
 	return device;
 }
 
+vector<shared_ptr<devices::UserDevice>> Session::open_session_file(
+	const string &file_name)
+{
+	vector<shared_ptr<devices::UserDevice>> devices;
+
+	data::MappedSessionFile session_file;
+	if (!session_file.open(file_name)) {
+		qWarning() << "Session::open_session_file(): Could not open file" <<
+			QString::fromStdString(file_name);
+		return devices;
+	}
+
+	string version = QFileInfo(
+		QString::fromStdString(file_name)).fileName().toStdString();
+	map<string, shared_ptr<devices::UserDevice>> device_map;
+	for (const auto &info : session_file.signals()) {
+		auto &device = device_map[info.device_name];
+		if (!device) {
+			device = make_shared<devices::UserDevice>(
+				sr_context, info.device_name, "Offline", version);
+			this->add_device(device);
+			devices.push_back(device);
+		}
+
+		shared_ptr<channels::BaseChannel> channel;
+		auto channel_map = device->channel_map();
+		if (channel_map.count(info.channel_name) > 0) {
+			channel = channel_map[info.channel_name];
+		}
+		else {
+			channel = make_shared<channels::UserChannel>(
+				info.channel_name, info.channel_group_names, device,
+				info.signal_start_timestamp);
+			if (info.channel_group_names.empty())
+				device->add_channel(channel, "");
+			for (const auto &chg_name : info.channel_group_names)
+				device->add_channel(channel, chg_name);
+		}
+
+		auto signal = make_shared<data::AnalogTimeSignal>(
+			info.quantity, info.quantity_flags, info.unit, channel,
+			info.signal_start_timestamp, info.signal_name);
+		signal->set_mapped_samples(session_file.samples(info.id),
+			info.digits, info.decimal_places);
+		channel->add_signal(signal);
+	}
+
+	return devices;
+}
+
 void Session::remove_device(shared_ptr<devices::BaseDevice> device)
 {
 	if (device) {
@@ -163,6 +225,12 @@ void Session::run_smu_script(const string &script_file)
 	smu_script_runner_->run(script_file);
 }
 
+shared_ptr<ui::widgets::plot::TimeAxisController>
+	Session::time_axis_controller()
+{
+	return time_axis_controller_;
+}
+
 void Session::set_main_window(MainWindow *main_window)
 {
 	main_window_ = main_window;
@@ -24,6 +24,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <QObject>
 #include <QSettings>
@@ -32,6 +33,7 @@ using std::list;
 using std::map;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sigrok {
 class Context;
@@ -52,6 +54,14 @@ namespace python {
 class SmuScriptRunner;
 }
 
+namespace ui {
+namespace widgets {
+namespace plot {
+class TimeAxisController;
+}
+}
+}
+
 class Session : public QObject
 {
 	Q_OBJECT
@@ -73,11 +83,22 @@ public:
 		const string &conn_string);
 	void add_device(shared_ptr<devices::BaseDevice> device);
 	shared_ptr<devices::UserDevice> add_user_device();
+	/**
+	 * Open a session file read only. A device is added for every device in
+	 * the file, the samples of the signals are memory mapped.
+	 *
+	 * @return The added devices. Empty, if the file could not be opened.
+	 */
+	vector<shared_ptr<devices::UserDevice>> open_session_file(
+		const string &file_name);
 	void remove_device(shared_ptr<devices::BaseDevice> device);
 
 	shared_ptr<python::SmuScriptRunner> smu_script_runner();
 	void run_smu_script(const string &script_file);
 
+	/** The shared time axis for linked time plots. */
+	shared_ptr<ui::widgets::plot::TimeAxisController> time_axis_controller();
+
 	void set_main_window(MainWindow *main_window);
 	MainWindow *main_window() const;
 
@@ -86,6 +107,7 @@ private:
 	map<string, shared_ptr<devices::BaseDevice>> device_map_;
 	MainWindow *main_window_;
 	shared_ptr<python::SmuScriptRunner> smu_script_runner_;
+	shared_ptr<ui::widgets::plot::TimeAxisController> time_axis_controller_;
 
 	void free_unused_memory();
 
@@ -17,10 +17,14 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <QDebug>
 #include <QStandardItem>
@@ -39,7 +43,11 @@
 
 using std::set;
 using std::shared_ptr;
+using std::make_pair;
+using std::pair;
 using std::string;
+using std::unordered_map;
+using std::vector;
 
 Q_DECLARE_SMART_POINTER_METATYPE(std::shared_ptr)
 
@@ -73,6 +81,9 @@ void DeviceTreeModel::setup_model()
 
 	setSortRole(DeviceTreeModel::SortRole);
 
+	connect(this, SIGNAL(itemChanged(QStandardItem *)),
+		this, SLOT(on_item_changed(QStandardItem *)));
+
 	connect(
 		&session_, SIGNAL(device_added(shared_ptr<sv::devices::BaseDevice>)),
 		this, SLOT(on_device_added(shared_ptr<sv::devices::BaseDevice>)));
@@ -109,6 +120,7 @@ void DeviceTreeModel::add_device(shared_ptr<sv::devices::BaseDevice> device)
 		device_item->setEditable(false);
 		invisibleRootItem()->appendRow(device_item);
 		endInsertRows();
+		index_item(device.get(), device_item);
 
 		invisibleRootItem()->sortChildren(0);
 
@@ -154,6 +166,7 @@ TreeItem *DeviceTreeModel::add_channel_group(const string &channel_group_name,
 	chg_item->setEditable(false);
 	device_item->appendRow(chg_item);
 	endInsertRows();
+	channel_group_items_map_[device_item][channel_group_name] = chg_item;
 
 	device_item->sortChildren(0);
 
@@ -178,8 +191,7 @@ void DeviceTreeModel::add_channel(shared_ptr<channels::BaseChannel> channel,
 		TreeItem *new_parent_item = add_channel_group(chg_name, parent_item);
 
 		// Look for existing channel
-		set<string> chg_names { chg_name };
-		TreeItem *channel_item = find_channel(channel, chg_names, parent_item);
+		TreeItem *channel_item = find_item(channel.get(), new_parent_item);
 		if (!channel_item) {
 			beginInsertRows(new_parent_item->index(),
 				new_parent_item->rowCount(), new_parent_item->rowCount()+1);
@@ -191,6 +203,7 @@ void DeviceTreeModel::add_channel(shared_ptr<channels::BaseChannel> channel,
 			channel_item->setEditable(false);
 			new_parent_item->appendRow(channel_item);
 			endInsertRows();
+			index_item(channel.get(), channel_item);
 
 			new_parent_item->sortChildren(0);
 		}
@@ -212,18 +225,25 @@ void DeviceTreeModel::add_signal(shared_ptr<sv::data::BaseSignal> signal,
 	// Look for existing signal
 	TreeItem *signal_item = find_signal(signal, parent_item);
 	if (!signal_item) {
-		beginInsertRows(parent_item->index(),
-			parent_item->rowCount(), parent_item->rowCount()+1);
+		// Insert the item at its sorted position, so the other children
+		// don't have to be sorted again.
+		int row = 0;
+		while (row < parent_item->rowCount() &&
+				QString::compare(
+					parent_item->child(row)->data(SortRole).toString(),
+					signal->display_name()) <= 0)
+			++row;
+
+		beginInsertRows(parent_item->index(), row, row);
 		signal_item = new TreeItem(TreeItemType::SignalItem);
 		signal_item->setText(signal->display_name());
 		signal_item->setData(QVariant::fromValue(signal), DeviceTreeModel::DataRole);
 		signal_item->setData(signal->display_name(), DeviceTreeModel::SortRole); // TODO: signal->index()
 		signal_item->setCheckable(is_signal_checkable_);
 		signal_item->setEditable(false);
-		parent_item->appendRow(signal_item);
+		parent_item->insertRow(row, signal_item);
 		endInsertRows();
-
-		parent_item->sortChildren(0);
+		index_item(signal.get(), signal_item);
 	}
 }
 
@@ -252,6 +272,7 @@ void DeviceTreeModel::add_configurable(
 		conf_item->setEditable(false);
 		new_parent_item->appendRow(conf_item);
 		endInsertRows();
+		index_item(configurable.get(), conf_item);
 
 		new_parent_item->sortChildren(0);
 	}
@@ -284,6 +305,7 @@ void DeviceTreeModel::add_property(
 		property_item->setEditable(false);
 		configurable_item->appendRow(property_item);
 		endInsertRows();
+		index_item(property.get(), property_item);
 
 		configurable_item->sortChildren(0);
 	}
@@ -292,31 +314,60 @@ void DeviceTreeModel::add_property(
 TreeItem *DeviceTreeModel::find_device(
 	shared_ptr<sv::devices::BaseDevice> device) const
 {
-	for (int i=0; i<invisibleRootItem()->rowCount(); ++i) {
-		auto child = invisibleRootItem()->child(i);
-		if (child->type() != (int)TreeItemType::DeviceItem)
-			continue;
+	// Device items are top level items, so they don't have a parent item.
+	return find_item(device.get(), nullptr);
+}
+
+vector<TreeItem *> DeviceTreeModel::find_channel_items(
+	shared_ptr<sv::channels::BaseChannel> channel) const
+{
+	const auto it = object_items_map_.find(channel.get());
+	if (it == object_items_map_.end())
+		return vector<TreeItem *>();
+	return it->second;
+}
+
+vector<TreeItem *> DeviceTreeModel::find_signal_items(
+	shared_ptr<sv::data::BaseSignal> signal) const
+{
+	const auto it = object_items_map_.find(signal.get());
+	if (it == object_items_map_.end())
+		return vector<TreeItem *>();
+	return it->second;
+}
 
-		if (device.get() == child->data(DeviceTreeModel::DataRole).
-				value<shared_ptr<sv::devices::BaseDevice>>().get())
-			return static_cast<TreeItem *>(child);
+vector<TreeItem *> DeviceTreeModel::checked_items(TreeItemType type) const
+{
+	// Sort the items by their rows from the root item down, so they are
+	// returned in the order of the tree.
+	vector<pair<vector<int>, TreeItem *>> path_items;
+	for (const auto &item : checked_items_) {
+		if (item->type() != (int)type)
+			continue;
+		vector<int> path;
+		for (const QStandardItem *i = item; i; i = i->parent())
+			path.insert(path.begin(), i->row());
+		path_items.push_back(make_pair(path, item));
 	}
-	return nullptr;
+	std::sort(path_items.begin(), path_items.end());
+
+	vector<TreeItem *> items;
+	for (const auto &path_item : path_items)
+		items.push_back(path_item.second);
+	return items;
 }
 
 TreeItem *DeviceTreeModel::find_channel_group(const string &channel_group_name,
 	TreeItem *parent_item) const
 {
-	for (int i=0; i<parent_item->rowCount(); ++i) {
-		auto child = parent_item->child(i);
-		if (child->type() != (int)TreeItemType::ChannelGroupItem)
-			continue;
-
-		QString chg_name_qstr = QString::fromStdString(channel_group_name);
-		if (chg_name_qstr == child->data(DeviceTreeModel::DataRole).toString())
-			return static_cast<TreeItem *>(child);
-	}
-	return nullptr;
+	const auto it = channel_group_items_map_.find(parent_item);
+	if (it == channel_group_items_map_.end())
+		return nullptr;
+
+	const auto chg_it = it->second.find(channel_group_name);
+	if (chg_it == it->second.end())
+		return nullptr;
+	return chg_it->second;
 }
 
 TreeItem *DeviceTreeModel::find_channel(
@@ -333,15 +384,9 @@ TreeItem *DeviceTreeModel::find_channel(
 		else
 			new_parent_item = parent_item;
 
-		for (int i=0; i<new_parent_item->rowCount(); ++i) {
-			auto child = new_parent_item->child(i);
-			if (child->type() != (int)TreeItemType::ChannelItem)
-				continue;
-
-			if (channel.get() == child->data(DeviceTreeModel::DataRole).
-					value<shared_ptr<sv::channels::BaseChannel>>().get())
-				return static_cast<TreeItem *>(child);
-		}
+		TreeItem *channel_item = find_item(channel.get(), new_parent_item);
+		if (channel_item)
+			return channel_item;
 	}
 	return nullptr;
 }
@@ -349,16 +394,7 @@ TreeItem *DeviceTreeModel::find_channel(
 TreeItem *DeviceTreeModel::find_signal (
 	shared_ptr<sv::data::BaseSignal> signal, TreeItem *parent_item) const
 {
-	for (int i=0; i<parent_item->rowCount(); ++i) {
-		auto child = parent_item->child(i);
-		if (child->type() != (int)TreeItemType::SignalItem)
-			continue;
-
-		if (signal.get() == child->data(DeviceTreeModel::DataRole).
-				value<shared_ptr<sv::data::BaseSignal>>().get())
-			return static_cast<TreeItem *>(child);
-	}
-	return nullptr;
+	return find_item(signal.get(), parent_item);
 }
 
 TreeItem *DeviceTreeModel::find_configurable(
@@ -375,30 +411,69 @@ TreeItem *DeviceTreeModel::find_configurable(
 		new_parent_item = device_item;
 	}
 
-	for (int i=0; i<new_parent_item->rowCount(); ++i) {
-		auto child = new_parent_item->child(i);
-		if (child->type() != (int)TreeItemType::ConfigurableItem)
-			continue;
-
-		if (configurable.get() == child->data(DeviceTreeModel::DataRole).
-				value<shared_ptr<sv::devices::Configurable>>().get())
-			return static_cast<TreeItem *>(child);
-	}
-	return nullptr;
+	return find_item(configurable.get(), new_parent_item);
 }
 
 TreeItem *DeviceTreeModel::find_property(
 	shared_ptr<sv::data::properties::BaseProperty> property,
 	TreeItem *configurable_item) const
 {
-	for (int i=0; i<configurable_item->rowCount(); ++i) {
-		auto child = configurable_item->child(i);
-		if (child->type() != (int)TreeItemType::PropertyItem)
-			continue;
+	return find_item(property.get(), configurable_item);
+}
 
-		if (property.get() == child->data(DeviceTreeModel::DataRole).
-				value<shared_ptr<sv::data::properties::BaseProperty>>().get())
-			return static_cast<TreeItem *>(child);
+void DeviceTreeModel::index_item(const void *object, TreeItem *item)
+{
+	object_items_map_[object].push_back(item);
+	item_object_map_[item] = object;
+	if (item->checkState() == Qt::Checked)
+		checked_items_.push_back(item);
+}
+
+void DeviceTreeModel::unindex_item(QStandardItem *item)
+{
+	for (int i=0; i<item->rowCount(); ++i) {
+		unindex_item(item->child(i));
+	}
+
+	channel_group_items_map_.erase(item);
+	if (item->type() == (int)TreeItemType::ChannelGroupItem) {
+		auto chg_it = channel_group_items_map_.find(item->parent());
+		if (chg_it != channel_group_items_map_.end()) {
+			chg_it->second.erase(
+				item->data(DeviceTreeModel::DataRole).toString().toStdString());
+		}
+	}
+
+	checked_items_.erase(
+		std::remove(checked_items_.begin(), checked_items_.end(), item),
+		checked_items_.end());
+
+	const auto obj_it = item_object_map_.find(item);
+	if (obj_it == item_object_map_.end())
+		return;
+
+	auto items_it = object_items_map_.find(obj_it->second);
+	if (items_it != object_items_map_.end()) {
+		auto &items = items_it->second;
+		items.erase(std::remove(items.begin(), items.end(), item), items.end());
+		if (items.empty())
+			object_items_map_.erase(items_it);
+	}
+	item_object_map_.erase(obj_it);
+}
+
+TreeItem *DeviceTreeModel::find_item(const void *object,
+	const QStandardItem *parent_item) const
+{
+	const auto it = object_items_map_.find(object);
+	if (it == object_items_map_.end())
+		return nullptr;
+
+	// There is only more than one item per object, when a channel is in
+	// multiple channel groups.
+	for (const auto &item : it->second) {
+		if (item->parent() == parent_item)
+			return item;
 	}
 	return nullptr;
 }
@@ -416,6 +491,7 @@ void DeviceTreeModel::on_device_removed(
 
 	TreeItem *item = find_device(device);
 	if (item) {
+		unindex_item(item);
 		removeRow(item->row(), invisibleRootItem()->index());
 	}
 }
@@ -438,8 +514,18 @@ void DeviceTreeModel::on_channel_removed(
 
 void DeviceTreeModel::on_signal_added(shared_ptr<sv::data::BaseSignal> signal)
 {
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+
 	shared_ptr<sv::channels::BaseChannel> channel = signal->parent_channel();
-	on_channel_added(channel);
+	const auto channel_items = find_channel_items(channel);
+	if (channel_items.empty()) {
+		on_channel_added(channel);
+		return;
+	}
+
+	// Only add the new signal to the existing channel items.
+	for (const auto &channel_item : channel_items)
+		add_signal(signal, channel_item);
 }
 
 void DeviceTreeModel::on_signal_removed(shared_ptr<sv::data::BaseSignal> signal)
@@ -448,6 +534,27 @@ void DeviceTreeModel::on_signal_removed(shared_ptr<sv::data::BaseSignal> signal)
 	std::lock_guard<std::recursive_mutex> lock(mutex_);
 }
 
+void DeviceTreeModel::on_item_changed(QStandardItem *item)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+	// Only indexed items are tracked, items that are about to be added are
+	// handled by index_item().
+	const auto obj_it = item_object_map_.find(item);
+	if (obj_it == item_object_map_.end())
+		return;
+
+	auto *tree_item = static_cast<TreeItem *>(item);
+	auto it = std::find(checked_items_.begin(), checked_items_.end(), tree_item);
+	if (item->checkState() == Qt::Checked) {
+		if (it == checked_items_.end())
+			checked_items_.push_back(tree_item);
+	}
+	else if (it != checked_items_.end()) {
+		checked_items_.erase(it);
+	}
+}
+
 } // namespace devicetree
 } // namespace devices
 } // namespace ui
@@ -24,6 +24,7 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <QStandardItem>
@@ -32,6 +33,7 @@
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::unordered_map;
 using std::vector;
 
 namespace sv {
@@ -57,6 +59,7 @@ namespace devices {
 namespace devicetree {
 
 class TreeItem;
+enum class TreeItemType;
 
 class DeviceTreeModel : public QStandardItemModel
 {
@@ -70,6 +73,17 @@ public:
 		bool show_configurable, QObject *parent = nullptr);
 
 	TreeItem *find_device(shared_ptr<sv::devices::BaseDevice> device) const;
+	/**
+	 * Return all items of the channel. A channel can be in more than one
+	 * channel group, so there may be more than one item per channel.
+	 */
+	vector<TreeItem *> find_channel_items(
+		shared_ptr<sv::channels::BaseChannel> channel) const;
+	/** Return all items of the signal (one per channel item). */
+	vector<TreeItem *> find_signal_items(
+		shared_ptr<sv::data::BaseSignal> signal) const;
+	/** Return the checked items of the given type, in the order of the tree. */
+	vector<TreeItem *> checked_items(TreeItemType type) const;
 
 	const static int DataRole = Qt::UserRole + 1;
 	const static int SortRole = Qt::UserRole + 2;
@@ -102,6 +116,14 @@ private:
 		shared_ptr<sv::data::properties::BaseProperty> property,
 		TreeItem *configurable_item) const;
 
+	/** Add the item of the object to the item indexes. */
+	void index_item(const void *object, TreeItem *item);
+	/** Remove the item and all its children from the item indexes. */
+	void unindex_item(QStandardItem *item);
+	/** Return the item of the object that is a child of parent_item. */
+	TreeItem *find_item(const void *object,
+		const QStandardItem *parent_item) const;
+
 	const Session &session_;
 	bool is_device_checkable_;
 	bool is_channel_group_checkable_;
@@ -111,6 +133,18 @@ private:
 	bool is_config_key_checkable_;
 	bool show_configurable_;
 	std::recursive_mutex mutex_;
+	/**
+	 * Indexes from the device, channel, signal, configurable and property
+	 * objects to their items and back, so the lookups don't have to walk
+	 * the children of an item.
+	 */
+	unordered_map<const void *, vector<TreeItem *>> object_items_map_;
+	unordered_map<const QStandardItem *, const void *> item_object_map_;
+	/** Channel group items by parent (device) item and channel group name. */
+	unordered_map<const QStandardItem *, unordered_map<string, TreeItem *>>
+		channel_group_items_map_;
+	/** The currently checked items, updated on every check state change. */
+	vector<TreeItem *> checked_items_;
 
 private Q_SLOTS:
 	void on_device_added(shared_ptr<sv::devices::BaseDevice> device);
@@ -119,6 +153,7 @@ private Q_SLOTS:
 	void on_channel_removed(shared_ptr<sv::channels::BaseChannel> channel);
 	void on_signal_added(shared_ptr<sv::data::BaseSignal> signal);
 	void on_signal_removed(shared_ptr<sv::data::BaseSignal> signal);
+	void on_item_changed(QStandardItem *item);
 
 };
 
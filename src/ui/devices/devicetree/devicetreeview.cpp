@@ -21,7 +21,6 @@
 
 #include <QDebug>
 #include <QItemSelectionModel>
-#include <QList>
 #include <QModelIndex>
 #include <QModelIndexList>
 #include <QTreeView>
@@ -94,25 +93,16 @@ void DeviceTreeView::check_channels(
 	if (!is_channel_checkable_)
 		return;
 
-	const QList<QStandardItem *> all_items =
-		tree_model_->findItems("", Qt::MatchContains | Qt::MatchRecursive);
-
 	// First uncheck all channels
-	for (const auto &item : all_items) {
-		if (item->type() == (int)TreeItemType::ChannelItem) {
-			item->setCheckState(Qt::Unchecked);
-		}
+	for (const auto &item :
+			tree_model_->checked_items(TreeItemType::ChannelItem)) {
+		item->setCheckState(Qt::Unchecked);
 	}
 
 	// Now check all channels that are in the channels vector
-	for (const auto &item : all_items) {
-		if (item->type() == (int)TreeItemType::ChannelItem) {
-			auto item_data =
-				item->data().value<shared_ptr<sv::channels::BaseChannel>>();
-			for (const auto &channel :channels) {
-				if (item_data.get() == channel.get())
-					item->setCheckState(Qt::Checked);
-			}
+	for (const auto &channel : channels) {
+		for (const auto &item : tree_model_->find_channel_items(channel)) {
+			item->setCheckState(Qt::Checked);
 		}
 	}
 }
@@ -125,14 +115,10 @@ vector<shared_ptr<sv::channels::BaseChannel>>
 	if (!is_channel_checkable_)
 		return channels;
 
-	const QList<QStandardItem *> all_items =
-		tree_model_->findItems("", Qt::MatchContains | Qt::MatchRecursive);
-	for (const auto &item : all_items) {
-		if (item->checkState() > 0 &&
-				item->type() == (int)TreeItemType::ChannelItem) {
-			channels.push_back(
-				item->data().value<shared_ptr<sv::channels::BaseChannel>>());
-		}
+	for (const auto &item :
+			tree_model_->checked_items(TreeItemType::ChannelItem)) {
+		channels.push_back(item->data(DeviceTreeModel::DataRole).
+			value<shared_ptr<sv::channels::BaseChannel>>());
 	}
 	return channels;
 }
@@ -143,25 +129,16 @@ void DeviceTreeView::check_signals(
 	if (!is_signal_checkable_)
 		return;
 
-	const QList<QStandardItem *> all_items =
-		tree_model_->findItems("", Qt::MatchContains | Qt::MatchRecursive);
-
 	// First uncheck all signals
-	for (const auto &item : all_items) {
-		if (item->type() == (int)TreeItemType::SignalItem) {
-			item->setCheckState(Qt::Unchecked);
-		}
+	for (const auto &item :
+			tree_model_->checked_items(TreeItemType::SignalItem)) {
+		item->setCheckState(Qt::Unchecked);
 	}
 
 	// Now check all signals that are in the signals vector
-	for (const auto &item : all_items) {
-		if (item->type() == (int)TreeItemType::SignalItem) {
-			auto item_data =
-				item->data().value<shared_ptr<sv::data::BaseSignal>>();
-			for (const auto &signal : signals) {
-				if (item_data.get() == signal.get())
-					item->setCheckState(Qt::Checked);
-			}
+	for (const auto &signal : signals) {
+		for (const auto &item : tree_model_->find_signal_items(signal)) {
+			item->setCheckState(Qt::Checked);
 		}
 	}
 }
@@ -174,14 +151,10 @@ vector<shared_ptr<sv::data::BaseSignal>>
 	if (!is_signal_checkable_)
 		return signals;
 
-	const QList<QStandardItem *> all_items =
-		tree_model_->findItems("", Qt::MatchContains | Qt::MatchRecursive);
-	for (const auto &item : all_items) {
-		if (item->checkState() > 0 &&
-				item->type() == (int)TreeItemType::SignalItem) {
-			signals.push_back(
-				item->data().value<shared_ptr<sv::data::BaseSignal>>());
-		}
+	for (const auto &item :
+			tree_model_->checked_items(TreeItemType::SignalItem)) {
+		signals.push_back(item->data(DeviceTreeModel::DataRole).
+			value<shared_ptr<sv::data::BaseSignal>>());
 	}
 	return signals;
 }
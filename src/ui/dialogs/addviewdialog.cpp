@@ -41,11 +41,13 @@
 #include "src/ui/devices/devicetree/devicetreeview.hpp"
 #include "src/ui/views/baseview.hpp"
 #include "src/ui/views/dataview.hpp"
+#include "src/ui/views/histogramview.hpp"
 #include "src/ui/views/powerpanelview.hpp"
 #include "src/ui/views/sequenceoutputview.hpp"
 #include "src/ui/views/timeplotview.hpp"
 #include "src/ui/views/valuepanelview.hpp"
 #include "src/ui/views/viewhelper.hpp"
+#include "src/ui/views/waterfallview.hpp"
 #include "src/ui/views/xyplotview.hpp"
 
 using std::set;
@@ -88,6 +90,8 @@ void AddViewDialog::setup_ui()
 	this->setup_ui_xy_plot_tab();
 	this->setup_ui_data_table_tab();
 	this->setup_ui_power_panel_tab();
+	this->setup_ui_histogram_tab();
+	this->setup_ui_waterfall_tab();
 	tab_widget_->setCurrentIndex(selected_tab_);
 	main_layout->addWidget(tab_widget_);
 
@@ -229,6 +233,38 @@ void AddViewDialog::setup_ui_power_panel_tab()
 	tab_widget_->addTab(pp_widget, title);
 }
 
+void AddViewDialog::setup_ui_histogram_tab()
+{
+	QString title(tr("Histogram"));
+	QWidget *histogram_widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+	histogram_widget->setLayout(layout);
+
+	histogram_signal_tree_ = new ui::devices::devicetree::DeviceTreeView(
+		session_, false, false, false, true, false, false, false, false);
+	histogram_signal_tree_->expand_device(device_);
+
+	layout->addWidget(histogram_signal_tree_);
+
+	tab_widget_->addTab(histogram_widget, title);
+}
+
+void AddViewDialog::setup_ui_waterfall_tab()
+{
+	QString title(tr("Waterfall"));
+	QWidget *waterfall_widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+	waterfall_widget->setLayout(layout);
+
+	waterfall_signal_tree_ = new ui::devices::devicetree::DeviceTreeView(
+		session_, false, false, false, true, false, false, false, false);
+	waterfall_signal_tree_->expand_device(device_);
+
+	layout->addWidget(waterfall_signal_tree_);
+
+	tab_widget_->addTab(waterfall_widget, title);
+}
+
 vector<ui::views::BaseView *> AddViewDialog::views()
 {
 	return views_;
@@ -323,6 +359,22 @@ void AddViewDialog::accept()
 			}
 		}
 		break;
+	case 7:
+		// Add histogram view
+		for (const auto &signal : histogram_signal_tree_->checked_signals()) {
+			auto view = new ui::views::HistogramView(session_);
+			view->set_signal(static_pointer_cast<data::AnalogTimeSignal>(signal));
+			views_.push_back(view);
+		}
+		break;
+	case 8:
+		// Add waterfall view
+		for (const auto &signal : waterfall_signal_tree_->checked_signals()) {
+			auto view = new ui::views::WaterfallView(session_);
+			view->set_signal(static_pointer_cast<data::AnalogTimeSignal>(signal));
+			views_.push_back(view);
+		}
+		break;
 	default:
 		break;
 	}
@@ -74,6 +74,8 @@ private:
 	void setup_ui_xy_plot_tab();
 	void setup_ui_data_table_tab();
 	void setup_ui_power_panel_tab();
+	void setup_ui_histogram_tab();
+	void setup_ui_waterfall_tab();
 
 	Session &session_;
 	const shared_ptr<sv::devices::BaseDevice> device_;
@@ -90,6 +92,8 @@ private:
 	ui::devices::devicetree::DeviceTreeView *data_table_signal_tree_;
 	ui::devices::SelectSignalWidget *ppanel_voltage_signal_widget_;
 	ui::devices::SelectSignalWidget *ppanel_current_signal_widget_;
+	ui::devices::devicetree::DeviceTreeView *histogram_signal_tree_;
+	ui::devices::devicetree::DeviceTreeView *waterfall_signal_tree_;
 	QDialogButtonBox *button_box_;
 
 public Q_SLOTS:
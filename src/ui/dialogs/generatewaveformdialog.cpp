@@ -18,6 +18,7 @@
  */
 
 #include <cmath>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -36,11 +37,13 @@
 #include "generatewaveformdialog.hpp"
 #include "src/data/properties/doubleproperty.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/waveform.hpp"
 
+using std::make_shared;
 using std::shared_ptr;
 using std::vector;
 
-Q_DECLARE_METATYPE(sv::ui::dialogs::WaveformType)
+Q_DECLARE_METATYPE(sv::data::WaveformType)
 
 namespace sv {
 namespace ui {
@@ -54,7 +57,9 @@ GenerateWaveformDialog::GenerateWaveformDialog(
 	max_value_(max_value),
 	step_(step),
 	decimals_(decimals),
-	unit_(unit)
+	unit_(unit),
+	waveform_(nullptr),
+	points_periode_(0)
 {
 	setup_ui();
 }
@@ -62,7 +67,9 @@ GenerateWaveformDialog::GenerateWaveformDialog(
 GenerateWaveformDialog::GenerateWaveformDialog(
 		shared_ptr<sv::data::properties::DoubleProperty> property,
 		QWidget *parent) :
-	QDialog(parent)
+	QDialog(parent),
+	waveform_(nullptr),
+	points_periode_(0)
 {
 	min_value_ = property->min();
 	max_value_ = property->max();
@@ -90,20 +97,20 @@ void GenerateWaveformDialog::setup_ui()
 
 	waveform_box_ = new QComboBox();
 	waveform_box_->addItem(tr("Sine"),
-		QVariant::fromValue(WaveformType::Sine));
+		QVariant::fromValue(data::WaveformType::Sine));
 	waveform_box_->addItem(tr("Square"),
-		QVariant::fromValue(WaveformType::Square));
+		QVariant::fromValue(data::WaveformType::Square));
 	waveform_box_->addItem(tr("Triangle"),
-		QVariant::fromValue(WaveformType::Triangle));
+		QVariant::fromValue(data::WaveformType::Triangle));
 	waveform_box_->addItem(tr("Sawtooth"),
-		QVariant::fromValue(WaveformType::Sawtooth));
+		QVariant::fromValue(data::WaveformType::Sawtooth));
 	waveform_box_->addItem(tr("Sawtooth inverted"),
-		QVariant::fromValue(WaveformType::SawtoothInv));
+		QVariant::fromValue(data::WaveformType::SawtoothInv));
 	connect(waveform_box_, SIGNAL(currentIndexChanged(int)),
 			this, SLOT(on_waveform_changed()));
 	layout->addRow(tr("Waveform"), waveform_box_);
 
-	QGroupBox *amp_group = new QGroupBox(tr("Min/Max - Amplitude"));
+	amp_group_ = new QGroupBox(tr("Min/Max - Amplitude"));
 	QHBoxLayout *amp_layout = new QHBoxLayout;
 	QFormLayout *ampmm_layout = new QFormLayout;
 	QFormLayout *ampf_layout = new QFormLayout;
@@ -149,10 +156,10 @@ void GenerateWaveformDialog::setup_ui()
 		this, SLOT(on_amp_offs_changed()));
 	ampf_layout->addRow(tr("Offset"), offset_box_);
 	amp_layout->addLayout(ampf_layout);
-	amp_group->setLayout(amp_layout);
-	layout->addRow(amp_group);
+	amp_group_->setLayout(amp_layout);
+	layout->addRow(amp_group_);
 
-	QGroupBox *freq_group = new QGroupBox(tr("Periode - Frequency"));
+	freq_group_ = new QGroupBox(tr("Periode - Frequency"));
 	QHBoxLayout *freq_layout = new QHBoxLayout;
 	QFormLayout *freqp_layout = new QFormLayout;
 	QFormLayout *freqf_layout = new QFormLayout;
@@ -178,8 +185,8 @@ void GenerateWaveformDialog::setup_ui()
 		this, SLOT(on_frequency_changed()));
 	freqf_layout->addRow(tr("Frequency"), frequency_box_);
 	freq_layout->addLayout(freqf_layout);
-	freq_group->setLayout(freq_layout);
-	layout->addRow(freq_group);
+	freq_group_->setLayout(freq_layout);
+	layout->addRow(freq_group_);
 
 	QGroupBox *samples_group = new QGroupBox(tr("Samples"));
 	QHBoxLayout *samples_layout = new QHBoxLayout;
@@ -199,7 +206,9 @@ void GenerateWaveformDialog::setup_ui()
 
 	sample_count_box_ = new QSpinBox();
 	sample_count_box_->setMinimum(0);
-	sample_count_box_->setMaximum(1000000);
+	// The samples are calculated on demand, so there is no need to limit
+	// the number of samples.
+	sample_count_box_->setMaximum(std::numeric_limits<int>::max());
 	connect(sample_count_box_, SIGNAL(valueChanged(int)),
 		this, SLOT(on_sample_cnt_changed()));
 	samplesc_layout->addRow(tr("Number of samples"), sample_count_box_);
@@ -207,7 +216,7 @@ void GenerateWaveformDialog::setup_ui()
 	samples_group->setLayout(samples_layout);
 	layout->addRow(samples_group);
 
-	QGroupBox *phi_group = new QGroupBox(tr("Phase offset"));
+	phi_group_ = new QGroupBox(tr("Phase offset"));
 	QHBoxLayout *phi_layout = new QHBoxLayout;
 	QFormLayout *phid_layout = new QFormLayout;
 	QFormLayout *phir_layout = new QFormLayout;
@@ -232,8 +241,8 @@ void GenerateWaveformDialog::setup_ui()
 		this, SLOT(on_phi_rad_changed()));
 	phir_layout->addRow(tr("%1 (rad)").arg(QChar(0x03C6)), phi_rad_box_);
 	phi_layout->addLayout(phir_layout);
-	phi_group->setLayout(phi_layout);
-	layout->addRow(phi_group);
+	phi_group_->setLayout(phi_layout);
+	layout->addRow(phi_group_);
 
 	button_box_ = new QDialogButtonBox(
 		QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal);
@@ -251,62 +260,49 @@ void GenerateWaveformDialog::setup_ui()
 	this->setLayout(layout);
 }
 
-vector<double> GenerateWaveformDialog::sequence_values() const
+void GenerateWaveformDialog::set_points(const vector<double> &times,
+	const vector<double> &values, double periode)
 {
-	return sequence_values_;
+	if (times.empty())
+		return;
+
+	// Only add the waveform type when the first points are set
+	if (point_times_.empty()) {
+		waveform_box_->addItem(tr("Interpolated table values"),
+			QVariant::fromValue(data::WaveformType::Arbitrary));
+	}
+
+	point_times_ = times;
+	point_values_ = values;
+	points_periode_ = periode;
 }
 
-vector<double> GenerateWaveformDialog::sequence_delays() const
+shared_ptr<sv::data::Waveform> GenerateWaveformDialog::waveform() const
 {
-	return sequence_delays_;
+	return waveform_;
 }
 
 void GenerateWaveformDialog::accept()
 {
-	double amplitude = amplitude_box_->value();
-	double offset = offset_box_->value();
-	double interval = interval_box_->value();
 	double periode;
-	double frequency;
 	// Get the most precise values for periode and frequency, because
 	// the values from the spin boxes are truncated!
-	if (frequency_box_->value() > 1) {
-		frequency = frequency_box_->value();
-		periode = 1 / frequency;
-	}
-	else {
+	if (frequency_box_->value() > 1)
+		periode = 1 / frequency_box_->value();
+	else
 		periode = periode_box_->value();
-		frequency = 1 / periode;
-	}
-	double phi = phi_rad_box_->value();
-	double omega = 2 * pi * frequency;
-
-	WaveformType w_type = waveform_box_->currentData().value<WaveformType>();
-	// NOTE: We must not rely on floating point types for loop termination.
-	//       Resolves clang-analyzer-security.FloatLoopCounter warnings.
-	double t = .0;
-	size_t const count = std::floor(periode / interval);
-	for (size_t i = 0; i < count; ++i) {
-		double x = omega * t + phi;
-		t += interval;
-		double value;
-		if (w_type == WaveformType::Sine)
-			value = std::sin(x);
-		else if (w_type == WaveformType::Square)
-			value = std::sin(x) < 0 ? -1 : 1;
-		else if (w_type == WaveformType::Triangle)
-			value = (std::asin(std::sin(x))) / (pi/2);
-		else if (w_type == WaveformType::Sawtooth)
-			// y = −arctan(cotan(x))
-			value = -1 * std::atan(1 / std::tan(x)) / (pi/2);
-		else if (w_type == WaveformType::SawtoothInv)
-			value = std::atan(1 / std::tan(x)) / (pi/2);
-		else
-			value = 0;
-
-		value = (amplitude * value) + offset;
-		sequence_values_.push_back(value);
-		sequence_delays_.push_back(interval);
+
+	waveform_ = make_shared<data::Waveform>();
+	waveform_->set_type(
+		waveform_box_->currentData().value<data::WaveformType>());
+	waveform_->set_amplitude(amplitude_box_->value());
+	waveform_->set_offset(offset_box_->value());
+	waveform_->set_periode(periode);
+	waveform_->set_phase(phi_rad_box_->value());
+	waveform_->set_interval(interval_box_->value());
+	if (waveform_->type() == data::WaveformType::Arbitrary) {
+		waveform_->set_periode(points_periode_);
+		waveform_->set_points(point_times_, point_values_);
 	}
 
 	QDialog::accept();
@@ -314,8 +310,21 @@ void GenerateWaveformDialog::accept()
 
 void GenerateWaveformDialog::on_waveform_changed()
 {
-	WaveformType w_type = waveform_box_->currentData().value<WaveformType>();
-	if (w_type == WaveformType::Sine || w_type == WaveformType::Triangle)
+	data::WaveformType w_type =
+		waveform_box_->currentData().value<data::WaveformType>();
+
+	// The arbitrary waveform is defined by the points only
+	bool is_arbitrary = w_type == data::WaveformType::Arbitrary;
+	amp_group_->setDisabled(is_arbitrary);
+	freq_group_->setDisabled(is_arbitrary);
+	phi_group_->setDisabled(is_arbitrary);
+	if (is_arbitrary) {
+		periode_box_->setValue(points_periode_);
+		return;
+	}
+
+	if (w_type == data::WaveformType::Sine ||
+			w_type == data::WaveformType::Triangle)
 		phi_deg_box_->setValue(270);
 	else
 		phi_deg_box_->setValue(0);
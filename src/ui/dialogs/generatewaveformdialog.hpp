@@ -28,6 +28,7 @@
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QDoubleSpinBox>
+#include <QGroupBox>
 #include <QSpinBox>
 
 using std::shared_ptr;
@@ -36,6 +37,7 @@ using std::vector;
 namespace sv {
 
 namespace data {
+class Waveform;
 namespace properties {
 class DoubleProperty;
 }
@@ -44,14 +46,6 @@ class DoubleProperty;
 namespace ui {
 namespace dialogs {
 
-enum class WaveformType {
-	Sine,
-	Square,
-	Triangle,
-	Sawtooth,
-	SawtoothInv,
-};
-
 class GenerateWaveformDialog : public QDialog
 {
 	Q_OBJECT
@@ -63,8 +57,13 @@ public:
 		shared_ptr<sv::data::properties::DoubleProperty> property,
 		QWidget *parent = nullptr);
 
-	vector<double> sequence_values() const;
-	vector<double> sequence_delays() const;
+	/**
+	 * Set the points for an arbitrary waveform, that interpolates between
+	 * the points. The times are relative to the start of the periode.
+	 */
+	void set_points(const vector<double> &times, const vector<double> &values,
+		double periode);
+	shared_ptr<sv::data::Waveform> waveform() const;
 
 private:
 	void setup_ui();
@@ -76,9 +75,14 @@ private:
 	double step_;
 	int decimals_;
 	QString unit_;
-	vector<double> sequence_values_;
-	vector<double> sequence_delays_;
+	shared_ptr<sv::data::Waveform> waveform_;
+	vector<double> point_times_;
+	vector<double> point_values_;
+	double points_periode_;
 	QComboBox *waveform_box_;
+	QGroupBox *amp_group_;
+	QGroupBox *freq_group_;
+	QGroupBox *phi_group_;
 	QDoubleSpinBox *min_value_box_;
 	QDoubleSpinBox *max_value_box_;
 	QDoubleSpinBox *amplitude_box_;
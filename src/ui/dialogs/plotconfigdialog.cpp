@@ -22,6 +22,7 @@
 #include <set>
 
 #include <QApplication>
+#include <QCheckBox>
 #include <QColor>
 #include <QColorDialog>
 #include <QComboBox>
@@ -191,6 +192,12 @@ void PlotConfigDialog::setup_ui_plot_mode_tab()
 	add_time_edit_->setText(QString("%1").arg(plot_->add_time(), 0, 'f'));
 	layout->addRow(tr("Add time"), add_time_edit_);
 
+	link_time_axis_check_ = new QCheckBox();
+	link_time_axis_check_->setToolTip(
+		tr("Share the time axis with all other linked time plots"));
+	link_time_axis_check_->setChecked(plot_->is_time_axis_linked());
+	layout->addRow(tr("Link time axis"), link_time_axis_check_);
+
 	switch (plot_->update_mode()) {
 	case widgets::plot::PlotUpdateMode::Additive:
 		setup_ui_additive();
@@ -363,6 +370,9 @@ void PlotConfigDialog::on_update_mode_changed()
 void PlotConfigDialog::accept()
 {
 	if (plot_type_ == views::PlotType::TimePlot) {
+		// Link first, so the new settings are applied to all linked plots.
+		plot_->set_time_axis_linked(link_time_axis_check_->isChecked());
+
 		QVariant update_mode_var = plot_update_mode_combobox_->currentData();
 		sv::ui::widgets::plot::PlotUpdateMode update_mode =
 			update_mode_var.value<sv::ui::widgets::plot::PlotUpdateMode>();
@@ -23,6 +23,7 @@
 #include <map>
 
 #include <QAbstractItemModel>
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDialog>
 #include <QDialogButtonBox>
@@ -87,6 +88,7 @@ private:
 	QComboBox *plot_update_mode_combobox_;
 	QLineEdit *time_span_edit_;
 	QLineEdit *add_time_edit_;
+	QCheckBox *link_time_axis_check_;
 	QComboBox *markers_box_pos_combobox_;
 	QTableWidget *color_table_;
 	QDialogButtonBox *button_box_;
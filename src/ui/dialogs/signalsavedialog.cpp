@@ -18,8 +18,6 @@
  */
 
 #include <cmath>
-#include <iostream>
-#include <fstream>
 #include <limits>
 #include <memory>
 #include <string>
@@ -41,13 +39,17 @@
 #include "src/util.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/data/analogtimesignal.hpp"
+#include "src/data/baseexporter.hpp"
+#include "src/data/csvexporter.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/sessionexporter.hpp"
+#include "src/data/srexporter.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/hardwaredevice.hpp"
 #include "src/ui/devices/devicetree/devicetreeview.hpp"
 
 using std::dynamic_pointer_cast;
-using std::ofstream;
+using std::make_shared;
 using std::string;
 
 Q_DECLARE_SMART_POINTER_METATYPE(std::shared_ptr)
@@ -61,7 +63,9 @@ SignalSaveDialog::SignalSaveDialog(const Session &session,
 		QWidget *parent) :
 	QDialog(parent),
 	session_(session),
-	selected_device_(selected_device)
+	selected_device_(selected_device),
+	exporter_(nullptr),
+	progress_dialog_(nullptr)
 {
 	setup_ui();
 
@@ -115,6 +119,13 @@ void SignalSaveDialog::setup_ui()
 	separator_edit_->setText(",");
 	form_layout->addRow(tr("CSV separator"), separator_edit_);
 
+	sr_samplerate_ = new QSpinBox();
+	sr_samplerate_->setRange(0, std::numeric_limits<int32_t>::max());
+	sr_samplerate_->setValue(0);
+	sr_samplerate_->setSuffix(" Hz");
+	sr_samplerate_->setSpecialValueText(tr("Auto"));
+	form_layout->addRow(tr("sigrok samplerate"), sr_samplerate_);
+
 	main_layout->addLayout(form_layout);
 
 	button_box_ = new QDialogButtonBox(
@@ -129,299 +140,78 @@ void SignalSaveDialog::setup_ui()
 	this->setLayout(main_layout);
 }
 
-void SignalSaveDialog::save(const QString &file_name)
+vector<shared_ptr<sv::data::AnalogTimeSignal>>
+	SignalSaveDialog::checked_signals() const
 {
-	ofstream output_file;
-	string str_file_name = file_name.toStdString();
-	vector<size_t> sample_counts;
-
-	output_file.open(str_file_name);
-
-	auto signals = device_tree_->checked_signals();
-	bool relative_time = !time_absolut_->isChecked();
-	string sep = separator_edit_->text().toStdString();
-	size_t max_sample_count = 0;
-
-	// Header
-	string start_sep;
-	string device_header_line;
-	string chg_name_header_line;
-	string ch_name_header_line;
-	string signal_name_header_line;
-	for (const auto &signal : signals) {
-		// Only handle AnalogSignals
+	// Only handle AnalogSignals
+	vector<shared_ptr<sv::data::AnalogTimeSignal>> signals;
+	for (const auto &signal : device_tree_->checked_signals()) {
 		auto analog_signal =
 			dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-		if (!analog_signal)
-			continue;
-
-		size_t sample_count = analog_signal->sample_count();
-		if (sample_count > max_sample_count)
-			max_sample_count = sample_count;
-		sample_counts.push_back(sample_count);
-
-		string name = analog_signal->name();
-		shared_ptr<sv::channels::BaseChannel> parent_channel =
-			analog_signal->parent_channel();
-
-		qWarning() << "SaveDialog::save(): signal.name() = " <<
-			QString::fromStdString(name);
-		qWarning() << "SaveDialog::save(): signal.parent_channel().name() = " <<
-			QString::fromStdString(parent_channel->name());
-		qWarning() << "SaveDialog::save(): signal.parent_channel().parent_device().name() = " <<
-			QString::fromStdString(parent_channel->parent_device()->name());
-
-		string chg_names;
-		string chg_sep;
-		for (const auto &chg_name : parent_channel->channel_group_names()) {
-			chg_names += chg_sep;
-			if (chg_name.empty())
-				chg_names += "\"\"";
-			else
-				chg_names += chg_name;
-			// TODO: Ugly workaround. Implement escaping or quotation characters?
-			chg_sep = sep == "," ? "; " : ", ";
-		}
-
-		device_header_line += start_sep;
-		device_header_line += parent_channel->parent_device()->name(); // Time
-		device_header_line += sep;
-		device_header_line += parent_channel->parent_device()->name(); // Value
-		chg_name_header_line += start_sep;
-		chg_name_header_line += chg_names; // Time
-		chg_name_header_line += sep;
-		chg_name_header_line += chg_names; // Value
-		ch_name_header_line += start_sep;
-		ch_name_header_line += parent_channel->name(); // Time
-		ch_name_header_line += sep;
-		ch_name_header_line += parent_channel->name(); // Value
-		signal_name_header_line += start_sep;
-		signal_name_header_line += "Time ";
-		signal_name_header_line += name; // Time
-		signal_name_header_line += sep;
-		signal_name_header_line += name; // Value
-
-		start_sep = sep;
-	}
-	output_file << device_header_line << std::endl;
-	output_file << chg_name_header_line << std::endl;
-	output_file << ch_name_header_line << std::endl;
-	output_file << signal_name_header_line << std::endl;
-
-	// Data
-	// TODO: we asume here, that the vector size is the same for all vectors....
-	for (size_t i = 0; i < max_sample_count; i++) {
-		start_sep = "";
-		QString line("");
-		int j = 0;
-		for (const auto &signal : signals) {
-			// Only handle AnalogSignals
-			auto analog_signal =
-				dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-			if (!analog_signal)
-				continue;
-
-			QString time("");
-			QString value("");
-
-			size_t sample_count = sample_counts[j];
-			if (i < sample_count-1) {
-				// More samples for this signal
-				auto sample = analog_signal->get_sample(i, relative_time);
-				value = QString("%1").arg(sample.second);
-				if (relative_time)
-					time = QString("%1").arg(sample.first, 0, 'f', 4);
-				else
-					time = util::format_time_date(sample.first);
-			}
-
-			line.append(QString("%1%2%3%4").arg(
-				QString::fromStdString(start_sep), time,
-				QString::fromStdString(sep), value));
-			start_sep = sep;
-
-			++j;
-		}
-		output_file << line.toStdString() << std::endl;
+		if (analog_signal)
+			signals.push_back(analog_signal);
 	}
-
-	output_file.close();
+	return signals;
 }
 
-void SignalSaveDialog::save_combined(const QString &file_name)
+void SignalSaveDialog::save(const QString &file_name)
 {
-	ofstream output_file;
-	string str_file_name = file_name.toStdString();
-	vector<size_t> sample_counts;
-	vector<size_t> sample_pos;
-
-	output_file.open(str_file_name);
-
 	double combined_timeframe = .0;
 	int combined_timeframe_ms = timestamps_combined_timeframe_->value();
 	if (combined_timeframe_ms != 0)
 		combined_timeframe = ((double)combined_timeframe_ms) / 1000;
 
-	auto signals = device_tree_->checked_signals();
-	bool relative_time = !time_absolut_->isChecked();
-	string sep = separator_edit_->text().toStdString();
-
-	// Header
-	string device_header_line("Time"); // Time
-	string chg_name_header_line("Time"); // Time
-	string ch_name_header_line("Time"); // Time
-	string signal_name_header_line("Time"); // Time
-	for (const auto &signal : signals) {
-		// Only handle AnalogSignals
-		auto analog_signal =
-			dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-		if (!analog_signal)
-			continue;
-
-		shared_ptr<sv::channels::BaseChannel> parent_channel =
-			analog_signal->parent_channel();
-
-		sample_counts.push_back(analog_signal->sample_count());
-		sample_pos.push_back(0);
-
-		string chg_names;
-		string chg_sep;
-		for (const auto &chg_name : parent_channel->channel_group_names()) {
-			chg_names += chg_sep;
-			if (chg_name.empty())
-				chg_names += "\"\"";
-			else
-				chg_names += chg_name;
-			// TODO: Ugly workaround. Implement escaping or quotation characters?
-			chg_sep = sep == "," ? "; " : ", ";
-		}
-
-		device_header_line += sep;
-		device_header_line += parent_channel->parent_device()->name(); // Value
-		chg_name_header_line += sep;
-		chg_name_header_line += chg_names; // Value
-		ch_name_header_line += sep;
-		ch_name_header_line += parent_channel->name(); // Value
-		signal_name_header_line += sep;
-		signal_name_header_line += analog_signal->name(); // Value
-	}
-	output_file << device_header_line << std::endl;
-	output_file << chg_name_header_line << std::endl;
-	output_file << ch_name_header_line << std::endl;
-	output_file << signal_name_header_line << std::endl;
-
-	// Data
-	while (true) {
-		double next_timestamp = -1;
-		int i = 0;
-		for (const auto &signal : signals) {
-			// Only handle AnalogSignals
-			auto analog_signal =
-				dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-			if (!analog_signal)
-				continue;
-
-			if (sample_pos[i] >= sample_counts[i]-1)
-				continue;
-
-			double timestamp =
-				analog_signal->get_sample(sample_pos[i], relative_time).first;
-			if (next_timestamp < 0 || timestamp < next_timestamp)
-				next_timestamp = timestamp;
-
-			++i;
-		}
-
-		if (next_timestamp < 0)
-			break;
-
-		// Timestamp
-		QString line;
-		if (relative_time)
-			line = QString("%1").arg(next_timestamp, 0, 'f', 4);
-		else
-			line = util::format_time_date(next_timestamp);
-
-		// Values
-		i = 0;
-		for (const auto &signal : signals) {
-			// Only handle AnalogSignals
-			auto analog_signal =
-				dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-			if (!analog_signal)
-				continue;
-
-			line.append(QString::fromStdString(sep));
-
-			auto sample =
-				analog_signal->get_sample(sample_pos[i], relative_time);
-			double timestamp = sample.first;
-			if (timestamp + combined_timeframe >= next_timestamp) {
-				line.append(QString("%1").arg(sample.second, 0, 'g', -1));
-				++sample_pos[i];
-			}
-
-			++i;
-		}
-		output_file << line.toStdString() << std::endl;
-	}
-
-	output_file.close();
+	auto exporter = make_shared<sv::data::CsvExporter>(
+		checked_signals(), file_name.toStdString());
+	exporter->set_separator(separator_edit_->text().toStdString());
+	exporter->set_relative_time(!time_absolut_->isChecked());
+	exporter->set_combine_timestamps(
+		timestamps_combined_->isChecked(), combined_timeframe);
+	start_export(exporter);
 }
 
-bool SignalSaveDialog::validate_combined_timeframe()
+void SignalSaveDialog::save_sr(const QString &file_name)
 {
-	int combined_timeframe_ms = timestamps_combined_timeframe_->value();
-	if (combined_timeframe_ms == 0)
-		return true;
-	const double combined_timeframe = ((double)combined_timeframe_ms) / 1000;
-
-	size_t num_signals = device_tree_->checked_signals().size();
-	size_t act_signal = 0;
-	QProgressDialog progress(tr("Validating combined timeframe ..."),
-		tr("Abort validation"), 0, num_signals, this);
-	progress.setMinimumDuration(500);
-	progress.setWindowModality(Qt::WindowModal);
-
-	double min_delta = combined_timeframe;
-	for (const auto &signal : device_tree_->checked_signals()) {
-		progress.setValue(act_signal++);
-		size_t count = signal->sample_count();
-		if (count < 2)
-			continue;
+	auto exporter = make_shared<sv::data::SrExporter>(
+		Session::sr_context, checked_signals(), file_name.toStdString());
+	exporter->set_samplerate((uint64_t)sr_samplerate_->value());
+	start_export(exporter);
+}
 
-		// Only handle AnalogSignals
-		auto analog_signal =
-			dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-		if (!analog_signal)
-			continue;
-
-		double ts1 = analog_signal->get_sample(0, false).first;
-		for (size_t i = 1; i<count; i++) {
-			const double ts2 = analog_signal->get_sample(i, false).first;
-			const double delta = ts2 - ts1;
-			if (delta < min_delta)
-				min_delta = delta;
-			ts1 = ts2;
-
-			if (progress.wasCanceled())
-				return false;
-		}
-	}
+QProgressDialog *SignalSaveDialog::create_progress_dialog()
+{
+	// The export runs in its own thread, the progress dialog only shows the
+	// progress and lets the user cancel the export.
+	auto progress_dialog = new QProgressDialog(tr("Saving signals ..."),
+		tr("Abort"), 0, 1000, this);
+	progress_dialog->setMinimumDuration(500);
+	progress_dialog->setWindowModality(Qt::WindowModal);
+	progress_dialog->setAutoClose(false);
+	progress_dialog->setAutoReset(false);
+	return progress_dialog;
+}
 
-	progress.setValue(num_signals);
+void SignalSaveDialog::save_session(const QString &file_name)
+{
+	start_export(make_shared<sv::data::SessionExporter>(
+		checked_signals(), file_name.toStdString()));
+}
 
-	if (min_delta < combined_timeframe) {
-		int min_delta_ms = (int)std::floor(min_delta * 1000);
-		QMessageBox::critical(this,
-			tr("Combination time frame too large"),
-			tr("The combination time frame is too large. Time span must be "
-				"smaller than %1 ms.").arg(min_delta_ms),
-			QMessageBox::Ok);
-		timestamps_combined_timeframe_->setValue(min_delta_ms - 1);
-		return false;
-	}
-	return true;
+void SignalSaveDialog::start_export(
+	shared_ptr<sv::data::BaseExporter> exporter)
+{
+	exporter_ = exporter;
+
+	progress_dialog_ = create_progress_dialog();
+	connect(exporter_.get(), &sv::data::BaseExporter::progress_changed,
+		progress_dialog_, &QProgressDialog::setValue);
+	connect(exporter_.get(), &sv::data::BaseExporter::finished,
+		this, &SignalSaveDialog::on_export_finished);
+	connect(progress_dialog_, &QProgressDialog::canceled,
+		exporter_.get(), &sv::data::BaseExporter::cancel);
+
+	button_box_->setDisabled(true);
+	exporter_->start();
 }
 
 void SignalSaveDialog::save_settings(QSettings &settings) const
@@ -434,6 +224,7 @@ void SignalSaveDialog::save_settings(QSettings &settings) const
 		timestamps_combined_timeframe_->value());
 	settings.setValue("time_absolut", time_absolut_->isChecked());
 	settings.setValue("csv_separator", separator_edit_->text());
+	settings.setValue("sr_samplerate", sr_samplerate_->value());
 	settings.setValue("file_dialog_path", file_dialog_path_);
 
 	settings.endGroup();
@@ -457,6 +248,9 @@ void SignalSaveDialog::restore_settings(QSettings &settings)
 	if (settings.contains("csv_separator")) {
 		separator_edit_->setText(settings.value("csv_separator").toString());
 	}
+	if (settings.contains("sr_samplerate")) {
+		sr_samplerate_->setValue(settings.value("sr_samplerate").toInt());
+	}
 	if (settings.contains("file_dialog_path")) {
 		file_dialog_path_ =
 			settings.value("file_dialog_path", QDir::homePath()).toString();
@@ -468,23 +262,31 @@ void SignalSaveDialog::restore_settings(QSettings &settings)
 void SignalSaveDialog::accept()
 {
 	// Get file name
+	const QString session_filter = tr("SmuView Session Files (*.svs)");
+	const QString sr_filter = tr("sigrok Session Files (*.sr)");
+	QString selected_filter;
 	QString file_name = QFileDialog::getSaveFileName(this,
-		tr("Save CSV-File"), file_dialog_path_, tr("CSV Files (*.csv)"));
+		tr("Save Signals"), file_dialog_path_,
+		tr("CSV Files (*.csv)") + ";;" + session_filter + ";;" + sr_filter,
+		&selected_filter);
 	if (file_name.isEmpty())
 		return;
 
 	file_dialog_path_ = QDir().absoluteFilePath(file_name);
 
-	if (timestamps_combined_->isChecked()) {
-		if (!validate_combined_timeframe())
-			return;
-		save_combined(file_name);
+	if (selected_filter == session_filter ||
+			file_name.endsWith(".svs", Qt::CaseInsensitive)) {
+		save_session(file_name);
+		return;
 	}
-	else {
-		save(file_name);
+	if (selected_filter == sr_filter ||
+			file_name.endsWith(".sr", Qt::CaseInsensitive)) {
+		save_sr(file_name);
+		return;
 	}
 
-	QDialog::accept();
+	// The dialog is closed when the export has finished.
+	save(file_name);
 }
 
 void SignalSaveDialog::done(int r)
@@ -495,6 +297,43 @@ void SignalSaveDialog::done(int r)
 	QDialog::done(r);
 }
 
+void SignalSaveDialog::on_export_finished(bool success)
+{
+	progress_dialog_->deleteLater();
+	progress_dialog_ = nullptr;
+	button_box_->setDisabled(false);
+
+	string error = exporter_->error();
+	bool timeframe_too_large = false;
+	double min_delta = 0.;
+	auto csv_exporter =
+		dynamic_pointer_cast<sv::data::CsvExporter>(exporter_);
+	if (csv_exporter) {
+		timeframe_too_large = csv_exporter->timeframe_too_large();
+		min_delta = csv_exporter->min_sample_delta();
+	}
+	exporter_ = nullptr;
+
+	if (success) {
+		QDialog::accept();
+		return;
+	}
+	if (timeframe_too_large) {
+		// The time between samples is checked while the signals are merged
+		int min_delta_ms = (int)std::floor(min_delta * 1000);
+		QMessageBox::critical(this,
+			tr("Combination time frame too large"),
+			tr("The combination time frame is too large. Time span must be "
+				"smaller than %1 ms.").arg(min_delta_ms),
+			QMessageBox::Ok);
+		timestamps_combined_timeframe_->setValue(min_delta_ms - 1);
+	}
+	else if (!error.empty()) {
+		QMessageBox::critical(this, tr("Save Signals"),
+			QString::fromStdString(error), QMessageBox::Ok);
+	}
+}
+
 void SignalSaveDialog::toggle_combined()
 {
 	timestamps_combined_timeframe_->setDisabled(
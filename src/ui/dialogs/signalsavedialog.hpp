@@ -27,6 +27,7 @@
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QLineEdit>
+#include <QProgressDialog>
 #include <QSettings>
 #include <QSpinBox>
 #include <QString>
@@ -39,6 +40,10 @@ using std::vector;
 
 namespace sv {
 
+namespace data {
+class AnalogTimeSignal;
+class BaseExporter;
+}
 namespace devices {
 class BaseDevice;
 }
@@ -64,9 +69,14 @@ public:
 
 private:
 	void setup_ui();
+	/** The checked analog signals. */
+	vector<shared_ptr<sv::data::AnalogTimeSignal>> checked_signals() const;
 	void save(const QString &file_name);
-	void save_combined(const QString &file_name);
-	bool validate_combined_timeframe();
+	void save_session(const QString &file_name);
+	void save_sr(const QString &file_name);
+	/** Start the export and show its progress. */
+	void start_export(shared_ptr<sv::data::BaseExporter> exporter);
+	QProgressDialog *create_progress_dialog();
 	void save_settings(QSettings &settings) const;
 	void restore_settings(QSettings &settings);
 
@@ -78,8 +88,12 @@ private:
 	QSpinBox *timestamps_combined_timeframe_;
 	QCheckBox *time_absolut_;
 	QLineEdit *separator_edit_;
+	/** The samplerate of a sigrok session export, 0 for automatic. */
+	QSpinBox *sr_samplerate_;
 	QDialogButtonBox *button_box_;
 	QString file_dialog_path_;
+	shared_ptr<sv::data::BaseExporter> exporter_;
+	QProgressDialog *progress_dialog_;
 
 public Q_SLOTS:
 	void accept() override;
@@ -88,6 +102,7 @@ public Q_SLOTS:
 
 private Q_SLOTS:
 	void toggle_combined();
+	void on_export_finished(bool success);
 
 };
 
@@ -22,6 +22,8 @@
 
 #include <QCloseEvent>
 #include <QDebug>
+#include <QDir>
+#include <QFileDialog>
 #include <QMainWindow>
 #include <QMessageBox>
 #include <QToolButton>
@@ -32,6 +34,8 @@
 #include "devicetab.hpp"
 #include "src/session.hpp"
 #include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/signalrecorder.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/deviceutil.hpp"
 #include "src/ui/dialogs/aboutdialog.hpp"
@@ -42,8 +46,11 @@
 #include "src/ui/tabs/tabdockwidget.hpp"
 #include "src/ui/views/viewhelper.hpp"
 
+using std::dynamic_pointer_cast;
+using std::make_shared;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 namespace ui {
@@ -57,6 +64,7 @@ DeviceTab::DeviceTab(Session &session,
 	device_(device),
 	action_aquire_(new QAction(this)),
 	action_save_as_(new QAction(this)),
+	action_record_(new QAction(this)),
 	action_add_control_view_(new QAction(this)),
 	action_add_panel_view_(new QAction(this)),
 	action_add_plot_view_(new QAction(this)),
@@ -113,6 +121,16 @@ void DeviceTab::setup_toolbar()
 	connect(action_save_as_, SIGNAL(triggered(bool)),
 		this, SLOT(on_action_save_as_triggered()));
 
+	action_record_->setText(tr("Record"));
+	action_record_->setIconText("");
+	action_record_->setIcon(
+		QIcon::fromTheme("media-record",
+		QIcon(":/icons/media-playback-start.png")));
+	action_record_->setCheckable(true);
+	action_record_->setChecked(false);
+	connect(action_record_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_record_triggered()));
+
 	action_add_control_view_->setText(tr("Add Control"));
 	action_add_control_view_->setIcon(
 		QIcon::fromTheme("mixer-front",
@@ -161,6 +179,7 @@ void DeviceTab::setup_toolbar()
 	toolbar_->addWidget(aquire_button_);
 	toolbar_->addSeparator();
 	toolbar_->addAction(action_save_as_);
+	toolbar_->addAction(action_record_);
 	toolbar_->addSeparator();
 	toolbar_->addAction(action_add_control_view_);
 	toolbar_->addAction(action_add_panel_view_);
@@ -248,6 +267,64 @@ void DeviceTab::on_action_save_as_triggered()
 	dlg.exec();
 }
 
+void DeviceTab::on_action_record_triggered()
+{
+	if (!action_record_->isChecked()) {
+		if (!recorder_)
+			return;
+		recorder_->stop();
+		recorder_ = nullptr;
+		action_record_->setText(tr("Record"));
+		return;
+	}
+
+	// Only handle AnalogSignals
+	vector<shared_ptr<sv::data::AnalogTimeSignal>> signals;
+	for (const auto &signal : device_->signals()) {
+		auto analog_signal =
+			dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
+		if (analog_signal)
+			signals.push_back(analog_signal);
+	}
+
+	QString file_name = QFileDialog::getSaveFileName(this,
+		tr("Record Signals"), QDir::homePath(),
+		tr("SmuView Session Files (*.svs)"));
+	if (file_name.isEmpty() || signals.empty()) {
+		action_record_->setChecked(false);
+		return;
+	}
+
+	recorder_ = make_shared<sv::data::SignalRecorder>(
+		signals, file_name.toStdString());
+	// Queued, so the recorder isn't destroyed by the slot while it is still
+	// in one of its methods.
+	connect(recorder_.get(), &sv::data::SignalRecorder::recording_error,
+		this, &DeviceTab::on_recording_error, Qt::QueuedConnection);
+	if (!recorder_->start()) {
+		QMessageBox::critical(this, tr("Record Signals"),
+			QString::fromStdString(recorder_->error()), QMessageBox::Ok);
+		recorder_ = nullptr;
+		action_record_->setChecked(false);
+		return;
+	}
+	action_record_->setText(tr("Stop Recording"));
+}
+
+void DeviceTab::on_recording_error(const QString &error)
+{
+	// The error could be from a recording, that has already been stopped.
+	if (!recorder_ || sender() != recorder_.get())
+		return;
+
+	recorder_->stop();
+	recorder_ = nullptr;
+	action_record_->setChecked(false);
+	action_record_->setText(tr("Record"));
+
+	QMessageBox::critical(this, tr("Record Signals"), error, QMessageBox::Ok);
+}
+
 void DeviceTab::on_action_add_control_view_triggered()
 {
 	shared_ptr<sv::devices::BaseDevice> d = nullptr;
@@ -17,20 +17,24 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
-#include <mutex>
-#include <set>
 #include <string>
+#include <vector>
 
+#include <QAbstractTableModel>
 #include <QAction>
 #include <QDebug>
-#include <QList>
+#include <QHeaderView>
+#include <QModelIndex>
 #include <QSettings>
-#include <QScrollBar>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QString>
+#include <QTableView>
+#include <QTimer>
 #include <QToolBar>
 #include <QUuid>
+#include <QVariant>
 #include <QVBoxLayout>
 
 #include "dataview.hpp"
@@ -48,11 +52,161 @@
 
 using std::shared_ptr;
 using std::dynamic_pointer_cast;
+using std::vector;
 
 namespace sv {
 namespace ui {
 namespace views {
 
+DataTableModel::DataTableModel(QObject *parent) :
+	QAbstractTableModel(parent)
+{
+}
+
+void DataTableModel::add_signal(shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	int column = (int)signals_.size() + 1;
+	beginInsertColumns(QModelIndex(), column, column);
+	signals_.push_back(signal);
+	next_signal_pos_.push_back(0);
+	endInsertColumns();
+
+	update_rows();
+}
+
+void DataTableModel::clear_rows()
+{
+	beginResetModel();
+	timestamps_.clear();
+	std::fill(next_signal_pos_.begin(), next_signal_pos_.end(), 0);
+	endResetModel();
+}
+
+void DataTableModel::update_rows()
+{
+	for (size_t i=0; i<signals_.size(); ++i) {
+		if (signals_[i]->sample_count() < next_signal_pos_[i]) {
+			// A signal has been cleared, rebuild the time index.
+			clear_rows();
+			break;
+		}
+	}
+
+	new_timestamps_.clear();
+	for (size_t i=0; i<signals_.size(); ++i) {
+		const size_t signal_size = signals_[i]->sample_count();
+		for (; next_signal_pos_[i] < signal_size; ++next_signal_pos_[i]) {
+			new_timestamps_.push_back(
+				signals_[i]->get_sample(next_signal_pos_[i], false).first);
+		}
+	}
+	if (new_timestamps_.empty())
+		return;
+
+	// The samples of each signal are in order, but the signals are not
+	// synchronized. Samples with the same timestamp share a row.
+	std::sort(new_timestamps_.begin(), new_timestamps_.end());
+	new_timestamps_.erase(
+		std::unique(new_timestamps_.begin(), new_timestamps_.end()),
+		new_timestamps_.end());
+
+	const size_t old_row_count = timestamps_.size();
+	if (timestamps_.empty() || new_timestamps_.front() > timestamps_.back()) {
+		// This is the normal case: Append all new rows at once.
+		beginInsertRows(QModelIndex(), (int)old_row_count,
+			(int)(old_row_count + new_timestamps_.size() - 1));
+		timestamps_.insert(timestamps_.end(),
+			new_timestamps_.begin(), new_timestamps_.end());
+		endInsertRows();
+		return;
+	}
+
+	// Some new timestamps are older than the last row: Merge the new
+	// timestamps with the tail of the time index, add the number of new rows
+	// at the end and notify the view about the changed rows.
+	auto first = std::lower_bound(timestamps_.begin(), timestamps_.end(),
+		new_timestamps_.front());
+	const size_t first_changed_row = first - timestamps_.begin();
+	vector<double> merged;
+	merged.reserve(timestamps_.end() - first + new_timestamps_.size());
+	std::merge(first, timestamps_.end(),
+		new_timestamps_.begin(), new_timestamps_.end(),
+		std::back_inserter(merged));
+	merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+
+	const size_t new_row_count = first_changed_row + merged.size();
+	if (new_row_count > old_row_count) {
+		beginInsertRows(QModelIndex(),
+			(int)old_row_count, (int)new_row_count - 1);
+	}
+	timestamps_.resize(first_changed_row);
+	timestamps_.insert(timestamps_.end(), merged.begin(), merged.end());
+	if (new_row_count > old_row_count)
+		endInsertRows();
+
+	if (old_row_count > first_changed_row) {
+		Q_EMIT dataChanged(
+			index((int)first_changed_row, 0),
+			index((int)old_row_count - 1, columnCount() - 1));
+	}
+}
+
+int DataTableModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return (int)timestamps_.size();
+}
+
+int DataTableModel::columnCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return (int)signals_.size() + 1;
+}
+
+QVariant DataTableModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || role != Qt::DisplayRole)
+		return QVariant();
+
+	const size_t row = index.row();
+	if (row >= timestamps_.size())
+		return QVariant();
+	const double timestamp = timestamps_[row];
+
+	// The time is relative to the start of the first signal.
+	if (index.column() == 0) {
+		return QString::number(
+			timestamp - signals_.front()->signal_start_timestamp(), 'f', 3);
+	}
+
+	const auto &signal = signals_[index.column() - 1];
+	const size_t pos = signal->lower_bound_pos(timestamp, false);
+	if (pos >= signal->sample_count())
+		return QVariant();
+	auto sample = signal->get_sample(pos, false);
+	if (sample.first != timestamp)
+		return QVariant();
+	return QString::number(sample.second, 'f', signal->decimal_places());
+}
+
+QVariant DataTableModel::headerData(int section, Qt::Orientation orientation,
+	int role) const
+{
+	if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+		if (section == 0)
+			return tr("Time [s]");
+		if (section <= (int)signals_.size())
+			return signals_[section - 1]->display_name();
+	}
+	if (orientation == Qt::Horizontal && role == Qt::TextAlignmentRole)
+		return QVariant(Qt::AlignVCenter);
+
+	return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+
 DataView::DataView(Session &session, QUuid uuid, QWidget *parent) :
 	BaseView(session, uuid, parent),
 	auto_scroll_(true),
@@ -63,6 +217,11 @@ DataView::DataView(Session &session, QUuid uuid, QWidget *parent) :
 
 	setup_ui();
 	setup_toolbar();
+
+	// The new samples are added to the table in batches.
+	timer_ = new QTimer(this);
+	connect(timer_, &QTimer::timeout, this, &DataView::populate_table);
+	timer_->start(100);
 }
 
 QString DataView::title() const
@@ -77,12 +236,12 @@ void DataView::setup_ui()
 {
 	QVBoxLayout *layout = new QVBoxLayout();
 
-	data_table_ = new QTableWidget();
-	data_table_->setColumnCount(1);
-	QTableWidgetItem *time_header_item = new QTableWidgetItem(tr("Time [s]"));
-	time_header_item->setTextAlignment(Qt::AlignVCenter);
-	data_table_->setHorizontalHeaderItem(0, time_header_item);
+	data_model_ = new DataTableModel(this);
+	data_table_ = new QTableView();
+	data_table_->setModel(data_model_);
 	data_table_->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+	// Fixed row heights, so the view doesn't have to measure all rows.
+	data_table_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
 	layout->addWidget(data_table_);
 
 	this->central_widget_->setLayout(layout);
@@ -149,85 +308,18 @@ void DataView::restore_settings(QSettings &settings,
 void DataView::add_signal(shared_ptr<sv::data::AnalogTimeSignal> signal)
 {
 	signals_.push_back(signal);
-	next_signal_pos_.push_back(0);
-	last_timestamp_.push_back(nullptr);
-	size_t pos = signals_.size();
-
-	QTableWidgetItem *value_header_item = new QTableWidgetItem(
-		signal->display_name());
-	value_header_item->setTextAlignment(Qt::AlignVCenter);
-	data_table_->insertColumn(pos);
-	data_table_->setHorizontalHeaderItem(pos, value_header_item);
-
-	this->populate_table();
-	connect(signal.get(), &data::AnalogBaseSignal::sample_appended,
-		this, &DataView::populate_table);
+	data_model_->add_signal(signal);
+	if (auto_scroll_)
+		data_table_->scrollToBottom();
 
 	Q_EMIT title_changed();
 }
 
 void DataView::populate_table()
 {
-	std::unique_lock<std::mutex> lock(populate_mutex_, std::try_to_lock);
-	if (!lock.owns_lock())
-		return;
-
-	for (size_t i=0; i<signals_.size(); ++i) {
-		size_t signal_size = signals_[i]->sample_count();
-		while (next_signal_pos_[i] < signal_size) {
-			auto sample = signals_[i]->get_sample(next_signal_pos_[i], true);
-			int row_count  = data_table_->rowCount();
-
-			int last_row  = -1;
-			if (last_timestamp_[i])
-				last_row = data_table_->row(last_timestamp_[i]);
-
-			bool new_row = false;
-			if (row_count <= last_row+1) {
-				data_table_->insertRow(last_row+1);
-				new_row = true;
-			}
-			else {
-				// Find position of new sample
-				while (last_row+1 < row_count) {
-					auto item = data_table_->item(last_row+1, 0);
-					double timestamp = item->data(0).toDouble();
-					if (timestamp > sample.first) {
-						data_table_->insertRow(last_row+1);
-						new_row = true;
-						break;
-					}
-					if (timestamp == sample.first) {
-						last_timestamp_[i] = item;
-						new_row = false;
-						break;
-					}
-					if (row_count == last_row+2) {
-						++last_row;
-						data_table_->insertRow(last_row+1);
-						new_row = true;
-						break;
-					}
-					last_row++;
-				}
-			}
-
-			if (new_row) {
-				QTableWidgetItem *time_item = new QTableWidgetItem(
-					QString::number(sample.first, 'f', 3));
-				time_item->setData(0, QVariant(sample.first));
-				data_table_->setItem(last_row+1, 0, time_item);
-				last_timestamp_[i] = time_item;
-			}
-			QTableWidgetItem *value_item = new QTableWidgetItem(
-				QString::number(sample.second, 'f', signals_[i]->decimal_places()));
-			value_item->setData(0, QVariant(sample.second));
-			data_table_->setItem(last_row+1, (int)i+1, value_item);
-
-			++next_signal_pos_[i];
-		}
-	}
-	if (auto_scroll_)
+	const int row_count = data_model_->rowCount();
+	data_model_->update_rows();
+	if (auto_scroll_ && data_model_->rowCount() != row_count)
 		data_table_->scrollToBottom();
 }
 
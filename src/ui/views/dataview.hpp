@@ -21,14 +21,17 @@
 #define UI_VIEWS_DATAVIEW_HPP
 
 #include <memory>
-#include <mutex>
 #include <vector>
 
+#include <QAbstractTableModel>
 #include <QAction>
+#include <QModelIndex>
 #include <QSettings>
-#include <QTableWidget>
+#include <QTableView>
+#include <QTimer>
 #include <QToolBar>
 #include <QUuid>
+#include <QVariant>
 
 #include "src/ui/views/baseview.hpp"
 
@@ -49,6 +52,43 @@ class BaseDevice;
 namespace ui {
 namespace views {
 
+/**
+ * Table model for the DataView.
+ *
+ * The rows are the merged (sorted and unique) timestamps of all signals. The
+ * cells are not stored, they are read from the signals when they are
+ * displayed. New samples are added to the time index in batches by
+ * update_rows().
+ */
+class DataTableModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	explicit DataTableModel(QObject *parent = nullptr);
+
+	void add_signal(shared_ptr<sv::data::AnalogTimeSignal> signal);
+	/** Add the new samples of all signals to the time index. */
+	void update_rows();
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index, int role) const override;
+	QVariant headerData(int section, Qt::Orientation orientation,
+		int role) const override;
+
+private:
+	vector<shared_ptr<sv::data::AnalogTimeSignal>> signals_;
+	vector<size_t> next_signal_pos_;
+	/** The merged timestamps of all signals (absolute time). */
+	vector<double> timestamps_;
+	/** Buffer for the new timestamps in update_rows(). */
+	vector<double> new_timestamps_;
+
+	void clear_rows();
+
+};
+
 class DataView : public BaseView
 {
 	Q_OBJECT
@@ -67,15 +107,14 @@ public:
 
 private:
 	vector<shared_ptr<sv::data::AnalogTimeSignal>> signals_;
-	vector<size_t> next_signal_pos_;
-	vector<QTableWidgetItem *> last_timestamp_;
 	bool auto_scroll_;
-	std::mutex populate_mutex_;
 
 	QAction *const action_auto_scroll_;
 	QAction *const action_add_signal_;
 	QToolBar *toolbar_;
-	QTableWidget *data_table_;
+	DataTableModel *data_model_;
+	QTableView *data_table_;
+	QTimer *timer_;
 
 	void setup_ui();
 	void setup_toolbar();
@@ -21,6 +21,8 @@
 
 #include <QAction>
 #include <QDebug>
+#include <QDir>
+#include <QFileDialog>
 #include <QMessageBox>
 #include <QSettings>
 #include <QToolBar>
@@ -60,6 +62,7 @@ DevicesView::DevicesView(Session &session, QUuid uuid, QWidget *parent) :
 	BaseView(session, uuid, parent),
 	action_add_device_(new QAction(this)),
 	action_add_userdevice_(new QAction(this)),
+	action_open_session_file_(new QAction(this)),
 	action_disconnect_device_(new QAction(this))
 {
 	id_ = "devices:" + util::format_uuid(uuid_);
@@ -101,6 +104,13 @@ void DevicesView::setup_toolbar()
 	connect(action_add_userdevice_, SIGNAL(triggered(bool)),
 		this, SLOT(on_action_add_userdevice_triggered()));
 
+	action_open_session_file_->setText(tr("Open session file"));
+	action_open_session_file_->setIcon(
+		QIcon::fromTheme("document-open",
+		QIcon(":/icons/document-open.png")));
+	connect(action_open_session_file_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_open_session_file_triggered()));
+
 	action_disconnect_device_->setText(tr("Disconnect device"));
 	action_disconnect_device_->setIcon(
 		QIcon::fromTheme("edit-delete",
@@ -111,6 +121,7 @@ void DevicesView::setup_toolbar()
 	toolbar_ = new QToolBar("Device Tree Toolbar");
 	toolbar_->addAction(action_add_device_);
 	toolbar_->addAction(action_add_userdevice_);
+	toolbar_->addAction(action_open_session_file_);
 	toolbar_->addSeparator();
 	toolbar_->addAction(action_disconnect_device_);
 	this->addToolBar(Qt::TopToolBarArea, toolbar_);
@@ -154,6 +165,26 @@ void DevicesView::on_action_add_userdevice_triggered()
 	session().main_window()->add_device_tab(device);
 }
 
+void DevicesView::on_action_open_session_file_triggered()
+{
+	QString file_name = QFileDialog::getOpenFileName(this,
+		tr("Open Session File"), QDir::homePath(),
+		tr("SmuView Session Files (*.svs)"));
+	if (file_name.isEmpty())
+		return;
+
+	auto devices = session().open_session_file(file_name.toStdString());
+	if (devices.empty()) {
+		QMessageBox::critical(this, tr("Open Session File"),
+			tr("Could not open session file \"%1\"!").arg(file_name),
+			QMessageBox::Ok);
+		return;
+	}
+
+	for (const auto &device : devices)
+		session().main_window()->add_device_tab(device);
+}
+
 void DevicesView::on_action_disconnect_device_triggered()
 {
 	TreeItem *item = device_tree_->selected_item();
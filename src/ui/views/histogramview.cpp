@@ -0,0 +1,291 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <memory>
+
+#include <QDebug>
+#include <QLabel>
+#include <QSettings>
+#include <QSpinBox>
+#include <QTimer>
+#include <QUuid>
+#include <QVariant>
+#include <QVBoxLayout>
+#include <QVector>
+#include <qwt_interval.h>
+#include <qwt_plot.h>
+#include <qwt_plot_grid.h>
+#include <qwt_plot_histogram.h>
+#include <qwt_samples.h>
+
+#include "histogramview.hpp"
+#include "src/session.hpp"
+#include "src/settingsmanager.hpp"
+#include "src/util.hpp"
+#include "src/data/analogbasesignal.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/histogram.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/ui/views/baseview.hpp"
+#include "src/ui/widgets/plot/curve.hpp"
+
+using std::dynamic_pointer_cast;
+using std::shared_ptr;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+HistogramView::HistogramView(Session &session, QUuid uuid, QWidget *parent) :
+	BaseView(session, uuid, parent),
+	signal_(nullptr),
+	next_signal_pos_(0),
+	histogram_(bin_count_),
+	histogram_changed_(false),
+	action_reset_(new QAction(this))
+{
+	id_ = "histogram:" + util::format_uuid(uuid_);
+
+	setup_ui();
+	setup_toolbar();
+
+	// The bins are updated with every new sample, but the plot is only
+	// repainted periodically.
+	timer_ = new QTimer(this);
+	connect(timer_, &QTimer::timeout, this, &HistogramView::on_update);
+	timer_->start(250);
+}
+
+QString HistogramView::title() const
+{
+	QString title = tr("Histogram");
+	if (signal_)
+		title = title.append(" ").append(signal_->display_name());
+	return title;
+}
+
+void HistogramView::set_signal(shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	assert(signal);
+
+	disconnect_signal();
+	signal_ = signal;
+
+	plot_->setAxisTitle(QwtPlot::xBottom, QString("%1 [%2]").arg(
+		data::datautil::format_quantity(signal_->quantity()),
+		data::datautil::format_unit(
+			signal_->unit(), signal_->quantity_flags())));
+	QColor color = widgets::plot::Curve::default_color(
+		signal_->quantity(), signal_->quantity_flags());
+	plot_histogram_->setPen(color);
+	color.setAlpha(160);
+	plot_histogram_->setBrush(color);
+
+	reset_histogram();
+	connect_signal();
+
+	Q_EMIT title_changed();
+}
+
+void HistogramView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	plot_ = new QwtPlot();
+	plot_->setAutoReplot(false);
+	plot_->setMinimumSize(250, 250);
+	plot_->setAxisTitle(QwtPlot::yLeft, tr("Count"));
+	plot_->setAxisAutoScale(QwtPlot::xBottom, true);
+	plot_->setAxisAutoScale(QwtPlot::yLeft, true);
+
+	QwtPlotGrid *grid = new QwtPlotGrid();
+	grid->setPen(Qt::gray, 0.0, Qt::DotLine);
+	grid->enableX(true);
+	grid->enableY(true);
+	grid->attach(plot_);
+
+	plot_histogram_ = new QwtPlotHistogram();
+	plot_histogram_->setStyle(QwtPlotHistogram::Columns);
+	plot_histogram_->attach(plot_);
+
+	layout->addWidget(plot_);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void HistogramView::setup_toolbar()
+{
+	action_reset_->setText(tr("Reset histogram"));
+	action_reset_->setIcon(
+		QIcon::fromTheme("view-refresh",
+		QIcon(":/icons/view-refresh.png")));
+	connect(action_reset_, &QAction::triggered,
+		this, &HistogramView::on_action_reset_triggered);
+
+	window_size_spin_box_ = new QSpinBox();
+	window_size_spin_box_->setRange(0, 100000000);
+	window_size_spin_box_->setSingleStep(1000);
+	window_size_spin_box_->setSpecialValueText(tr("All samples"));
+	window_size_spin_box_->setSuffix(tr(" samples"));
+	window_size_spin_box_->setToolTip(
+		tr("Only use the last n samples for the histogram"));
+	window_size_spin_box_->setValue(0);
+	connect(window_size_spin_box_, &QSpinBox::editingFinished,
+		this, &HistogramView::on_window_size_changed);
+
+	toolbar_ = new QToolBar("Histogram View Toolbar");
+	toolbar_->addAction(action_reset_);
+	toolbar_->addSeparator();
+	toolbar_->addWidget(new QLabel(tr("Window:")));
+	toolbar_->addWidget(window_size_spin_box_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void HistogramView::connect_signal()
+{
+	if (!signal_)
+		return;
+
+	connect(signal_.get(), &data::AnalogBaseSignal::sample_appended,
+		this, &HistogramView::on_sample_appended);
+	connect(signal_.get(), &data::AnalogBaseSignal::samples_cleared,
+		this, &HistogramView::on_sample_appended);
+}
+
+void HistogramView::disconnect_signal()
+{
+	if (!signal_)
+		return;
+
+	disconnect(signal_.get(), &data::AnalogBaseSignal::sample_appended,
+		this, &HistogramView::on_sample_appended);
+	disconnect(signal_.get(), &data::AnalogBaseSignal::samples_cleared,
+		this, &HistogramView::on_sample_appended);
+}
+
+void HistogramView::reset_histogram()
+{
+	histogram_.clear();
+	histogram_changed_ = true;
+	next_signal_pos_ = 0;
+
+	// Take all existing samples of the signal (or the last n samples, when
+	// a window is set).
+	if (signal_ && histogram_.window_size() > 0 &&
+			signal_->sample_count() > histogram_.window_size())
+		next_signal_pos_ = signal_->sample_count() - histogram_.window_size();
+
+	on_sample_appended();
+}
+
+void HistogramView::save_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device) const
+{
+	BaseView::save_settings(settings, origin_device);
+
+	if (signal_)
+		SettingsManager::save_signal(signal_, settings, origin_device);
+	settings.setValue("window_size",
+		QVariant::fromValue<qulonglong>(histogram_.window_size()));
+}
+
+void HistogramView::restore_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device)
+{
+	BaseView::restore_settings(settings, origin_device);
+
+	if (settings.contains("window_size")) {
+		size_t window_size = settings.value("window_size").toULongLong();
+		window_size_spin_box_->setValue((int)window_size);
+		histogram_.set_window_size(window_size);
+	}
+
+	auto signal = SettingsManager::restore_signal(
+		session_, settings, origin_device);
+	if (signal)
+		set_signal(dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal));
+}
+
+void HistogramView::on_sample_appended()
+{
+	if (!signal_)
+		return;
+
+	const size_t sample_count = signal_->sample_count();
+	if (sample_count < next_signal_pos_) {
+		// The signal has been cleared.
+		histogram_.clear();
+		next_signal_pos_ = 0;
+		histogram_changed_ = true;
+	}
+	if (next_signal_pos_ >= sample_count)
+		return;
+
+	// Use the resolution of the signal for the initial bin width, so the
+	// quantization steps are visible.
+	if (histogram_.value_count() == 0)
+		histogram_.set_resolution(std::pow(10., -signal_->decimal_places()));
+
+	// Only the new samples are added to the bins.
+	for (; next_signal_pos_ < sample_count; ++next_signal_pos_)
+		histogram_.add_value(signal_->get_sample(next_signal_pos_, false).second);
+	histogram_changed_ = true;
+}
+
+void HistogramView::on_update()
+{
+	if (!histogram_changed_)
+		return;
+	histogram_changed_ = false;
+
+	QVector<QwtIntervalSample> samples;
+	if (histogram_.value_count() > 0) {
+		samples.reserve((int)histogram_.bin_count());
+		for (size_t i = 0; i < histogram_.bin_count(); ++i) {
+			samples.append(QwtIntervalSample(
+				(double)histogram_.bin_value(i),
+				histogram_.bin_lower_bound(i),
+				histogram_.bin_lower_bound(i + 1)));
+		}
+	}
+	plot_histogram_->setSamples(samples);
+	plot_->replot();
+}
+
+void HistogramView::on_action_reset_triggered()
+{
+	reset_histogram();
+}
+
+void HistogramView::on_window_size_changed()
+{
+	size_t window_size = (size_t)window_size_spin_box_->value();
+	if (window_size == histogram_.window_size())
+		return;
+
+	histogram_.set_window_size(window_size);
+	reset_histogram();
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,106 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_HISTOGRAMVIEW_HPP
+#define UI_VIEWS_HISTOGRAMVIEW_HPP
+
+#include <memory>
+
+#include <QAction>
+#include <QSettings>
+#include <QSpinBox>
+#include <QTimer>
+#include <QToolBar>
+#include <QUuid>
+#include <qwt_plot.h>
+#include <qwt_plot_histogram.h>
+
+#include "src/data/histogram.hpp"
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+}
+namespace devices {
+class BaseDevice;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * Shows the distribution of the values of a signal. The histogram is updated
+ * incrementally with the new samples of the signal.
+ */
+class HistogramView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	explicit HistogramView(Session& session, QUuid uuid = QUuid(),
+		QWidget* parent = nullptr);
+
+	QString title() const override;
+	void set_signal(shared_ptr<sv::data::AnalogTimeSignal> signal);
+
+	void save_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) const override;
+	void restore_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
+
+private:
+	shared_ptr<sv::data::AnalogTimeSignal> signal_;
+	size_t next_signal_pos_;
+	sv::data::Histogram histogram_;
+	bool histogram_changed_;
+
+	QTimer *timer_;
+	QAction *const action_reset_;
+	QSpinBox *window_size_spin_box_;
+	QToolBar *toolbar_;
+	QwtPlot *plot_;
+	QwtPlotHistogram *plot_histogram_;
+
+	static const size_t bin_count_ = 100;
+
+	void setup_ui();
+	void setup_toolbar();
+	void connect_signal();
+	void disconnect_signal();
+	void reset_histogram();
+
+private Q_SLOTS:
+	void on_sample_appended();
+	void on_update();
+	void on_action_reset_triggered();
+	void on_window_size_changed();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_HISTOGRAMVIEW_HPP
@@ -22,7 +22,6 @@
 #include <string>
 
 #include <QApplication>
-#include <QDateTime>
 #include <QDebug>
 #include <QSettings>
 #include <QTimer>
@@ -37,6 +36,7 @@
 #include "src/data/analogbasesignal.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/powerstatistics.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/ui/views/baseview.hpp"
 #include "src/ui/views/viewhelper.hpp"
@@ -55,16 +55,6 @@ PowerPanelView::PowerPanelView(Session &session, QUuid uuid, QWidget *parent) :
 	BaseView(session, uuid, parent),
 	voltage_signal_(nullptr),
 	current_signal_(nullptr),
-	voltage_min_(std::numeric_limits<double>::max()),
-	voltage_max_(std::numeric_limits<double>::lowest()),
-	current_min_(std::numeric_limits<double>::max()),
-	current_max_(std::numeric_limits<double>::lowest()),
-	resistance_min_(std::numeric_limits<double>::max()),
-	resistance_max_(std::numeric_limits<double>::lowest()),
-	power_min_(std::numeric_limits<double>::max()),
-	power_max_(std::numeric_limits<double>::lowest()),
-	actual_amp_hours_(0),
-	actual_watt_hours_(0),
 	action_reset_displays_(new QAction(this))
 {
 	id_ = "powerpanel:" + util::format_uuid(uuid_);
@@ -104,6 +94,7 @@ void PowerPanelView::set_signals(
 	stop_timer();
 	voltage_signal_ = voltage_signal;
 	current_signal_ = current_signal;
+	power_statistics_.set_signals(voltage_signal_, current_signal_);
 	init_timer();
 	init_displays();
 	connect_signals();
@@ -388,19 +379,9 @@ void PowerPanelView::reset_displays()
 
 void PowerPanelView::init_timer()
 {
-	start_time_ = QDateTime::currentMSecsSinceEpoch();
-	last_time_ = start_time_;
-
-	voltage_min_ = std::numeric_limits<double>::max();
-	voltage_max_ = std::numeric_limits<double>::lowest();
-	current_min_ = std::numeric_limits<double>::max();
-	current_max_ = std::numeric_limits<double>::lowest();
-	resistance_min_ = std::numeric_limits<double>::max();
-	resistance_max_ = std::numeric_limits<double>::lowest();
-	power_min_ = std::numeric_limits<double>::max();
-	power_max_ = std::numeric_limits<double>::lowest();
-	actual_amp_hours_ = 0;
-	actual_watt_hours_ = 0;
+	// Only the samples from now on are used for the min/max values and the
+	// integrals.
+	power_statistics_.reset();
 
 	connect(timer_, &QTimer::timeout, this, &PowerPanelView::on_update);
 	timer_->start(250);
@@ -419,66 +400,29 @@ void PowerPanelView::stop_timer()
 
 void PowerPanelView::on_update()
 {
-	if (!voltage_signal_ || voltage_signal_->sample_count() == 0 ||
-			!current_signal_ || current_signal_->sample_count() == 0)
+	// The new samples are processed here, but the accuracy doesn't depend on
+	// the update interval, because all samples and their timestamps are used.
+	if (!power_statistics_.update())
 		return;
 
-	qint64 now = QDateTime::currentMSecsSinceEpoch();
-	double elapsed_time = (double)(now - last_time_) / (double)3600000; // / 1h
-	last_time_ = now;
+	voltage_display_->set_value(power_statistics_.voltage());
+	voltage_min_display_->set_value(power_statistics_.voltage_min());
+	voltage_max_display_->set_value(power_statistics_.voltage_max());
 
-	double voltage = 0.;
-	if (voltage_signal_) {
-		voltage = voltage_signal_->last_value();
-		if (voltage_min_ > voltage)
-			voltage_min_ = voltage;
-		if (voltage_max_ < voltage)
-			voltage_max_ = voltage;
-	}
-
-	double current = 0.;
-	if (current_signal_) {
-		current = current_signal_->last_value();
-		if (current_min_ > current)
-			current_min_ = current;
-		if (current_max_ < current)
-			current_max_ = current;
-	}
-
-	double resistance = current == 0. ?
-		std::numeric_limits<double>::max() : voltage / current;
-	if (resistance_min_ > resistance)
-		resistance_min_ = resistance;
-	if (resistance_max_ < resistance)
-		resistance_max_ = resistance;
-
-	double power = voltage * current;
-	if (power_min_ > power)
-		power_min_ = power;
-	if (power_max_ < power)
-		power_max_ = power;
-
-	actual_amp_hours_ = actual_amp_hours_ + (current * elapsed_time);
-	actual_watt_hours_ = actual_watt_hours_ + (power * elapsed_time);
-
-	voltage_display_->set_value(voltage);
-	voltage_min_display_->set_value(voltage_min_);
-	voltage_max_display_->set_value(voltage_max_);
-
-	current_display_->set_value(current);
-	current_min_display_->set_value(current_min_);
-	current_max_display_->set_value(current_max_);
+	current_display_->set_value(power_statistics_.current());
+	current_min_display_->set_value(power_statistics_.current_min());
+	current_max_display_->set_value(power_statistics_.current_max());
 
-	resistance_display_->set_value(resistance);
-	resistance_min_display_->set_value(resistance_min_);
-	resistance_max_display_->set_value(resistance_max_);
+	resistance_display_->set_value(power_statistics_.resistance());
+	resistance_min_display_->set_value(power_statistics_.resistance_min());
+	resistance_max_display_->set_value(power_statistics_.resistance_max());
 
-	power_display_->set_value(power);
-	power_min_display_->set_value(power_min_);
-	power_max_display_->set_value(power_max_);
+	power_display_->set_value(power_statistics_.power());
+	power_min_display_->set_value(power_statistics_.power_min());
+	power_max_display_->set_value(power_statistics_.power_max());
 
-	amp_hour_display_->set_value(actual_amp_hours_);
-	watt_hour_display_->set_value(actual_watt_hours_);
+	amp_hour_display_->set_value(power_statistics_.amp_hours());
+	watt_hour_display_->set_value(power_statistics_.watt_hours());
 }
 
 void PowerPanelView::on_action_reset_displays_triggered()
@@ -28,6 +28,7 @@
 #include <QToolBar>
 #include <QUuid>
 
+#include "src/data/powerstatistics.hpp"
 #include "src/ui/views/baseview.hpp"
 
 using std::shared_ptr;
@@ -74,20 +75,8 @@ private:
 	shared_ptr<sv::data::AnalogTimeSignal> current_signal_;
 
 	QTimer *timer_;
-	qint64 start_time_;
-	qint64 last_time_;
-
-	// Min/max/actual values are stored here, so they can be reseted
-	double voltage_min_;
-	double voltage_max_;
-	double current_min_;
-	double current_max_;
-	double resistance_min_;
-	double resistance_max_;
-	double power_min_;
-	double power_max_;
-	double actual_amp_hours_;
-	double actual_watt_hours_;
+	/** All samples of both signals are accumulated here. */
+	sv::data::PowerStatistics power_statistics_;
 
 	QAction *const action_reset_displays_;
 	QToolBar *toolbar_;
@@ -43,24 +43,29 @@
 #include <QTableWidget>
 #include <QTableWidgetItem>
 #include <QTextStream>
-#include <QTimer>
 #include <QToolBar>
 #include <QUuid>
 #include <QVariant>
 #include <QVBoxLayout>
 
 #include "sequenceoutputview.hpp"
+#include "src/sequencer.hpp"
 #include "src/session.hpp"
 #include "src/settingsmanager.hpp"
 #include "src/util.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/waveform.hpp"
 #include "src/data/properties/doubleproperty.hpp"
 #include "src/devices/basedevice.hpp"
+#include "src/devices/configurable.hpp"
 #include "src/ui/datatypes/doublespinbox.hpp"
 #include "src/ui/dialogs/generatewaveformdialog.hpp"
 #include "src/ui/views/baseview.hpp"
 #include "src/ui/views/viewhelper.hpp"
 
 using std::dynamic_pointer_cast;
+using std::make_shared;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -134,19 +139,19 @@ SequenceOutputView::SequenceOutputView(Session &session, QUuid uuid,
 	action_delete_all_(new QAction(this)),
 	action_load_from_file_(new QAction(this)),
 	action_generate_waveform_(new QAction(this)),
-	sequence_pos_(0)
+	sequencer_(nullptr),
+	waveform_(nullptr)
 {
 	id_ = "sequenceoutput:" + util::format_uuid(uuid_);
 
 	setup_ui();
 	setup_toolbar();
-
-	timer_ = new QTimer(this);
 }
 
 SequenceOutputView::~SequenceOutputView()
 {
-	stop_timer();
+	if (sequencer_)
+		sequencer_->stop();
 }
 
 QString SequenceOutputView::title() const
@@ -162,9 +167,14 @@ void SequenceOutputView::set_property(
 {
 	assert(property);
 
-	stop_timer();
+	stop_sequencer();
 
 	property_ = property;
+	sequencer_ = make_shared<Sequencer>(property_);
+	connect(sequencer_.get(), &Sequencer::step_applied,
+		this, &SequenceOutputView::on_step_applied);
+	connect(sequencer_.get(), &Sequencer::finished,
+		this, &SequenceOutputView::on_sequencer_finished);
 	sequence_table_->setItemDelegateForColumn(0,
 		new DoubleSpinBoxDelegate(property_->min(), property_->max(),
 			property_->step(), property_->decimal_places()));
@@ -195,6 +205,10 @@ void SequenceOutputView::setup_ui()
 	repeat_layout->addStretch(1);
 	layout->addItem(repeat_layout);
 
+	record_box_ = new QCheckBox(tr("Record applied values"));
+	record_box_->setChecked(true);
+	layout->addWidget(record_box_);
+
 	sequence_table_ = new QTableWidget();
 	sequence_table_->setColumnCount(2);
 	QTableWidgetItem *value_header_item = new QTableWidgetItem(tr("Value"));
@@ -214,6 +228,12 @@ void SequenceOutputView::setup_ui()
 	//sequence_table_->setRowCount(1);
 	layout->addWidget(sequence_table_);
 
+	waveform_label_ = new QLabel();
+	waveform_label_->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+	waveform_label_->setWordWrap(true);
+	waveform_label_->hide();
+	layout->addWidget(waveform_label_, 1);
+
 	this->central_widget_->setLayout(layout);
 }
 
@@ -287,6 +307,28 @@ void SequenceOutputView::save_settings(QSettings &settings,
 	settings.setValue("repeat_infinite",
 		QVariant(repeat_infinite_box_->checkState()));
 	settings.setValue("repeat_count", QVariant(repeat_count_box_->value()));
+	settings.setValue("record", QVariant(record_box_->isChecked()));
+
+	// Save waveform
+	if (waveform_) {
+		QVariantList point_times;
+		for (const auto &t : waveform_->point_times())
+			point_times.append(t);
+		QVariantList point_values;
+		for (const auto &v : waveform_->point_values())
+			point_values.append(v);
+
+		settings.beginGroup("waveform");
+		settings.setValue("type", QVariant((int)waveform_->type()));
+		settings.setValue("amplitude", QVariant(waveform_->amplitude()));
+		settings.setValue("offset", QVariant(waveform_->offset()));
+		settings.setValue("periode", QVariant(waveform_->periode()));
+		settings.setValue("phase", QVariant(waveform_->phase()));
+		settings.setValue("interval", QVariant(waveform_->interval()));
+		settings.setValue("point_times", point_times);
+		settings.setValue("point_values", point_values);
+		settings.endGroup();
+	}
 
 	// Save sequence
 	int row_count = sequence_table_->rowCount();
@@ -321,6 +363,8 @@ void SequenceOutputView::restore_settings(QSettings &settings,
 			settings.value("repeat_infinite").value<Qt::CheckState>());
 	if (settings.contains("repeat_count"))
 		repeat_count_box_->setValue(settings.value("repeat_count").toInt());
+	if (settings.contains("record"))
+		record_box_->setChecked(settings.value("record").toBool());
 
 	// Restore sequence
 	int row_count = settings.value("sequence_row_count").toInt();
@@ -339,24 +383,62 @@ void SequenceOutputView::restore_settings(QSettings &settings,
 		sequence_table_->setItem(pos, 1, delay_item);
 		settings.endGroup();
 	}
+
+	// Restore waveform
+	if (settings.childGroups().contains("waveform")) {
+		settings.beginGroup("waveform");
+		vector<double> point_times;
+		for (const auto &t : settings.value("point_times").toList())
+			point_times.push_back(t.toDouble());
+		vector<double> point_values;
+		for (const auto &v : settings.value("point_values").toList())
+			point_values.push_back(v.toDouble());
+
+		auto waveform = make_shared<data::Waveform>();
+		waveform->set_type(
+			(data::WaveformType)settings.value("type").toInt());
+		waveform->set_amplitude(settings.value("amplitude").toDouble());
+		waveform->set_offset(settings.value("offset").toDouble());
+		waveform->set_periode(settings.value("periode").toDouble());
+		waveform->set_phase(settings.value("phase").toDouble());
+		waveform->set_interval(settings.value("interval").toDouble());
+		waveform->set_points(point_times, point_values);
+		settings.endGroup();
+		set_waveform(waveform);
+	}
 }
 
-void SequenceOutputView::start_timer()
+void SequenceOutputView::start_sequencer()
 {
-	if (timer_->isActive()) {
-		timer_->stop();
-		disconnect(timer_, &QTimer::timeout,
-			this, &SequenceOutputView::on_timer_update);
+	if (!sequencer_) {
+		stop_sequencer();
+		return;
 	}
 
-	sequence_pos_ = 0;
-	sequence_reperat_count_ = 0;
-	if (sequence_table_->rowCount() == 0)
-		return;
+	// The sequencer gets a copy of the table, so editing the table doesn't
+	// interfere with a running sequence.
+	vector<double> values;
+	vector<double> delays;
+	for (int pos=0; pos<sequence_table_->rowCount(); ++pos) {
+		QTableWidgetItem *value_item = sequence_table_->item(pos, 0);
+		QTableWidgetItem *delay_item = sequence_table_->item(pos, 1);
+		values.push_back(value_item ? value_item->data(0).toDouble() : .0);
+		delays.push_back(delay_item ? delay_item->data(0).toDouble() : .0);
+	}
 
-	connect(timer_, &QTimer::timeout,
-		this, &SequenceOutputView::on_timer_update);
-	timer_->start();
+	sequencer_->stop();
+	if (waveform_)
+		sequencer_->set_waveform(waveform_);
+	else
+		sequencer_->set_sequence(values, delays);
+	sequencer_->set_repeat_count(repeat_infinite_box_->isChecked() ?
+		0 : repeat_count_box_->value());
+	sequencer_->set_record_channel(
+		record_box_->isChecked() ? get_record_channel() : nullptr);
+	if (!sequencer_->start()) {
+		stop_sequencer();
+		return;
+	}
 
 	action_run_->setText(tr("Stop"));
 	action_run_->setIcon(
@@ -365,7 +447,7 @@ void SequenceOutputView::start_timer()
 	action_run_->setChecked(true);
 }
 
-void SequenceOutputView::stop_timer()
+void SequenceOutputView::stop_sequencer()
 {
 	action_run_->setText(tr("Run"));
 	action_run_->setIcon(
@@ -373,14 +455,42 @@ void SequenceOutputView::stop_timer()
 		QIcon(":/icons/media-playback-start.png")));
 	action_run_->setChecked(false);
 
-	if (!timer_->isActive())
-		return;
+	if (sequencer_)
+		sequencer_->stop();
+}
+
+shared_ptr<sv::channels::UserChannel>
+	SequenceOutputView::get_record_channel() const
+{
+	// The applied values are recorded into a user channel of the device the
+	// property belongs to.
+	auto configurable = property_->configurable();
+	string channel_name = "Sequence ";
+	if (!configurable->name().empty())
+		channel_name += configurable->name() + " ";
+	channel_name += property_->name();
+
+	for (const auto &device_pair : session_.device_map()) {
+		auto device = device_pair.second;
+		bool has_configurable = false;
+		for (const auto &conf_pair : device->configurable_map()) {
+			if (conf_pair.second == configurable) {
+				has_configurable = true;
+				break;
+			}
+		}
+		if (!has_configurable)
+			continue;
 
-	timer_->stop();
-	disconnect(timer_, &QTimer::timeout,
-		this, &SequenceOutputView::on_timer_update);
-	sequence_pos_ = 0;
-	sequence_reperat_count_ = 0;
+		const auto channel_map = device->channel_map();
+		const auto channel_it = channel_map.find(channel_name);
+		if (channel_it != channel_map.end()) {
+			return dynamic_pointer_cast<sv::channels::UserChannel>(
+				channel_it->second);
+		}
+		return device->add_user_channel(channel_name, "Sequence");
+	}
+	return nullptr;
 }
 
 void SequenceOutputView::insert_row(int row, double value, double delay)
@@ -402,52 +512,67 @@ void SequenceOutputView::insert_row(int row, double value, double delay)
 	sequence_table_->setItem(row, 1, delay_item);
 }
 
-void SequenceOutputView::on_timer_update()
+void SequenceOutputView::set_waveform(shared_ptr<data::Waveform> waveform)
 {
-	if (!property_) {
-		stop_timer();
+	waveform_ = waveform;
+
+	sequence_table_->setVisible(!waveform_);
+	waveform_label_->setVisible((bool)waveform_);
+	action_delete_row_->setDisabled((bool)waveform_);
+	if (!waveform_)
 		return;
+
+	QString type;
+	switch (waveform_->type()) {
+	case data::WaveformType::Sine:
+		type = tr("Sine");
+		break;
+	case data::WaveformType::Square:
+		type = tr("Square");
+		break;
+	case data::WaveformType::Triangle:
+		type = tr("Triangle");
+		break;
+	case data::WaveformType::Sawtooth:
+		type = tr("Sawtooth");
+		break;
+	case data::WaveformType::SawtoothInv:
+		type = tr("Sawtooth inverted");
+		break;
+	case data::WaveformType::Arbitrary:
+		type = tr("Interpolated table values");
+		break;
 	}
 
-	bool found_value = sequence_pos_ > 0;
-	double value = .0;
-	int delay_ms = 0;
-	// Cycle through the row until a duration is found.
-	do {
-		if (sequence_table_->rowCount() == 0) {
-			stop_timer();
-			return;
-		}
-		if (sequence_pos_ >= sequence_table_->rowCount()) {
-			// Jump up to the first row
-			sequence_pos_ = 0;
-			if (!found_value) {
-				stop_timer();
-				return;
-			}
-			if (!repeat_infinite_box_->isChecked()) {
-				sequence_reperat_count_++;
-				if (sequence_reperat_count_ >= repeat_count_box_->value()) {
-					stop_timer();
-					return;
-				}
-			}
-		}
+	QString text = tr("Waveform: %1").arg(type);
+	if (waveform_->type() != data::WaveformType::Arbitrary) {
+		QString unit;
+		if (property_ && property_->unit() != data::Unit::Unitless &&
+				property_->unit() != data::Unit::Unknown)
+			unit = " " + data::datautil::format_unit(property_->unit());
+		text.append("\n").append(tr("Amplitude: %L1%2, Offset: %L3%2").
+			arg(waveform_->amplitude()).arg(unit).arg(waveform_->offset()));
+	}
+	text.append("\n").append(tr("Periode: %L1 s, %L2 samples every %L3 s").
+		arg(waveform_->periode()).arg(waveform_->sample_count()).
+		arg(waveform_->interval()));
+	waveform_label_->setText(text);
+}
 
-		QTableWidgetItem *value_item = sequence_table_->item(sequence_pos_, 0);
-		if (value_item)
-			value = value_item->data(0).toDouble();
-		QTableWidgetItem *delay_item = sequence_table_->item(sequence_pos_, 1);
-		if (delay_item)
-			delay_ms = (int)std::round(delay_item->data(0).toDouble() * 1000);
+void SequenceOutputView::on_step_applied(int pos)
+{
+	if (pos >= 0 && pos < sequence_table_->rowCount())
+		sequence_table_->selectRow(pos);
+}
 
-		sequence_table_->selectRow(sequence_pos_);
-		sequence_pos_++;
-	}
-	while (delay_ms <= 0);
+void SequenceOutputView::on_sequencer_finished()
+{
+	// The signal is queued, so it could be from a previous run, when the
+	// sequencer has been restarted in the meantime.
+	if (sequencer_ && sequencer_->is_running())
+		return;
 
-	property_->change_value(value);
-	timer_->setInterval(delay_ms);
+	stop_sequencer();
 }
 
 void SequenceOutputView::on_repeat_infinite_changed()
@@ -461,13 +586,14 @@ void SequenceOutputView::on_repeat_infinite_changed()
 void SequenceOutputView::on_action_run_triggered()
 {
 	if (action_run_->isChecked())
-		start_timer();
+		start_sequencer();
 	else
-		stop_timer();
+		stop_sequencer();
 }
 
 void SequenceOutputView::on_action_add_row()
 {
+	set_waveform(nullptr);
 	int row = sequence_table_->currentRow() + 1;
 	insert_row(row, .0, .0);
 }
@@ -484,6 +610,7 @@ void SequenceOutputView::on_action_delete_row()
 
 void SequenceOutputView::on_action_delete_all()
 {
+	set_waveform(nullptr);
 	sequence_table_->setRowCount(0);
 }
 
@@ -494,6 +621,8 @@ void SequenceOutputView::on_action_load_from_file_triggered()
 	if (file_name.length() <= 0)
 		return;
 
+	set_waveform(nullptr);
+
 	std::ifstream file(file_name.toStdString());
 	if (file.is_open()) {
 		string line;
@@ -528,17 +657,34 @@ void SequenceOutputView::on_action_generate_waveform_triggered()
 		QMessageBox::warning(this, tr("No property assigned."),
 			tr("Please assign a property to this sequence output view first."),
 			QMessageBox::Ok);
+		return;
 	}
 
 	ui::dialogs::GenerateWaveformDialog dlg(property_);
+
+	// The actual sequence table can be used as points for an interpolated
+	// waveform.
+	vector<double> point_times;
+	vector<double> point_values;
+	double t = 0;
+	for (int pos=0; pos<sequence_table_->rowCount(); ++pos) {
+		QTableWidgetItem *value_item = sequence_table_->item(pos, 0);
+		QTableWidgetItem *delay_item = sequence_table_->item(pos, 1);
+		if (!value_item || !delay_item)
+			continue;
+		point_times.push_back(t);
+		point_values.push_back(value_item->data(0).toDouble());
+		t += delay_item->data(0).toDouble();
+	}
+	if (!waveform_ && t > 0)
+		dlg.set_points(point_times, point_values, t);
+
 	if (!dlg.exec())
 		return;
 
-	vector<double> sequence_values = dlg.sequence_values();
-	vector<double> sequence_delays = dlg.sequence_delays();
-	for (size_t i=0; i<sequence_values.size(); ++i) {
-		insert_row(i, sequence_values[i], sequence_delays[i]);
-	}
+	// The waveform is calculated for every step when the sequence is running,
+	// so even long waveforms with a high resolution don't fill the table.
+	set_waveform(dlg.waveform());
 }
 
 } // namespace views
@@ -24,6 +24,7 @@
 
 #include <QAction>
 #include <QCheckBox>
+#include <QLabel>
 #include <QLocale>
 #include <QSettings>
 #include <QSpinBox>
@@ -31,7 +32,6 @@
 #include <QStringList>
 #include <QStyledItemDelegate>
 #include <QTableWidget>
-#include <QTimer>
 #include <QToolBar>
 #include <QUuid>
 #include <QVariant>
@@ -42,9 +42,14 @@ using std::shared_ptr;
 
 namespace sv {
 
+class Sequencer;
 class Session;
 
+namespace channels {
+class UserChannel;
+}
 namespace data {
+class Waveform;
 namespace properties {
 class DoubleProperty;
 }
@@ -109,22 +114,28 @@ private:
 	QAction *const action_load_from_file_;
 	QAction *const action_generate_waveform_;
 	QToolBar *toolbar_;
-	QTimer *timer_;
+	shared_ptr<Sequencer> sequencer_;
 	QCheckBox *repeat_infinite_box_;
 	QSpinBox *repeat_count_box_;
+	/** Record the applied values into a user channel of the device. */
+	QCheckBox *record_box_;
 	QTableWidget *sequence_table_;
-	int sequence_pos_;
-	int sequence_reperat_count_;
+	/** The waveform that replaces the sequence table, when set. */
+	shared_ptr<sv::data::Waveform> waveform_;
+	QLabel *waveform_label_;
 
 	void setup_ui();
 	void setup_toolbar();
-	void start_timer();
-	void stop_timer();
+	void start_sequencer();
+	void stop_sequencer();
+	shared_ptr<sv::channels::UserChannel> get_record_channel() const;
 	void insert_row(int row, double value, double delay);
+	void set_waveform(shared_ptr<sv::data::Waveform> waveform);
 	QStringList parse_csv_line(QString line);
 
 private Q_SLOTS:
-	void on_timer_update();
+	void on_step_applied(int pos);
+	void on_sequencer_finished();
 	void on_repeat_infinite_changed();
 	void on_action_run_triggered();
 	void on_action_add_row();
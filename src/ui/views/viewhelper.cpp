@@ -43,6 +43,7 @@
 #include "src/ui/views/baseview.hpp"
 #include "src/ui/views/democontrolview.hpp"
 #include "src/ui/views/genericcontrolview.hpp"
+#include "src/ui/views/histogramview.hpp"
 #include "src/ui/views/measurementcontrolview.hpp"
 #include "src/ui/views/powerpanelview.hpp"
 #include "src/ui/views/sequenceoutputview.hpp"
@@ -51,6 +52,7 @@
 #include "src/ui/views/sourcesinkcontrolview.hpp"
 #include "src/ui/views/timeplotview.hpp"
 #include "src/ui/views/valuepanelview.hpp"
+#include "src/ui/views/waterfallview.hpp"
 #include "src/ui/views/xyplotview.hpp"
 
 using std::shared_ptr;
@@ -157,6 +159,12 @@ BaseView *get_view_from_settings(Session &session, QSettings &settings,
 	else if (type == "xyplot") {
 		view = new XYPlotView(session, uuid);
 	}
+	else if (type == "histogram") {
+		view = new HistogramView(session, uuid);
+	}
+	else if (type == "waterfall") {
+		view = new WaterfallView(session, uuid);
+	}
 	else if (type == "powerpanel") {
 		view = new PowerPanelView(session, uuid);
 	}
@@ -0,0 +1,265 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <memory>
+
+#include <QComboBox>
+#include <QDebug>
+#include <QLabel>
+#include <QSettings>
+#include <QSpinBox>
+#include <QUuid>
+#include <QVariant>
+#include <QVBoxLayout>
+
+#include "waterfallview.hpp"
+#include "src/session.hpp"
+#include "src/settingsmanager.hpp"
+#include "src/util.hpp"
+#include "src/data/analogbasesignal.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/spectrum.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/ui/views/baseview.hpp"
+#include "src/ui/widgets/waterfallwidget.hpp"
+
+using std::dynamic_pointer_cast;
+using std::shared_ptr;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+WaterfallView::WaterfallView(Session &session, QUuid uuid, QWidget *parent) :
+	BaseView(session, uuid, parent),
+	signal_(nullptr),
+	next_signal_pos_(0),
+	spectrum_(8192),
+	action_reset_(new QAction(this))
+{
+	id_ = "waterfall:" + util::format_uuid(uuid_);
+
+	setup_ui();
+	setup_toolbar();
+	update_info_label();
+}
+
+QString WaterfallView::title() const
+{
+	QString title = tr("Waterfall");
+	if (signal_)
+		title = title.append(" ").append(signal_->display_name());
+	return title;
+}
+
+void WaterfallView::set_signal(shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	assert(signal);
+
+	disconnect_signal();
+	signal_ = signal;
+	reset_waterfall();
+	connect_signal();
+
+	Q_EMIT title_changed();
+}
+
+void WaterfallView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	waterfall_widget_ = new widgets::WaterfallWidget();
+	layout->addWidget(waterfall_widget_, 1);
+
+	info_label_ = new QLabel();
+	layout->addWidget(info_label_);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void WaterfallView::setup_toolbar()
+{
+	action_reset_->setText(tr("Reset waterfall"));
+	action_reset_->setIcon(
+		QIcon::fromTheme("view-refresh",
+		QIcon(":/icons/view-refresh.png")));
+	connect(action_reset_, &QAction::triggered,
+		this, &WaterfallView::on_action_reset_triggered);
+
+	fft_size_box_ = new QComboBox();
+	for (int size = 256; size <= 65536; size *= 2)
+		fft_size_box_->addItem(QString::number(size), size);
+	fft_size_box_->setCurrentIndex(
+		fft_size_box_->findData((int)spectrum_.fft_size()));
+	fft_size_box_->setToolTip(tr("Number of samples per spectrum"));
+	connect(fft_size_box_,
+		QOverload<int>::of(&QComboBox::currentIndexChanged),
+		this, &WaterfallView::on_fft_size_changed);
+
+	dynamic_range_spin_box_ = new QSpinBox();
+	dynamic_range_spin_box_->setRange(10, 300);
+	dynamic_range_spin_box_->setSingleStep(10);
+	dynamic_range_spin_box_->setSuffix(" dB");
+	dynamic_range_spin_box_->setToolTip(
+		tr("Displayed range below the peak magnitude"));
+	dynamic_range_spin_box_->setValue(
+		(int)waterfall_widget_->dynamic_range());
+	connect(dynamic_range_spin_box_, &QSpinBox::editingFinished,
+		this, &WaterfallView::on_dynamic_range_changed);
+
+	toolbar_ = new QToolBar("Waterfall View Toolbar");
+	toolbar_->addAction(action_reset_);
+	toolbar_->addSeparator();
+	toolbar_->addWidget(new QLabel(tr("FFT size:")));
+	toolbar_->addWidget(fft_size_box_);
+	toolbar_->addWidget(new QLabel(tr("Range:")));
+	toolbar_->addWidget(dynamic_range_spin_box_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void WaterfallView::connect_signal()
+{
+	if (!signal_)
+		return;
+
+	connect(signal_.get(), &data::AnalogBaseSignal::sample_appended,
+		this, &WaterfallView::on_sample_appended);
+	connect(signal_.get(), &data::AnalogBaseSignal::samples_cleared,
+		this, &WaterfallView::on_sample_appended);
+}
+
+void WaterfallView::disconnect_signal()
+{
+	if (!signal_)
+		return;
+
+	disconnect(signal_.get(), &data::AnalogBaseSignal::sample_appended,
+		this, &WaterfallView::on_sample_appended);
+	disconnect(signal_.get(), &data::AnalogBaseSignal::samples_cleared,
+		this, &WaterfallView::on_sample_appended);
+}
+
+void WaterfallView::reset_waterfall()
+{
+	spectrum_.clear();
+	waterfall_widget_->clear();
+
+	// Start with the new samples, the old samples would only add rows that
+	// are scrolled out immediately.
+	next_signal_pos_ = signal_ ? signal_->sample_count() : 0;
+	update_info_label();
+}
+
+void WaterfallView::update_info_label()
+{
+	QString text = tr("FFT size: %1 samples").arg(spectrum_.fft_size());
+	if (spectrum_.max_frequency() > 0.) {
+		text.append(", ").append(tr("Frequency: 0 Hz - %1 Hz").arg(
+			spectrum_.max_frequency(), 0, 'g', 4));
+	}
+	info_label_->setText(text);
+}
+
+void WaterfallView::save_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device) const
+{
+	BaseView::save_settings(settings, origin_device);
+
+	if (signal_)
+		SettingsManager::save_signal(signal_, settings, origin_device);
+	settings.setValue("fft_size",
+		QVariant::fromValue<qulonglong>(spectrum_.fft_size()));
+	settings.setValue("dynamic_range", waterfall_widget_->dynamic_range());
+}
+
+void WaterfallView::restore_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device)
+{
+	BaseView::restore_settings(settings, origin_device);
+
+	if (settings.contains("fft_size")) {
+		int index = fft_size_box_->findData(
+			(int)settings.value("fft_size").toULongLong());
+		if (index >= 0)
+			fft_size_box_->setCurrentIndex(index);
+	}
+	if (settings.contains("dynamic_range")) {
+		double dynamic_range = settings.value("dynamic_range").toDouble();
+		waterfall_widget_->set_dynamic_range(dynamic_range);
+		dynamic_range_spin_box_->setValue((int)dynamic_range);
+	}
+
+	auto signal = SettingsManager::restore_signal(
+		session_, settings, origin_device);
+	if (signal)
+		set_signal(dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal));
+}
+
+void WaterfallView::on_sample_appended()
+{
+	if (!signal_)
+		return;
+
+	const size_t sample_count = signal_->sample_count();
+	if (sample_count < next_signal_pos_) {
+		// The signal has been cleared.
+		spectrum_.clear();
+		waterfall_widget_->clear();
+		next_signal_pos_ = 0;
+	}
+
+	// Every sample is only processed once, a row is added when a spectrum
+	// is complete.
+	bool new_row = false;
+	for (; next_signal_pos_ < sample_count; ++next_signal_pos_) {
+		auto sample = signal_->get_sample(next_signal_pos_, false);
+		if (spectrum_.add_sample(sample.first, sample.second)) {
+			waterfall_widget_->add_row(spectrum_.magnitudes_db());
+			new_row = true;
+		}
+	}
+	if (new_row)
+		update_info_label();
+}
+
+void WaterfallView::on_action_reset_triggered()
+{
+	reset_waterfall();
+}
+
+void WaterfallView::on_fft_size_changed()
+{
+	size_t fft_size = fft_size_box_->currentData().toULongLong();
+	if (fft_size == spectrum_.fft_size())
+		return;
+
+	spectrum_.set_fft_size(fft_size);
+	reset_waterfall();
+}
+
+void WaterfallView::on_dynamic_range_changed()
+{
+	// Only the new rows use the new range.
+	waterfall_widget_->set_dynamic_range(dynamic_range_spin_box_->value());
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
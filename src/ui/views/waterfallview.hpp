@@ -0,0 +1,109 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_WATERFALLVIEW_HPP
+#define UI_VIEWS_WATERFALLVIEW_HPP
+
+#include <memory>
+
+#include <QAction>
+#include <QComboBox>
+#include <QLabel>
+#include <QSettings>
+#include <QSpinBox>
+#include <QToolBar>
+#include <QUuid>
+
+#include "src/data/spectrum.hpp"
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+}
+namespace devices {
+class BaseDevice;
+}
+
+namespace ui {
+
+namespace widgets {
+class WaterfallWidget;
+}
+
+namespace views {
+
+/**
+ * Shows successive spectra of a signal as a waterfall (spectrogram). A new
+ * row is calculated every time enough new samples for a spectrum are
+ * available.
+ */
+class WaterfallView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	explicit WaterfallView(Session& session, QUuid uuid = QUuid(),
+		QWidget* parent = nullptr);
+
+	QString title() const override;
+	void set_signal(shared_ptr<sv::data::AnalogTimeSignal> signal);
+
+	void save_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) const override;
+	void restore_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
+
+private:
+	shared_ptr<sv::data::AnalogTimeSignal> signal_;
+	size_t next_signal_pos_;
+	sv::data::Spectrum spectrum_;
+
+	QAction *const action_reset_;
+	QComboBox *fft_size_box_;
+	QSpinBox *dynamic_range_spin_box_;
+	QToolBar *toolbar_;
+	widgets::WaterfallWidget *waterfall_widget_;
+	QLabel *info_label_;
+
+	void setup_ui();
+	void setup_toolbar();
+	void connect_signal();
+	void disconnect_signal();
+	void reset_waterfall();
+	void update_info_label();
+
+private Q_SLOTS:
+	void on_sample_appended();
+	void on_action_reset_triggered();
+	void on_fft_size_changed();
+	void on_dynamic_range_changed();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_WATERFALLVIEW_HPP
@@ -37,7 +37,9 @@ namespace plot {
 BaseCurveData::BaseCurveData(CurveType curve_type) :
 	QwtSeriesData<QPointF>(),
 	type_(curve_type),
-	relative_time_(true)
+	relative_time_(true),
+	coarse_mode_(false),
+	coarse_full_size_(0)
 {
 }
 
@@ -56,6 +58,34 @@ bool BaseCurveData::is_relative_time() const
 	return relative_time_;
 }
 
+void BaseCurveData::set_coarse_mode(bool coarse_mode)
+{
+	coarse_mode_ = coarse_mode;
+	coarse_full_size_ = full_size();
+}
+
+bool BaseCurveData::is_coarse_mode() const
+{
+	return coarse_mode_;
+}
+
+bool BaseCurveData::is_coarse_outdated() const
+{
+	return coarse_mode_ && full_size() != coarse_full_size_;
+}
+
+void BaseCurveData::setRectOfInterest(const QRectF &rect)
+{
+	// Called by Qwt with every replot, the thinned out points are made
+	// from all points again.
+	(void)rect;
+	coarse_full_size_ = full_size();
+}
+
+void BaseCurveData::update_lod()
+{
+}
+
 } // namespace plot
 } // namespace widgets
 } // namespace ui
@@ -67,11 +67,33 @@ public:
 	void set_relative_time(bool is_relative_time);
 	bool is_relative_time() const;
 
+	/**
+	 * Enable or disable the coarse mode. In coarse mode, the curve data only
+	 * delivers a reduced set of points (at most coarse_max_points_) for the
+	 * visible area, so the curve can be repainted at interactive frame rates
+	 * while zooming or panning.
+	 */
+	virtual void set_coarse_mode(bool coarse_mode);
+	bool is_coarse_mode() const;
+	/**
+	 * True if the curve is in coarse mode and has new points, since the
+	 * coarse points were made. The curve must be replotted to show them.
+	 */
+	bool is_coarse_outdated() const;
+	/**
+	 * Prepare the data for the coarse mode in the background. The work per
+	 * call is bounded, so this can be called with every plot update.
+	 */
+	virtual void update_lod();
+	/** The number of points in full resolution (not in coarse mode). */
+	virtual size_t full_size() const = 0;
+
 	virtual bool is_equal(const BaseCurveData *other) const = 0;
 
 	virtual QPointF sample(size_t i) const = 0;
 	virtual size_t size() const = 0;
 	virtual QRectF boundingRect() const = 0;
+	void setRectOfInterest(const QRectF &rect) override;
 
 	virtual QPointF closest_point(const QPointF &pos, double *dist) const = 0;
 	virtual sv::data::Quantity x_quantity() const = 0;
@@ -91,6 +113,11 @@ public:
 protected:
 	const CurveType type_;
 	bool relative_time_;
+	bool coarse_mode_;
+	/** The full size, when the coarse points were made. */
+	size_t coarse_full_size_;
+
+	static const size_t coarse_max_points_ = 4000;
 
 };
 
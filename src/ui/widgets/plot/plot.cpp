@@ -25,6 +25,7 @@
 #include <utility>
 
 #include <QtMath>
+#include <QApplication>
 #include <QBoxLayout>
 #include <QDateTime>
 #include <QDebug>
@@ -72,6 +73,7 @@
 #include "src/ui/widgets/plot/curve.hpp"
 #include "src/ui/widgets/plot/plotmagnifier.hpp"
 #include "src/ui/widgets/plot/plotscalepicker.hpp"
+#include "src/ui/widgets/plot/timeaxiscontroller.hpp"
 #include "src/ui/widgets/plot/timecurvedata.hpp"
 #include "src/ui/widgets/plot/xycurvedata.hpp"
 
@@ -148,11 +150,14 @@ Plot::Plot(Session &session, QWidget *parent) : QwtPlot(parent),
 	timer_id_(-1),
 	time_span_(120.),
 	add_time_(30.),
+	time_axis_controller_(nullptr),
+	time_interval_changed_(false),
 	active_marker_(nullptr),
 	markers_label_(nullptr),
 	markers_label_alignment_(Qt::AlignBottom | Qt::AlignHCenter),
 	marker_select_picker_(nullptr),
-	marker_move_picker_(nullptr)
+	marker_move_picker_(nullptr),
+	coarse_mode_(false)
 {
 	this->setAutoReplot(false);
 	this->setCanvas(new Canvas());
@@ -193,18 +198,30 @@ Plot::Plot(Session &session, QWidget *parent) : QwtPlot(parent),
 
 	// Panning via the canvas
 	plot_panner_ = new QwtPlotPanner(this->canvas());
+	connect(plot_panner_, SIGNAL(moved(int, int)),
+		this, SLOT(begin_interactive_update()));
 	connect(plot_panner_, SIGNAL(panned(int, int)),
 		this, SLOT(lock_all_axis()));
 
 	// Zooming via the canvas
 	plot_magnifier_ = new PlotMagnifier(this->canvas());
+	connect(plot_magnifier_, SIGNAL(magnifying(double)),
+		this, SLOT(begin_interactive_update()));
 	connect(plot_magnifier_, SIGNAL(magnified(double)),
 		this, SLOT(lock_all_axis()));
+
+	// Refine the curves to full resolution when zooming/panning has ended.
+	refine_timer_ = new QTimer(this);
+	refine_timer_->setSingleShot(true);
+	refine_timer_->setInterval(refine_delay_);
+	connect(refine_timer_, &QTimer::timeout, this, &Plot::on_refine_timeout);
 }
 
 Plot::~Plot()
 {
 	this->stop();
+	if (time_axis_controller_)
+		time_axis_controller_->unlink_plot(this);
 	for (auto &marker_pair : marker_curve_map_)
 		delete marker_pair.first;
 	for (auto &curve_pair : curve_map_)
@@ -222,6 +239,46 @@ void Plot::stop()
 	killTimer(timer_id_);
 }
 
+void Plot::begin_interactive_update()
+{
+	if (!coarse_mode_) {
+		coarse_mode_ = true;
+		set_curves_coarse_mode(true);
+	}
+
+	// (Re)starting the timer discards a pending (now stale) refinement.
+	refine_timer_->start();
+}
+
+void Plot::on_refine_timeout()
+{
+	if (!coarse_mode_)
+		return;
+
+	// Postpone the refinement while the user is still dragging.
+	if (QApplication::mouseButtons() != Qt::NoButton) {
+		refine_timer_->start();
+		return;
+	}
+
+	coarse_mode_ = false;
+	// Curves with too many points stay in coarse mode, a full resolution
+	// replot of them would block the GUI. Their envelope is pixel accurate
+	// anyway.
+	for (const auto &curve : curve_map_) {
+		auto curve_data = curve.second->curve_data();
+		curve_data->set_coarse_mode(
+			curve_data->full_size() > refine_max_points_);
+	}
+	replot();
+}
+
+void Plot::set_curves_coarse_mode(bool coarse_mode)
+{
+	for (const auto &curve : curve_map_)
+		curve.second->curve_data()->set_coarse_mode(coarse_mode);
+}
+
 void Plot::replot()
 {
 	//qWarning() << "Plot::replot()";
@@ -229,6 +286,14 @@ void Plot::replot()
 		curve.second->set_painted_points(0);
 
 	QwtPlot::replot();
+
+	// Report zooming, panning or manually set boundaries of the time axis to
+	// the other linked plots. The controller ignores unchanged intervals.
+	if (time_axis_controller_) {
+		QwtInterval x_interval = this->axisInterval(QwtPlot::xBottom);
+		time_axis_controller_->on_plot_interval_changed(
+			this, x_interval.minValue(), x_interval.maxValue());
+	}
 }
 
 string Plot::add_curve(BaseCurveData *curve_data)
@@ -246,6 +311,8 @@ string Plot::add_curve(BaseCurveData *curve_data)
 		return "";
 
 	Curve *curve = new Curve(curve_data, x_axis_id, y_axis_id);
+	curve_data->set_coarse_mode(
+		coarse_mode_ || curve_data->full_size() > refine_max_points_);
 	curve->plot_curve()->attach(this);
 	curve_map_.insert(make_pair(curve->id(), curve));
 
@@ -270,6 +337,8 @@ bool Plot::add_curve(Curve *curve)
 	if (x_axis_id < 0)
 		return false;
 
+	curve->curve_data()->set_coarse_mode(coarse_mode_ ||
+		curve->curve_data()->full_size() > refine_max_points_);
 	curve->plot_curve()->attach(this);
 	curve_map_.insert(make_pair(curve->id(), curve));
 
@@ -479,6 +548,9 @@ void Plot::set_axis_locked(int axis_id, AxisBoundary axis_boundary, bool locked)
 {
 	axis_lock_map_[axis_id][axis_boundary] = locked;
 	Q_EMIT axis_lock_changed(axis_id, axis_boundary, locked);
+
+	if (time_axis_controller_ && axis_id == QwtPlot::xBottom)
+		time_axis_controller_->set_axis_locked(axis_boundary, locked);
 }
 
 void Plot::set_all_axis_locked(bool locked)
@@ -507,10 +579,30 @@ void Plot::on_axis_lock_clicked()
 	}
 }
 
+void Plot::set_update_mode(PlotUpdateMode update_mode)
+{
+	update_mode_ = update_mode;
+	if (time_axis_controller_)
+		time_axis_controller_->set_update_mode(update_mode);
+}
+
+void Plot::set_add_time(double add_time)
+{
+	add_time_ = add_time;
+	if (time_axis_controller_)
+		time_axis_controller_->set_add_time(add_time);
+}
+
 void Plot::set_time_span(double time_span)
 {
 	time_span_ = time_span;
 
+	// The controller calculates the new interval for all linked plots.
+	if (time_axis_controller_) {
+		time_axis_controller_->set_time_span(time_span);
+		return;
+	}
+
 	// time_span_ is used in rolling mode and oscilloscope mode. Find the
 	// last/highest x value/timestamp and use it to calculate the new
 	// x axis interval.
@@ -527,6 +619,90 @@ void Plot::set_time_span(double time_span)
 	this->replot();
 }
 
+void Plot::set_time_axis_linked(bool linked)
+{
+	if (linked)
+		session_.time_axis_controller()->link_plot(this);
+	else
+		session_.time_axis_controller()->unlink_plot(this);
+}
+
+void Plot::set_time_axis_controller(TimeAxisController *time_axis_controller)
+{
+	time_axis_controller_ = time_axis_controller;
+}
+
+bool Plot::time_bounds(double &first, double &last) const
+{
+	bool has_samples = false;
+	for (const auto &curve : curve_map_) {
+		BaseCurveData *curve_data = curve.second->curve_data();
+		if (curve_data->type() != CurveType::TimeCurve ||
+				curve_data->size() == 0)
+			continue;
+
+		QRectF boundaries = curve_data->boundingRect();
+		if (!has_samples || boundaries.left() < first)
+			first = boundaries.left();
+		if (!has_samples || boundaries.right() > last)
+			last = boundaries.right();
+		has_samples = true;
+	}
+	return has_samples;
+}
+
+void Plot::set_time_interval(double min, double max, bool shift_ticks)
+{
+	if (shift_ticks) {
+		// See update_x_interval() for the oscilloscope mode.
+		QwtInterval x_interval = this->axisInterval(QwtPlot::xBottom);
+		QwtScaleDiv scaleDiv = axisScaleDiv(QwtPlot::xBottom);
+		scaleDiv.setInterval(min, max);
+		for (int i = 0; i < QwtScaleDiv::NTickTypes; i++) {
+			QList<double> ticks = scaleDiv.ticks(i);
+			for (int j = 0; j < ticks.size(); j++) {
+				ticks[j] += x_interval.width();
+			}
+			scaleDiv.setTicks(i, ticks);
+		}
+		setAxisScaleDiv(QwtPlot::xBottom, scaleDiv);
+		for (const auto &curve : curve_map_)
+			curve.second->set_painted_points(0);
+	}
+	else {
+		setAxisScale(QwtPlot::xBottom, min, max);
+	}
+	time_interval_changed_ = true;
+}
+
+void Plot::update_frame()
+{
+	update_intervals();
+
+	// Aggregate the new samples for the coarse mode a bit at a time.
+	bool replot_coarse_curves = false;
+	for (const auto &curve : curve_map_) {
+		auto curve_data = curve.second->curve_data();
+		curve_data->update_lod();
+		if (!curve_data->is_coarse_mode() &&
+				curve_data->full_size() > refine_max_points_)
+			curve_data->set_coarse_mode(true);
+		if (curve_data->is_coarse_outdated())
+			replot_coarse_curves = true;
+	}
+
+	// The incremental painting of new points only works on the full
+	// resolution curves. While the user is zooming or panning the refinement
+	// will do a replot, otherwise the curves, that are kept in coarse mode,
+	// are replotted.
+	if (coarse_mode_)
+		return;
+	if (replot_coarse_curves)
+		replot();
+	else
+		update_curves();
+}
+
 void Plot::add_marker(sv::ui::widgets::plot::Curve *curve)
 {
 	auto marker = curve->add_marker(
@@ -704,6 +880,9 @@ void Plot::on_legend_clicked(const QVariant &item_info, int index)
 void Plot::update_curves()
 {
 	for (const auto &curve : curve_map_) {
+		// Curves in coarse mode are not painted incrementally.
+		if (curve.second->curve_data()->is_coarse_mode())
+			continue;
 		const size_t painted_points = curve.second->painted_points();
 		const size_t num_points = curve.second->curve_data()->size();
 		if (num_points > painted_points) {
@@ -739,10 +918,14 @@ void Plot::update_curves()
 
 void Plot::update_intervals()
 {
-	bool intervals_changed = false;
+	// The time axis of a linked plot is set by the time axis controller.
+	bool intervals_changed = time_interval_changed_;
+	time_interval_changed_ = false;
 
 	for (const auto &curve : curve_map_) {
-		if (update_x_interval(curve.second))
+		if ((!time_axis_controller_ ||
+				curve.second->curve_data()->type() != CurveType::TimeCurve) &&
+				update_x_interval(curve.second))
 			intervals_changed = true;
 		if (update_y_interval(curve.second))
 			intervals_changed = true;
@@ -970,8 +1153,9 @@ void Plot::update_markers_label()
 void Plot::timerEvent(QTimerEvent *event)
 {
 	if (event->timerId() == timer_id_) {
-		update_intervals();
-		update_curves();
+		// Linked plots are updated by the time axis controller.
+		if (!time_axis_controller_)
+			update_frame();
 		return;
 	}
 
@@ -1005,6 +1189,7 @@ void Plot::save_settings(QSettings &settings, bool save_curves,
 	settings.setValue("update_mode", (int)update_mode());
 	settings.setValue("time_span", time_span_);
 	settings.setValue("add_time", add_time_);
+	settings.setValue("time_axis_linked", is_time_axis_linked());
 
 	if (!save_curves)
 		return;
@@ -1024,17 +1209,21 @@ void Plot::restore_settings(QSettings &settings, bool restore_curves,
 	if (settings.contains("add_time"))
 		add_time_ = settings.value("add_time").toDouble();
 
-	if (!restore_curves)
-		return;
-	const auto groups = settings.childGroups();
-	for (const auto &group : groups) {
-		if (group.startsWith("timecurve:") || group.startsWith("xycurve:")) {
-			Curve *curve = Curve::init_from_settings(
-				session_, settings, group, origin_device);
-			if (curve)
-				add_curve(curve);
+	if (restore_curves) {
+		const auto groups = settings.childGroups();
+		for (const auto &group : groups) {
+			if (group.startsWith("timecurve:") || group.startsWith("xycurve:")) {
+				Curve *curve = Curve::init_from_settings(
+					session_, settings, group, origin_device);
+				if (curve)
+					add_curve(curve);
+			}
 		}
 	}
+
+	// Link after the curves are restored, so the time axis is initialized.
+	if (settings.value("time_axis_linked", false).toBool())
+		set_time_axis_linked(true);
 }
 
 Curve *Plot::get_curve_from_plot_curve(const QwtPlotCurve *plot_curve) const
@@ -28,6 +28,7 @@
 
 #include <QSettings>
 #include <QString>
+#include <QTimer>
 #include <QVariant>
 
 #include <qwt_interval.h>
@@ -64,6 +65,7 @@ namespace plot {
 class BaseCurveData;
 class Curve;
 class PlotMagnifier;
+class TimeAxisController;
 
 enum class AxisBoundary {
 	LowerBoundary,
@@ -110,12 +112,35 @@ public:
 	void set_axis_locked(int axis_id, AxisBoundary axis_boundary, bool locked);
 	void set_all_axis_locked(bool locked);
 	void set_plot_interval(int plot_interval) { plot_interval_ = plot_interval; }
-	void set_update_mode(PlotUpdateMode update_mode) { update_mode_ = update_mode; }
+	void set_update_mode(PlotUpdateMode update_mode);
 	PlotUpdateMode update_mode() const { return update_mode_; };
 	void set_time_span(double time_span);
 	double time_span() const { return time_span_; }
-	void set_add_time(double add_time) { add_time_ = add_time; }
+	void set_add_time(double add_time);
 	double add_time() const { return add_time_; }
+	/**
+	 * Link the time axis of this plot to the shared time axis controller of
+	 * the session, or unlink it.
+	 */
+	void set_time_axis_linked(bool linked);
+	bool is_time_axis_linked() const { return time_axis_controller_ != nullptr; }
+	/**
+	 * Set by TimeAxisController::link_plot()/unlink_plot(). While linked, the
+	 * plot is updated by the controller and not by its own timer.
+	 */
+	void set_time_axis_controller(TimeAxisController *time_axis_controller);
+	/**
+	 * Get the first and last timestamp of all time curves. Return false if
+	 * there are no time curves with samples.
+	 */
+	bool time_bounds(double &first, double &last) const;
+	/**
+	 * Set the time axis interval without notifying the time axis controller.
+	 * The plot is replotted with the next frame.
+	 */
+	void set_time_interval(double min, double max, bool shift_ticks);
+	/** Update the axis intervals and paint the new points of all curves. */
+	void update_frame();
 	map<QwtPlotMarker *, Curve *> marker_curve_map() const { return marker_curve_map_; }
 	void set_markers_label_alignment(int alignment);
 	int markers_label_alignment() const { return markers_label_alignment_; }
@@ -128,6 +153,12 @@ public:
 public Q_SLOTS:
 	void start();
 	void stop();
+	/**
+	 * Switch all curves to the coarse mode while the user is zooming or
+	 * panning. The curves are refined to full resolution, when there was no
+	 * further interaction for refine_delay_ ms.
+	 */
+	void begin_interactive_update();
 	void add_axis_icons(const int axis_id);
 	void lock_all_axis();
 	void on_axis_lock_clicked();
@@ -138,6 +169,9 @@ public Q_SLOTS:
 	void on_marker_moved(const QPointF mouse_pos);
 	void on_legend_clicked(const QVariant &item_info, int index);
 
+private Q_SLOTS:
+	void on_refine_timeout();
+
 protected:
 	virtual void showEvent(QShowEvent *event) override;
 	virtual void resizeEvent(QResizeEvent *event) override;
@@ -154,6 +188,7 @@ private:
 	bool update_y_interval(const Curve *curve);
 	void update_markers_label();
 	Curve *get_curve_from_plot_curve(const QwtPlotCurve *plot_curve) const;
+	void set_curves_coarse_mode(bool coarse_mode);
 
 	Session &session_;
 	map<string, Curve *> curve_map_;
@@ -163,9 +198,16 @@ private:
 	PlotUpdateMode update_mode_;
 	double time_span_;
 	double add_time_;
+	TimeAxisController *time_axis_controller_;
+	bool time_interval_changed_;
 
 	QwtPlotPanner *plot_panner_;
 	PlotMagnifier *plot_magnifier_;
+	bool coarse_mode_;
+	QTimer *refine_timer_;
+	static const int refine_delay_ = 300;
+	/** Curves with more points are not refined to full resolution. */
+	static const size_t refine_max_points_ = 1000000;
 
 	map<QwtPlotMarker *, Curve *> marker_curve_map_;
 	vector<pair<QwtPlotMarker *, QwtPlotMarker *>> diff_markers_;
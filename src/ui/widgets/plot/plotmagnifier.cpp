@@ -34,6 +34,7 @@ PlotMagnifier::PlotMagnifier(QWidget *canvas) :
 
 void PlotMagnifier::rescale(double factor)
 {
+	Q_EMIT magnifying(factor);
 	QwtPlotMagnifier::rescale(factor);
 	Q_EMIT magnified(factor);
 }
@@ -45,6 +45,8 @@ protected:
 	void rescale(double factor) override;
 
 Q_SIGNALS:
+	/** Emitted before the plot is rescaled (and replotted). */
+	void magnifying(double factor);
 	void magnified(double factor);
 
 };
@@ -0,0 +1,263 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include <QObject>
+#include <QTimer>
+#include <qwt_interval.h>
+#include <qwt_plot.h>
+
+#include "timeaxiscontroller.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
+
+using std::map;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+TimeAxisController::TimeAxisController(QObject *parent) :
+	QObject(parent),
+	update_mode_(PlotUpdateMode::Additive),
+	time_span_(120.),
+	add_time_(30.),
+	min_(0.),
+	max_(0.)
+{
+	axis_lock_map_[AxisBoundary::LowerBoundary] = false;
+	axis_lock_map_[AxisBoundary::UpperBoundary] = false;
+
+	timer_ = new QTimer(this);
+	timer_->setInterval(plot_interval_);
+	connect(timer_, &QTimer::timeout, this, &TimeAxisController::on_timeout);
+}
+
+void TimeAxisController::link_plot(Plot *plot)
+{
+	if (!plot || is_linked(plot))
+		return;
+
+	if (plots_.empty()) {
+		// The first plot defines the settings and the time window.
+		update_mode_ = plot->update_mode();
+		time_span_ = plot->time_span();
+		add_time_ = plot->add_time();
+		QwtInterval interval = plot->axisInterval(QwtPlot::xBottom);
+		min_ = interval.minValue();
+		max_ = interval.maxValue();
+		axis_lock_map_[AxisBoundary::LowerBoundary] = plot->is_axis_locked(
+			QwtPlot::xBottom, AxisBoundary::LowerBoundary);
+		axis_lock_map_[AxisBoundary::UpperBoundary] = plot->is_axis_locked(
+			QwtPlot::xBottom, AxisBoundary::UpperBoundary);
+		plots_.push_back(plot);
+		plot->set_time_axis_controller(this);
+		timer_->start();
+		return;
+	}
+
+	plots_.push_back(plot);
+	plot->set_time_axis_controller(this);
+	plot->set_update_mode(update_mode_);
+	plot->set_time_span(time_span_);
+	plot->set_add_time(add_time_);
+	for (const auto &lock : axis_lock_map_)
+		plot->set_axis_locked(QwtPlot::xBottom, lock.first, lock.second);
+	plot->set_time_interval(min_, max_, false);
+	plot->replot();
+}
+
+void TimeAxisController::unlink_plot(Plot *plot)
+{
+	auto it = std::find(plots_.begin(), plots_.end(), plot);
+	if (it == plots_.end())
+		return;
+
+	plots_.erase(it);
+	plot->set_time_axis_controller(nullptr);
+	if (plots_.empty())
+		timer_->stop();
+}
+
+bool TimeAxisController::is_linked(const Plot *plot) const
+{
+	return std::find(plots_.begin(), plots_.end(), plot) != plots_.end();
+}
+
+void TimeAxisController::set_update_mode(PlotUpdateMode update_mode)
+{
+	if (update_mode == update_mode_)
+		return;
+
+	update_mode_ = update_mode;
+	for (const auto &plot : plots_)
+		plot->set_update_mode(update_mode_);
+}
+
+void TimeAxisController::set_time_span(double time_span)
+{
+	if (time_span == time_span_)
+		return;
+
+	time_span_ = time_span;
+	for (const auto &plot : plots_)
+		plot->set_time_span(time_span_);
+
+	// Same as Plot::set_time_span(): The window ends at the last timestamp.
+	double first = 0.;
+	double last = 0.;
+	max_ = 0.;
+	for (const auto &plot : plots_) {
+		if (plot->time_bounds(first, last) && last > max_)
+			max_ = last;
+	}
+	min_ = max_ - time_span_;
+	push_interval(nullptr, false);
+	for (const auto &plot : plots_)
+		plot->replot();
+}
+
+void TimeAxisController::set_add_time(double add_time)
+{
+	if (add_time == add_time_)
+		return;
+
+	add_time_ = add_time;
+	for (const auto &plot : plots_)
+		plot->set_add_time(add_time_);
+}
+
+void TimeAxisController::set_axis_locked(AxisBoundary axis_boundary,
+	bool locked)
+{
+	if (axis_lock_map_[axis_boundary] == locked)
+		return;
+
+	axis_lock_map_[axis_boundary] = locked;
+	for (const auto &plot : plots_)
+		plot->set_axis_locked(QwtPlot::xBottom, axis_boundary, locked);
+}
+
+void TimeAxisController::on_plot_interval_changed(Plot *plot,
+	double min, double max)
+{
+	if (min == min_ && max == max_)
+		return;
+
+	min_ = min;
+	max_ = max;
+	push_interval(plot, false);
+	for (const auto &p : plots_) {
+		if (p == plot)
+			continue;
+		// The other plots are following an interaction, so they can use
+		// the coarse mode, too.
+		p->begin_interactive_update();
+		p->replot();
+	}
+}
+
+bool TimeAxisController::update_interval()
+{
+	// The newest (and oldest) timestamp of all linked plots.
+	double first = std::numeric_limits<double>::max();
+	double last = std::numeric_limits<double>::lowest();
+	bool has_curves = false;
+	for (const auto &plot : plots_) {
+		double plot_first;
+		double plot_last;
+		if (!plot->time_bounds(plot_first, plot_last))
+			continue;
+		first = std::min(first, plot_first);
+		last = std::max(last, plot_last);
+		has_curves = true;
+	}
+	if (!has_curves)
+		return false;
+
+	if (axis_lock_map_[AxisBoundary::LowerBoundary] &&
+		axis_lock_map_[AxisBoundary::UpperBoundary])
+		return false;
+
+	// This is the logic of Plot::update_x_interval() for time curves.
+	bool interval_changed = false;
+	if (update_mode_ == PlotUpdateMode::Additive) {
+		if (!axis_lock_map_[AxisBoundary::LowerBoundary] && first < min_) {
+			min_ = 0;
+			interval_changed = true;
+		}
+		if (!axis_lock_map_[AxisBoundary::UpperBoundary] && last > max_) {
+			max_ = last + add_time_;
+			interval_changed = true;
+		}
+	}
+	else if (update_mode_ == PlotUpdateMode::Rolling) {
+		if (last <= max_)
+			return false;
+
+		if (last > max_ + time_span_)
+			min_ = last;
+		else
+			min_ += add_time_;
+		max_ = min_ + time_span_;
+		interval_changed = true;
+	}
+	else if (update_mode_ == PlotUpdateMode::Oscilloscope) {
+		if (last <= max_)
+			return false;
+
+		if (last > max_ + time_span_)
+			min_ = last;
+		else
+			min_ += time_span_;
+		max_ = min_ + time_span_;
+		interval_changed = true;
+	}
+
+	return interval_changed;
+}
+
+void TimeAxisController::push_interval(const Plot *origin_plot,
+	bool shift_ticks)
+{
+	for (const auto &plot : plots_) {
+		if (plot != origin_plot)
+			plot->set_time_interval(min_, max_, shift_ticks);
+	}
+}
+
+void TimeAxisController::on_timeout()
+{
+	// The time window is only calculated once for all linked plots.
+	if (update_interval())
+		push_interval(nullptr, update_mode_ == PlotUpdateMode::Oscilloscope);
+
+	for (const auto &plot : plots_)
+		plot->update_frame();
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
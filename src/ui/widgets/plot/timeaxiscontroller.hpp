@@ -0,0 +1,105 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_TIMEAXISCONTROLLER_HPP
+#define UI_WIDGETS_PLOT_TIMEAXISCONTROLLER_HPP
+
+#include <map>
+#include <vector>
+
+#include <QObject>
+#include <QTimer>
+
+#include "src/ui/widgets/plot/plot.hpp"
+
+using std::map;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+/**
+ * Shared time axis (x axis) for linked time plots.
+ *
+ * The controller drives the updates of all linked plots with a single timer:
+ * The visible time window is calculated once per frame from the newest
+ * timestamp of all linked plots and is then pushed to every linked plot.
+ * Zooming or panning the time axis of one linked plot moves the time axis of
+ * all linked plots. The update mode, the time span and the add time are the
+ * same for all linked plots.
+ */
+class TimeAxisController : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit TimeAxisController(QObject *parent = nullptr);
+
+	/**
+	 * Link a plot to the shared time axis. The first linked plot defines the
+	 * update mode, the time span, the add time and the time window. Plots
+	 * that are linked later take over the settings of the controller.
+	 */
+	void link_plot(Plot *plot);
+	void unlink_plot(Plot *plot);
+	bool is_linked(const Plot *plot) const;
+
+	void set_update_mode(PlotUpdateMode update_mode);
+	PlotUpdateMode update_mode() const { return update_mode_; }
+	void set_time_span(double time_span);
+	double time_span() const { return time_span_; }
+	void set_add_time(double add_time);
+	double add_time() const { return add_time_; }
+	void set_axis_locked(AxisBoundary axis_boundary, bool locked);
+
+	/**
+	 * Called by a linked plot, when its time axis was changed (f.e. by
+	 * zooming or panning). The new time window is pushed to all other
+	 * linked plots.
+	 */
+	void on_plot_interval_changed(Plot *plot, double min, double max);
+
+private:
+	bool update_interval();
+	void push_interval(const Plot *origin_plot, bool shift_ticks);
+
+	vector<Plot *> plots_;
+	QTimer *timer_;
+	PlotUpdateMode update_mode_;
+	double time_span_;
+	double add_time_;
+	double min_;
+	double max_;
+	map<AxisBoundary, bool> axis_lock_map_;
+
+	static const int plot_interval_ = 200;
+
+private Q_SLOTS:
+	void on_timeout();
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_TIMEAXISCONTROLLER_HPP
@@ -17,8 +17,10 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include <QPointF>
 #include <QRectF>
@@ -36,6 +38,7 @@
 using std::dynamic_pointer_cast;
 using std::set;
 using std::shared_ptr;
+using std::vector;
 
 namespace sv {
 namespace ui {
@@ -44,7 +47,8 @@ namespace plot {
 
 TimeCurveData::TimeCurveData(shared_ptr<sv::data::AnalogTimeSignal> signal) :
 	BaseCurveData(CurveType::TimeCurve),
-	signal_(signal)
+	signal_(signal),
+	lod_sample_pos_(0)
 {
 }
 
@@ -59,18 +63,17 @@ bool TimeCurveData::is_equal(const BaseCurveData *other) const
 
 QPointF TimeCurveData::sample(size_t i) const
 {
-	//signal_data_->lock();
+	if (coarse_mode_)
+		return lod_points_[i];
 
-	auto sample = signal_->get_sample(i, relative_time_);
-	QPointF sample_point(sample.first, sample.second);
-
-	//signal_data_->.unlock();
-
-	return sample_point;
+	return raw_sample(i);
 }
 
 size_t TimeCurveData::size() const
 {
+	if (coarse_mode_)
+		return lod_points_.size();
+
 	// TODO: Synchronize x/y sample data
 	return signal_->sample_count();
 }
@@ -94,19 +97,52 @@ QRectF TimeCurveData::boundingRect() const
 		QPointF(signal_->last_timestamp(relative_time_), signal_->min_value()));
 }
 
+void TimeCurveData::setRectOfInterest(const QRectF &rect)
+{
+	rect_of_interest_ = rect;
+	if (coarse_mode_)
+		update_lod_points();
+}
+
+void TimeCurveData::set_coarse_mode(bool coarse_mode)
+{
+	if (coarse_mode == coarse_mode_)
+		return;
+
+	coarse_mode_ = coarse_mode;
+	if (coarse_mode_) {
+		update_lod_points();
+	}
+	else {
+		lod_points_.clear();
+		lod_points_.shrink_to_fit();
+	}
+}
+
+void TimeCurveData::update_lod()
+{
+	update_lod_levels(lod_update_max_samples_);
+}
+
+size_t TimeCurveData::full_size() const
+{
+	return signal_->sample_count();
+}
+
 QPointF TimeCurveData::closest_point(const QPointF &pos, double *dist) const
 {
+	// Always use the raw samples, also when in coarse mode.
 	(void)dist;
 	const double x_value = pos.x();
-	const int index_max = (int)size() - 1;
+	const int index_max = (int)signal_->sample_count() - 1;
 
 	// Corner cases
 	if (index_max < 0)
 		return QPointF(0, 0);
-	if (x_value <= sample(0).x())
-		return sample(0);
-	if (x_value >= sample(index_max).x())
-		return sample(index_max);
+	if (x_value <= raw_sample(0).x())
+		return raw_sample(0);
+	if (x_value >= raw_sample(index_max).x())
+		return raw_sample(index_max);
 
 	size_t index_min = 0;
 	size_t n = index_max;
@@ -115,7 +151,7 @@ QPointF TimeCurveData::closest_point(const QPointF &pos, double *dist) const
 		const size_t half = n >> 1;
 		const size_t index_mid = index_min + half;
 
-		if (x_value < sample(index_mid).x()) {
+		if (x_value < raw_sample(index_mid).x()) {
 			n = half;
 		}
 		else {
@@ -124,7 +160,7 @@ QPointF TimeCurveData::closest_point(const QPointF &pos, double *dist) const
 		}
 	}
 
-	return sample(index_min);
+	return raw_sample(index_min);
 }
 
 QString TimeCurveData::name() const
@@ -214,6 +250,181 @@ TimeCurveData *TimeCurveData::init_from_settings(
 		dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal));
 }
 
+QPointF TimeCurveData::raw_sample(size_t i) const
+{
+	auto sample = signal_->get_sample(i, relative_time_);
+	return QPointF(sample.first, sample.second);
+}
+
+size_t TimeCurveData::lod_bucket_size(size_t level) const
+{
+	size_t bucket_size = lod_base_bucket_size_;
+	for (size_t i = 0; i < level; ++i)
+		bucket_size *= lod_level_factor_;
+	return bucket_size;
+}
+
+void TimeCurveData::update_lod_levels(size_t max_samples)
+{
+	const size_t sample_count = signal_->sample_count();
+
+	// The signal has been cleared, start over.
+	if (sample_count < lod_sample_pos_) {
+		lod_levels_.clear();
+		lod_sample_pos_ = 0;
+	}
+	if (lod_levels_.empty())
+		lod_levels_.emplace_back();
+
+	// Only aggregate the new samples into level 0. Incomplete buckets at the
+	// end of a level are not aggregated, they are taken from the finer levels
+	// (or the raw samples) in append_lod_points().
+	// The samples of a bucket are read at once. Downsampled (retained)
+	// samples use their envelope, so they still show their min and max
+	// values.
+	const size_t retained_count = signal_->retained_sample_count();
+	const size_t end_pos = lod_sample_pos_ + max_samples;
+	vector<double> timestamps;
+	vector<double> values;
+	while (lod_sample_pos_ + lod_base_bucket_size_ <= sample_count &&
+			lod_sample_pos_ < end_pos) {
+		if (signal_->get_samples(lod_sample_pos_, lod_base_bucket_size_,
+				timestamps, values, false) < lod_base_bucket_size_)
+			break;
+		LodBucket bucket = { timestamps[0], values[0], timestamps[0], values[0] };
+		for (size_t i = 0; i < lod_base_bucket_size_; ++i) {
+			double min = values[i];
+			double max = values[i];
+			if (lod_sample_pos_ + i < retained_count) {
+				auto envelope = signal_->get_envelope(lod_sample_pos_ + i);
+				min = envelope.first;
+				max = envelope.second;
+			}
+			if (min < bucket.min) {
+				bucket.min = min;
+				bucket.min_ts = timestamps[i];
+			}
+			if (max > bucket.max) {
+				bucket.max = max;
+				bucket.max_ts = timestamps[i];
+			}
+		}
+		lod_levels_[0].push_back(bucket);
+		lod_sample_pos_ += lod_base_bucket_size_;
+	}
+
+	// Aggregate the new buckets of each level into the next coarser level.
+	for (size_t level = 1; level <= lod_levels_.size(); ++level) {
+		const size_t lower_count = lod_levels_[level-1].size();
+		if (lower_count < lod_level_factor_)
+			break;
+		if (level == lod_levels_.size())
+			lod_levels_.emplace_back();
+
+		while ((lod_levels_[level].size() + 1) * lod_level_factor_ <=
+				lod_levels_[level-1].size()) {
+			const auto &lower = lod_levels_[level-1];
+			size_t pos = lod_levels_[level].size() * lod_level_factor_;
+			LodBucket bucket = lower[pos];
+			for (size_t i = 1; i < lod_level_factor_; ++i) {
+				const LodBucket &lower_bucket = lower[pos + i];
+				if (lower_bucket.min < bucket.min) {
+					bucket.min = lower_bucket.min;
+					bucket.min_ts = lower_bucket.min_ts;
+				}
+				if (lower_bucket.max > bucket.max) {
+					bucket.max = lower_bucket.max;
+					bucket.max_ts = lower_bucket.max_ts;
+				}
+			}
+			lod_levels_[level].push_back(bucket);
+		}
+	}
+}
+
+void TimeCurveData::update_lod_points()
+{
+	// The levels are completed by update_lod() in the background, the not
+	// yet aggregated samples are thinned out in append_lod_points().
+	update_lod_levels(lod_update_max_samples_);
+	lod_points_.clear();
+
+	const size_t sample_count = signal_->sample_count();
+	coarse_full_size_ = sample_count;
+	if (sample_count == 0)
+		return;
+
+	// Find the visible range of samples, including one sample on each side,
+	// so the curve is continued to the canvas borders.
+	size_t from = 0;
+	size_t to = sample_count;
+	if (rect_of_interest_.isValid()) {
+		from = signal_->lower_bound_pos(rect_of_interest_.left(), relative_time_);
+		to = signal_->lower_bound_pos(rect_of_interest_.right(), relative_time_);
+		if (from > 0)
+			--from;
+		to = std::min(to + 1, sample_count);
+	}
+	if (from >= to)
+		return;
+
+	// Use the finest level that has not more than coarse_max_points_ points
+	// (two points per bucket) in the visible range.
+	const size_t count = to - from;
+	int level = -1;
+	if (count > coarse_max_points_) {
+		level = 0;
+		while ((size_t)level + 1 < lod_levels_.size() &&
+				2 * count / lod_bucket_size(level) > coarse_max_points_)
+			++level;
+	}
+
+	lod_points_.reserve(coarse_max_points_ + 2 * lod_base_bucket_size_);
+	append_lod_points(level, from, to);
+}
+
+void TimeCurveData::append_lod_points(int level, size_t from, size_t to)
+{
+	if (level < 0) {
+		// Thin out a large range of raw samples, that is not aggregated yet.
+		const size_t stride = (to - from) / coarse_max_points_ + 1;
+		for (size_t i = from; i < to; i += stride)
+			lod_points_.push_back(raw_sample(i));
+		return;
+	}
+
+	const size_t bucket_size = lod_bucket_size(level);
+	const auto &buckets = lod_levels_[level];
+	const size_t aggregated = buckets.size() * bucket_size;
+
+	if (from < aggregated) {
+		const size_t bucket_to =
+			(std::min(to, aggregated) + bucket_size - 1) / bucket_size;
+		for (size_t b = from / bucket_size; b < bucket_to; ++b) {
+			const LodBucket &bucket = buckets[b];
+			if (bucket.min_ts <= bucket.max_ts) {
+				append_lod_point(bucket.min_ts, bucket.min);
+				append_lod_point(bucket.max_ts, bucket.max);
+			}
+			else {
+				append_lod_point(bucket.max_ts, bucket.max);
+				append_lod_point(bucket.min_ts, bucket.min);
+			}
+		}
+	}
+
+	// The rest of the range is not (yet) aggregated in this level.
+	if (to > aggregated)
+		append_lod_points(level - 1, std::max(from, aggregated), to);
+}
+
+void TimeCurveData::append_lod_point(double timestamp, double value)
+{
+	if (relative_time_)
+		timestamp -= signal_->signal_start_timestamp();
+	lod_points_.emplace_back(timestamp, value);
+}
+
 } // namespace plot
 } // namespace widgets
 } // namespace ui
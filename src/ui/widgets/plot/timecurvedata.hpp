@@ -23,6 +23,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QPointF>
 #include <QRectF>
@@ -35,6 +36,7 @@
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 
@@ -63,6 +65,10 @@ public:
 	QPointF sample(size_t i) const override;
 	size_t size() const override;
 	QRectF boundingRect() const override;
+	void setRectOfInterest(const QRectF &rect) override;
+	void set_coarse_mode(bool coarse_mode) override;
+	void update_lod() override;
+	size_t full_size() const override;
 
 	QPointF closest_point(const QPointF &pos, double *dist) const override;
 	QString name() const override;
@@ -87,7 +93,42 @@ public:
 		shared_ptr<sv::devices::BaseDevice> origin_device);
 
 private:
+	/**
+	 * A pre-aggregated bucket of the level of detail (LOD) pyramid. Only the
+	 * min and max values (and their timestamps) of a bucket are stored, so
+	 * the envelope of the signal is preserved.
+	 */
+	struct LodBucket {
+		double min_ts;
+		double min;
+		double max_ts;
+		double max;
+	};
+
+	QPointF raw_sample(size_t i) const;
+	size_t lod_bucket_size(size_t level) const;
+	/**
+	 * Aggregate at most max_samples new samples into the LOD levels. The
+	 * remaining samples are aggregated with the next calls.
+	 */
+	void update_lod_levels(size_t max_samples);
+	void update_lod_points();
+	void append_lod_points(int level, size_t from, size_t to);
+	void append_lod_point(double timestamp, double value);
+
 	shared_ptr<sv::data::AnalogTimeSignal> signal_;
+	/** Level 0 aggregates raw samples, level n aggregates level n-1 buckets. */
+	vector<vector<LodBucket>> lod_levels_;
+	/** Number of raw samples that are aggregated in level 0. */
+	size_t lod_sample_pos_;
+	/** The points that are delivered in coarse mode. */
+	vector<QPointF> lod_points_;
+	QRectF rect_of_interest_;
+
+	static const size_t lod_base_bucket_size_ = 64;
+	static const size_t lod_level_factor_ = 8;
+	/** The max. number of samples, that are aggregated per update. */
+	static const size_t lod_update_max_samples_ = 65536;
 
 };
 
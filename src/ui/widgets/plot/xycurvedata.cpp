@@ -81,15 +81,35 @@ bool XYCurveData::is_equal(const BaseCurveData *other) const
 
 QPointF XYCurveData::sample(size_t i) const
 {
+	if (coarse_mode_)
+		i *= coarse_stride();
+
 	QPointF sample_point(x_data_->at(i), y_data_->at(i));
 	return sample_point;
 }
 
 size_t XYCurveData::size() const
+{
+	if (coarse_mode_) {
+		const size_t stride = coarse_stride();
+		return (x_data_->size() + stride - 1) / stride;
+	}
+
+	return x_data_->size();
+}
+
+size_t XYCurveData::full_size() const
 {
 	return x_data_->size();
 }
 
+size_t XYCurveData::coarse_stride() const
+{
+	// XY curves are not ordered by x, so there is no pre-aggregation. Just
+	// thin out the points.
+	return x_data_->size() / coarse_max_points_ + 1;
+}
+
 QRectF XYCurveData::boundingRect() const
 {
 	// top left, bottom right
@@ -100,7 +120,8 @@ QRectF XYCurveData::boundingRect() const
 
 QPointF XYCurveData::closest_point(const QPointF &pos, double *dist) const
 {
-	const size_t num_samples = size();
+	// Always use all samples, also when in coarse mode.
+	const size_t num_samples = x_data_->size();
 	if (num_samples == 0)
 		return QPointF(0, 0); // TODO
 
@@ -108,7 +129,7 @@ QPointF XYCurveData::closest_point(const QPointF &pos, double *dist) const
 	double dmin = 1.0e10;
 
 	for (size_t i=0; i < num_samples; i++) {
-		const QPointF s = sample(i);
+		const QPointF s(x_data_->at(i), y_data_->at(i));
 		const double cx = s.x() - pos.x();
 		const double cy = s.y() - pos.y();
 		const double d = qwtSqr(cx) + qwtSqr(cy);
@@ -120,7 +141,7 @@ QPointF XYCurveData::closest_point(const QPointF &pos, double *dist) const
 	if (dist)
 		*dist = qSqrt(dmin);
 
-	return sample(index);
+	return QPointF(x_data_->at(index), y_data_->at(index));
 }
 
 QString XYCurveData::name() const
@@ -71,6 +71,7 @@ public:
 
 	QPointF sample(size_t i) const override;
 	size_t size() const override;
+	size_t full_size() const override;
 	QRectF boundingRect() const override;
 
 	QPointF closest_point(const QPointF &pos, double *dist) const override;
@@ -97,6 +98,8 @@ public:
 		shared_ptr<sv::devices::BaseDevice> origin_device);
 
 private:
+	size_t coarse_stride() const;
+
 	shared_ptr<sv::data::AnalogTimeSignal> x_t_signal_;
 	shared_ptr<sv::data::AnalogTimeSignal> y_t_signal_;
 	size_t x_t_signal_pos_;
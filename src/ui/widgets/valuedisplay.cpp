@@ -17,10 +17,16 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
+#include <vector>
 
+#include <QApplication>
 #include <QFrame>
+#include <QLocale>
 #include <QString>
+#include <QTimer>
 
 #include "valuedisplay.hpp"
 #include "src/util.hpp"
@@ -29,6 +35,9 @@ namespace sv {
 namespace ui {
 namespace widgets {
 
+vector<ValueDisplay *> ValueDisplay::pending_displays_;
+QTimer *ValueDisplay::refresh_timer_ = nullptr;
+
 ValueDisplay::ValueDisplay(
 		int digits, int decimal_places, const bool auto_range,
 		const QString &unit, const QString &unit_suffix,
@@ -41,12 +50,19 @@ ValueDisplay::ValueDisplay(
 	extra_text_(extra_text),
 	extra_text_changed_(true),
 	unit_(unit),
-	unit_si_prefix_(""),
+	unit_si_prefix_(util::SIPrefix::none),
 	unit_suffix_(unit_suffix),
 	unit_changed_(true),
 	small_(small),
-	value_(.0)
+	value_(.0),
+	update_pending_(false)
 {
+	value_text_[0] = '\0';
+}
+
+ValueDisplay::~ValueDisplay()
+{
+	cancel_update();
 }
 
 double ValueDisplay::value() const
@@ -57,7 +73,49 @@ double ValueDisplay::value() const
 void ValueDisplay::set_value(const double value)
 {
 	value_ = value;
-	update_display();
+	schedule_update();
+}
+
+void ValueDisplay::schedule_update()
+{
+	if (update_pending_)
+		return;
+
+	update_pending_ = true;
+	pending_displays_.push_back(this);
+	if (!refresh_timer_) {
+		// The timer is shared by all displays, so it is owned by the
+		// application.
+		refresh_timer_ = new QTimer(qApp);
+		refresh_timer_->setSingleShot(true);
+		refresh_timer_->setInterval(refresh_interval_);
+		QObject::connect(refresh_timer_, &QTimer::timeout,
+			&ValueDisplay::show_pending_displays);
+	}
+	if (!refresh_timer_->isActive())
+		refresh_timer_->start();
+}
+
+void ValueDisplay::cancel_update()
+{
+	if (!update_pending_)
+		return;
+
+	update_pending_ = false;
+	pending_displays_.erase(
+		std::remove(pending_displays_.begin(), pending_displays_.end(), this),
+		pending_displays_.end());
+}
+
+void ValueDisplay::show_pending_displays()
+{
+	// Swap the list, update_display() could schedule new updates.
+	vector<ValueDisplay *> displays;
+	displays.swap(pending_displays_);
+	for (const auto &display : displays) {
+		display->update_pending_ = false;
+		display->update_display();
+	}
 }
 
 void ValueDisplay::set_extra_text(const QString &extra_text)
@@ -86,11 +144,15 @@ void ValueDisplay::set_digits(const int digits, const int decimal_places)
 	digits_ = digits;
 	decimal_places_ = decimal_places;
 	digits_changed_ = true;
+	value_text_[0] = '\0';
 	update_display();
 }
 
 void ValueDisplay::reset_value()
 {
+	cancel_update();
+	value_text_[0] = '\0';
+
 	QString init_value("");
 	for (int i=0; i<digits_; i++)
 		init_value.append("-");
@@ -99,28 +161,37 @@ void ValueDisplay::reset_value()
 
 void ValueDisplay::update_display()
 {
-	QString value_str("");
-	QString si_prefix("");
+	char value_text[sizeof(value_text_)];
+	util::SIPrefix si_prefix = util::SIPrefix::none;
 
 	if (value_ >= std::numeric_limits<double>::max() ||
 			value_ == std::numeric_limits<double>::infinity()) {
 		// TODO: Replace with "ol" or "overl", depending on the avail. digits.
-		value_str = QString("OL");
+		std::strcpy(value_text, "OL");
 	}
 	else if (value_ <= std::numeric_limits<double>::lowest()) {
 		// TODO: Replace with "ul" or "underf", depending on the avail. digits.
-		value_str = QString("UL");
+		std::strcpy(value_text, "UL");
 	}
 	else if (!auto_range_) {
-		// Use actual locale (%L) for formating
-		value_str = QString("%L1").
-			arg(value_, digits_, 'f', decimal_places_, QChar(' '));
+		util::format_value(value_, digits_, decimal_places_,
+			value_text, sizeof(value_text));
 	}
 	else {
-		util::format_value_si(
-			value_, digits_, decimal_places_, value_str, si_prefix);
+		util::format_value_si(value_, digits_, decimal_places_,
+			value_text, sizeof(value_text), si_prefix);
+	}
+
+	// Only update the widget, when the text has changed.
+	if (std::strcmp(value_text, value_text_) != 0) {
+		std::strcpy(value_text_, value_text);
+		// Use actual locale for the decimal point.
+		QString value_str = QString::fromLatin1(value_text);
+		const QChar decimal_point = QLocale().decimalPoint();
+		if (decimal_point != QChar('.'))
+			value_str.replace(QChar('.'), decimal_point);
+		show_value(value_str);
 	}
-	show_value(value_str);
 
 	if (digits_changed_) {
 		digits_changed_ = false;
@@ -135,7 +206,8 @@ void ValueDisplay::update_display()
 
 	if (si_prefix != unit_si_prefix_ || unit_changed_) {
 		unit_si_prefix_ = si_prefix;
-		QString unit_str = QString("%1%2").arg(unit_si_prefix_, unit_);
+		QString unit_str = QString("%1%2").arg(
+			util::format_si_prefix(unit_si_prefix_), unit_);
 		if (!unit_suffix_.isEmpty()) {
 			unit_str.append(" ").append(unit_suffix_);
 		}
@@ -20,8 +20,15 @@
 #ifndef UI_WIDGETS_VALUEDISPLAY_HPP
 #define UI_WIDGETS_VALUEDISPLAY_HPP
 
+#include <vector>
+
 #include <QFrame>
 #include <QString>
+#include <QTimer>
+
+#include "src/util.hpp"
+
+using std::vector;
 
 namespace sv {
 namespace ui {
@@ -36,6 +43,7 @@ public:
 		int digits, int decimal_places, const bool auto_range,
 		const QString &unit, const QString &unit_suffix,
 		const QString &extra_text, const bool small, QWidget *parent = nullptr);
+	~ValueDisplay();
 
 	double value() const;
 
@@ -47,11 +55,14 @@ protected:
 	QString extra_text_;
 	bool extra_text_changed_;
 	QString unit_;
-	QString unit_si_prefix_;
+	util::SIPrefix unit_si_prefix_;
 	QString unit_suffix_;
 	bool unit_changed_;
 	const bool small_;
 	double value_;
+	/** The last shown value text, to skip unchanged updates. */
+	char value_text_[64];
+	bool update_pending_;
 
 	virtual void setup_ui() = 0;
 	virtual void update_value_widget_dimensions() = 0;
@@ -70,6 +81,20 @@ public Q_SLOTS:
 	void reset_value();
 	void update_display();
 
+private:
+	/**
+	 * The new values of all displays are shown together by a shared timer,
+	 * so the repaints of all displays are batched and multiple values per
+	 * interval only cause one update.
+	 */
+	static vector<ValueDisplay *> pending_displays_;
+	static QTimer *refresh_timer_;
+	static const int refresh_interval_ = 50;
+
+	static void show_pending_displays();
+	void schedule_update();
+	void cancel_update();
+
 };
 
 } // namespace widgets
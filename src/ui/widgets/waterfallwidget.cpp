@@ -0,0 +1,175 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QRectF>
+#include <QRgb>
+#include <QSize>
+#include <QWidget>
+
+#include "waterfallwidget.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+
+WaterfallWidget::WaterfallWidget(QWidget *parent) :
+	QWidget(parent),
+	newest_row_(0),
+	row_count_(0),
+	peak_db_(-std::numeric_limits<double>::infinity()),
+	dynamic_range_(100.)
+{
+	// The whole widget is covered by the image, there is no need to paint
+	// the background.
+	setAttribute(Qt::WA_OpaquePaintEvent);
+	setMinimumSize(250, 150);
+
+	init_palette();
+}
+
+void WaterfallWidget::init_palette()
+{
+	// black -> blue -> cyan -> yellow -> red
+	const QColor stops[] = {
+		QColor(0, 0, 0), QColor(0, 0, 255), QColor(0, 255, 255),
+		QColor(255, 255, 0), QColor(255, 0, 0) };
+	const int stop_count = sizeof(stops) / sizeof(stops[0]);
+
+	palette_.resize(palette_size_);
+	for (int i = 0; i < palette_size_; ++i) {
+		double pos = (double)i / (palette_size_ - 1) * (stop_count - 1);
+		int stop = std::min((int)pos, stop_count - 2);
+		double f = pos - stop;
+		const QColor &c1 = stops[stop];
+		const QColor &c2 = stops[stop + 1];
+		palette_[i] = qRgb(
+			(int)(c1.red() + f * (c2.red() - c1.red())),
+			(int)(c1.green() + f * (c2.green() - c1.green())),
+			(int)(c1.blue() + f * (c2.blue() - c1.blue())));
+	}
+}
+
+void WaterfallWidget::add_row(const vector<double> &magnitudes_db)
+{
+	if (magnitudes_db.empty())
+		return;
+
+	if (image_.isNull() || image_.width() != (int)magnitudes_db.size()) {
+		image_ = QImage((int)magnitudes_db.size(), max_row_count_,
+			QImage::Format_RGB32);
+		image_.fill(palette_[0]);
+		newest_row_ = 0;
+		row_count_ = 0;
+		peak_db_ = -std::numeric_limits<double>::infinity();
+	}
+
+	for (const double db : magnitudes_db) {
+		if (std::isfinite(db) && db > peak_db_)
+			peak_db_ = db;
+	}
+
+	// The rows are written from the bottom to the top of the ring buffer,
+	// so the image rows are in display order (newest first).
+	newest_row_ = (newest_row_ + max_row_count_ - 1) % max_row_count_;
+	if (row_count_ < max_row_count_)
+		++row_count_;
+
+	const double floor_db = peak_db_ - dynamic_range_;
+	const double scale = (palette_size_ - 1) / dynamic_range_;
+	QRgb *line = reinterpret_cast<QRgb *>(image_.scanLine(newest_row_));
+	for (size_t i = 0; i < magnitudes_db.size(); ++i) {
+		double index = (magnitudes_db[i] - floor_db) * scale;
+		if (!(index > 0.))
+			index = 0.;
+		else if (index > palette_size_ - 1)
+			index = palette_size_ - 1;
+		line[i] = palette_[(int)index];
+	}
+
+	update();
+}
+
+void WaterfallWidget::set_dynamic_range(double dynamic_range)
+{
+	if (dynamic_range > 0.)
+		dynamic_range_ = dynamic_range;
+}
+
+double WaterfallWidget::dynamic_range() const
+{
+	return dynamic_range_;
+}
+
+QSize WaterfallWidget::sizeHint() const
+{
+	return QSize(500, 300);
+}
+
+void WaterfallWidget::clear()
+{
+	image_ = QImage();
+	newest_row_ = 0;
+	row_count_ = 0;
+	peak_db_ = -std::numeric_limits<double>::infinity();
+	update();
+}
+
+void WaterfallWidget::paintEvent(QPaintEvent *event)
+{
+	(void)event;
+
+	QPainter painter(this);
+	painter.fillRect(rect(), Qt::black);
+	if (image_.isNull() || row_count_ == 0)
+		return;
+
+	// One image row is mapped to a fixed height, so the rows only move (and
+	// are not rescaled) when a new row is added.
+	const double row_height = (double)height() / max_row_count_;
+	const int w = width();
+
+	// First part: from the newest row to the end of the ring buffer.
+	int first_rows = std::min(row_count_, max_row_count_ - newest_row_);
+	painter.drawImage(
+		QRectF(0, 0, w, first_rows * row_height),
+		image_, QRectF(0, newest_row_, image_.width(), first_rows));
+
+	// Second part: the wrapped rows from the start of the ring buffer.
+	int second_rows = row_count_ - first_rows;
+	if (second_rows > 0) {
+		painter.drawImage(
+			QRectF(0, first_rows * row_height, w, second_rows * row_height),
+			image_, QRectF(0, 0, image_.width(), second_rows));
+	}
+}
+
+} // namespace widgets
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,89 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_WATERFALLWIDGET_HPP
+#define UI_WIDGETS_WATERFALLWIDGET_HPP
+
+#include <vector>
+
+#include <QImage>
+#include <QPaintEvent>
+#include <QRgb>
+#include <QSize>
+#include <QWidget>
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+
+/**
+ * Shows successive spectra as rows of a scrolling color image, the newest
+ * row at the top.
+ *
+ * The rows are stored in a ring buffer image, so adding a row only colors the
+ * pixels of the new row. When painting, the two parts of the ring buffer are
+ * blitted to the widget; the old rows are never recalculated.
+ */
+class WaterfallWidget : public QWidget
+{
+	Q_OBJECT
+
+public:
+	explicit WaterfallWidget(QWidget *parent = nullptr);
+
+	/**
+	 * Add a new row with the magnitudes (in dB) of a spectrum. When the
+	 * number of bins changes, the old rows are discarded.
+	 */
+	void add_row(const vector<double> &magnitudes_db);
+	/** Set the displayed dynamic range in dB below the peak magnitude. */
+	void set_dynamic_range(double dynamic_range);
+	double dynamic_range() const;
+
+	QSize sizeHint() const override;
+
+public Q_SLOTS:
+	void clear();
+
+protected:
+	void paintEvent(QPaintEvent *event) override;
+
+private:
+	QImage image_;
+	/** The image row of the newest spectrum. */
+	int newest_row_;
+	int row_count_;
+	double peak_db_;
+	double dynamic_range_;
+	vector<QRgb> palette_;
+
+	static const int max_row_count_ = 512;
+	static const int palette_size_ = 256;
+
+	void init_palette();
+
+};
+
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_WATERFALLWIDGET_HPP
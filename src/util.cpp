@@ -20,6 +20,11 @@
 
 #include <algorithm>
 #include <cassert>
+#include <clocale>
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#include <cstdio>
 #include <limits>
 #include <math.h>
 #include <sstream>
@@ -27,6 +32,7 @@
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
+#include <QByteArray>
 #include <QDateTime>
 #include <QDebug>
 #include <QTextStream>
@@ -149,6 +155,141 @@ void format_value_si(
 	si_prefix_stream << si_prefix;
 }
 
+size_t format_value(
+	const double value, const int digits, const int decimal_places,
+	char *buffer, size_t buffer_size)
+{
+	assert(buffer_size > 0);
+
+	int length = std::snprintf(buffer, buffer_size, "%*.*f",
+		digits > 0 ? digits : 0, decimal_places > 0 ? decimal_places : 0,
+		value);
+	if (length < 0) {
+		buffer[0] = '\0';
+		return 0;
+	}
+	if ((size_t)length >= buffer_size)
+		length = (int)buffer_size - 1;
+
+	// snprintf() uses the decimal point of the C locale.
+	const char decimal_point = *std::localeconv()->decimal_point;
+	if (decimal_point != '.') {
+		for (int i = 0; i < length; ++i) {
+			if (buffer[i] == decimal_point) {
+				buffer[i] = '.';
+				break;
+			}
+		}
+	}
+
+	return (size_t)length;
+}
+
+size_t format_value_si(
+	const double value, const int digits, const int decimal_places,
+	char *buffer, size_t buffer_size, SIPrefix &si_prefix)
+{
+	// Same prefix selection as in format_value_si() above, but without
+	// calling pow() for every step.
+	double abs_value = fabs(value);
+	if (value == 0 || std::isnan(value) ||
+			value == std::numeric_limits<double>::infinity() ||
+			value >= std::numeric_limits<double>::max() ||
+			value <= std::numeric_limits<double>::lowest()) {
+		si_prefix = SIPrefix::none;
+	}
+	else {
+		si_prefix = SIPrefix::yocto;
+		abs_value *= 1e24;
+		while (abs_value > 999 && si_prefix < SIPrefix::yotta) {
+			si_prefix = successor(si_prefix);
+			abs_value *= 1e-3;
+		}
+	}
+
+	double multiplier = 1.;
+	const int exp = exponent(si_prefix);
+	for (int i = 0; i < exp; i += 3)
+		multiplier *= 1e-3;
+	for (int i = 0; i > exp; i -= 3)
+		multiplier *= 1e3;
+
+	return format_value(
+		value * multiplier, digits, decimal_places, buffer, buffer_size);
+}
+
+QString format_si_prefix(SIPrefix si_prefix)
+{
+	QString si_prefix_str;
+	QTextStream si_prefix_stream(&si_prefix_str);
+	si_prefix_stream << si_prefix;
+	return si_prefix_str;
+}
+
+size_t format_double(const double value, char *buffer, size_t buffer_size)
+{
+	assert(buffer_size >= 32);
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	// std::to_chars() is locale independent and gives the shortest
+	// representation that round trips.
+	auto result = std::to_chars(buffer, buffer + buffer_size, value);
+	if (result.ec != std::errc())
+		return 0;
+	return (size_t)(result.ptr - buffer);
+#else
+	int length = std::snprintf(buffer, buffer_size, "%.15g", value);
+	if (length < 0)
+		return 0;
+	if ((size_t)length >= buffer_size)
+		length = (int)buffer_size - 1;
+
+	// snprintf() uses the decimal point of the C locale.
+	const char decimal_point = *std::localeconv()->decimal_point;
+	if (decimal_point != '.') {
+		for (int i = 0; i < length; ++i) {
+			if (buffer[i] == decimal_point) {
+				buffer[i] = '.';
+				break;
+			}
+		}
+	}
+	return (size_t)length;
+#endif
+}
+
+size_t format_double(const double value, const int decimal_places,
+	char *buffer, size_t buffer_size)
+{
+	assert(buffer_size >= 32);
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	auto result = std::to_chars(buffer, buffer + buffer_size, value,
+		std::chars_format::fixed, decimal_places > 0 ? decimal_places : 0);
+	if (result.ec != std::errc())
+		return 0;
+	return (size_t)(result.ptr - buffer);
+#else
+	return format_value(value, 0, decimal_places, buffer, buffer_size);
+#endif
+}
+
+bool parse_double(const char *begin, const char *end, double &value)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	// std::from_chars() doesn't accept a leading '+'.
+	if (begin != end && *begin == '+')
+		++begin;
+	auto result = std::from_chars(begin, end, value);
+	return result.ec == std::errc() && result.ptr == end;
+#else
+	// QByteArray::toDouble() always uses the C locale.
+	bool ok;
+	value = QByteArray::fromRawData(begin, (int)(end - begin)).toDouble(&ok);
+	return ok;
+#endif
+}
+
 QString format_time_si(const Timestamp& v, SIPrefix prefix,
 	unsigned int precision, const QString &unit, bool sign)
 {
@@ -22,6 +22,7 @@
 #define UTIL_HPP
 
 #include <cmath>
+#include <cstddef>
 #include <map>
 #include <set>
 #include <string>
@@ -85,6 +86,82 @@ void format_value_si(
 	const double value, const int digits, const int decimal_places,
 	QString &value_str, QString &si_prefix_str);
 
+/**
+ * Allocation free variant of format_value() for frequently updated displays.
+ *
+ * The value is written to the buffer with a '.' as decimal point and without
+ * group separators, right aligned to the width of digits.
+ *
+ * @param value The value to format.
+ * @param digits The number of digits (incl. the decimal places).
+ * @param decimal_places The number of decimal places.
+ * @param buffer The buffer to write the digits to.
+ * @param buffer_size The size of the buffer.
+ *
+ * @return The number of characters written to the buffer.
+ */
+size_t format_value(
+	const double value, const int digits, const int decimal_places,
+	char *buffer, size_t buffer_size);
+
+/**
+ * Allocation free variant of format_value_si() for frequently updated
+ * displays. See format_value() for the format of the buffer.
+ *
+ * @param value The value to format.
+ * @param digits The number of digits (incl. the decimal places).
+ * @param decimal_places The number of decimal places.
+ * @param buffer The buffer to write the digits to.
+ * @param buffer_size The size of the buffer.
+ * @param si_prefix A reference to store the SI prefix to.
+ *
+ * @return The number of characters written to the buffer.
+ */
+size_t format_value_si(
+	const double value, const int digits, const int decimal_places,
+	char *buffer, size_t buffer_size, SIPrefix &si_prefix);
+
+/**
+ * Formats the given SI prefix (e.g. "k" for kilo).
+ *
+ * @param si_prefix The SI prefix to format.
+ *
+ * @return The formatted SI prefix. Empty for SIPrefix::none.
+ */
+QString format_si_prefix(SIPrefix si_prefix);
+
+/**
+ * Format a double with the shortest representation that can be read back
+ * without loss. Unlike QString::arg() this doesn't allocate and always uses
+ * '.' as decimal point, regardless of the locale. Used for bulk exports.
+ *
+ * @param value The value to format.
+ * @param buffer The buffer to write the characters to (not null terminated).
+ * @param buffer_size The size of the buffer, at least 32 characters.
+ *
+ * @return The number of characters written to the buffer.
+ */
+size_t format_double(const double value, char *buffer, size_t buffer_size);
+
+/**
+ * Same as format_double() above, but with a fixed number of decimal places.
+ */
+size_t format_double(const double value, const int decimal_places,
+	char *buffer, size_t buffer_size);
+
+/**
+ * Parse a double from the given characters. Like format_double() this
+ * always uses '.' as decimal point, regardless of the locale, and doesn't
+ * allocate. Used for bulk imports.
+ *
+ * @param[in] begin The first character.
+ * @param[in] end One past the last character.
+ * @param[out] value The parsed value.
+ *
+ * @return true if all characters could be parsed.
+ */
+bool parse_double(const char *begin, const char *end, double &value);
+
 /**
  * Formats a given timestamp with the specified SI prefix.
  *